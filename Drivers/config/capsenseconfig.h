@@ -51,6 +51,111 @@ extern "C" {
 #define ACMP_CHANNELS           1             /**< Number of channels in use for capsense */
 #define NUM_SLIDER_CHANNELS     0             /**< The kit does not have a slider */
 
+/* Uncomment to measure two channels at a time, one on each ACMP. Lists the
+ * ACMP (0 or 1) of each entry in CAPSENSE_CHANNELS. ACMP1 is counted by
+ * TIMER2 through PRS channel 1. */
+//#define CAPSENSE_CHANNEL_ACMP   { 0, 1 }
+//#define CAPSENSE_ACMP1_CDBUSALLOC GPIO_CDBUSALLOC_CDEVEN0_ACMP1
+
+/* Measurement windows (TIMER0 top values), see CAPSENSE_TuneWindows() */
+#define CAPSENSE_WINDOW_DEFAULT     10        /**< Window of untuned channels */
+#define CAPSENSE_WINDOW_MAX         100       /**< Longest window the tuner selects */
+#define CAPSENSE_TUNE_MIN_DELTA     16        /**< Minimum count delta on touch */
+#define CAPSENSE_TUNE_TOUCH_RATIO   32        /**< Expected touch drop, 1/256 of baseline */
+
+/* Uncomment to measure every channel at several ACMP capsense resistor
+ * settings, each oscillating at a different frequency, and weight the
+ * results by their noise, see CAPSENSE_CombineFrequencies() */
+//#define CAPSENSE_FREQUENCIES      { acmpResistor5, acmpResistor3, acmpResistor6 }
+//#define CAPSENSE_NUM_FREQUENCIES  3         /**< Entries in CAPSENSE_FREQUENCIES */
+#define CAPSENSE_FREQ_LEVEL_SHIFT   6         /**< IIR weight 1/2^n of the setting levels */
+#define CAPSENSE_FREQ_NOISE_SHIFT   4         /**< IIR weight 1/2^n of the noise estimates */
+
+/* Filter pipeline, see CAPSENSE_Filter(). Stages which are not defined
+ * are not compiled in. */
+#define CAPSENSE_FILTER_OVERSAMPLE_SHIFT 0    /**< Average 2^n windows per value */
+//#define CAPSENSE_FILTER_MEDIAN              /**< Median of the last 3 values */
+//#define CAPSENSE_FILTER_IIR_SHIFT  2        /**< IIR weight 1/2^n */
+
+/* Baseline tracking, see CAPSENSE_UpdateBaseline() */
+#define CAPSENSE_BASELINE_SHIFT     6         /**< IIR weight 1/2^n while idle */
+#define CAPSENSE_BASELINE_MAX_RISE  64        /**< Max rise per sample, 1/256 counts */
+#define CAPSENSE_BASELINE_MAX_FALL  16        /**< Max fall per sample, 1/256 counts */
+
+/* Uncomment to remove the shift common to all channels of a frame, caused
+ * by supply noise or a hand over the panel, see CAPSENSE_CommonMode() */
+//#define CAPSENSE_COMMON_MODE                /**< Compile in common mode rejection */
+#define CAPSENSE_COMMON_MODE_TRIM_SHIFT 2     /**< Trim n/2^k, at least 1, channels off each end */
+#define CAPSENSE_COMMON_MODE_MIN_CHANNELS 3   /**< Fewest channels to estimate from */
+
+/* Debounced touch events, see CAPSENSE_GetEvent() */
+#define CAPSENSE_EVENT_QUEUE_SIZE   16        /**< Queue length, a power of two */
+#define CAPSENSE_DEBOUNCE_ATTACK    2         /**< Touched frames before a press */
+#define CAPSENSE_DEBOUNCE_RELEASE   2         /**< Untouched frames before a release */
+#define CAPSENSE_LONG_PRESS_MS      1000      /**< Press time before a long press */
+
+/* Centroid engine, see CAPSENSE_GetSliderTouches() and
+ * CAPSENSE_GetPadPosition(). The maps list channel indexes in order. */
+//#define CAPSENSE_SLIDER_MAP          { 0, 1, 2, 3 }   /**< Slider channels */
+//#define CAPSENSE_PAD_ROWS            { 0, 1, 2 }      /**< Pad row channels */
+//#define CAPSENSE_PAD_COLUMNS         { 3, 4, 5 }      /**< Pad column channels */
+#define CAPSENSE_CENTROID_THRESHOLD   32      /**< Touch signal, 1/256 of baseline */
+#define CAPSENSE_CENTROID_VALLEY      192     /**< Valley between two touches, 1/256 of peak */
+
+/* Row and column keypad, see CAPSENSE_KeypadInit(). Every context holds
+ * at most CAPSENSE_MAX_CHANNELS channels, ACMP_CHANNELS by default. */
+//#define CAPSENSE_MAX_CHANNELS        8
+#define CAPSENSE_KEYPAD_MAX_ROWS      8       /**< Most keypad rows */
+#define CAPSENSE_KEYPAD_MAX_COLUMNS   8       /**< Most keypad columns */
+//#define CAPSENSE_KEYPAD_INCREMENTAL         /**< Only measure rows near touches */
+#define CAPSENSE_KEYPAD_FULL_SCAN_FRAMES 16   /**< Frames between full row scans */
+
+/* Proximity detection, see CAPSENSE_ProximityInit(). Signals are in
+ * 1/4096 of the baseline of the summed electrodes. */
+#define CAPSENSE_PROXIMITY_WINDOW         200 /**< Long window, at most 255 */
+#define CAPSENSE_PROXIMITY_FRAMES         2   /**< Frames per level update */
+#define CAPSENSE_PROXIMITY_BASELINE_SHIFT 8   /**< Baseline IIR weight 1/2^n */
+#define CAPSENSE_PROXIMITY_RANGE          64  /**< Signal of level 255 */
+#define CAPSENSE_PROXIMITY_NEAR_LEVEL     64  /**< Level reporting near */
+#define CAPSENSE_PROXIMITY_MAX_NEAR       256 /**< Near updates before recalibrating */
+
+/* Slider gestures, see CAPSENSE_GestureUpdate(). Positions are in slider
+ * units, 16 per channel. */
+#define CAPSENSE_GESTURE_TAP_MS        200    /**< Longest tap */
+#define CAPSENSE_GESTURE_DOUBLE_TAP_MS 250    /**< Longest gap of a double tap */
+#define CAPSENSE_GESTURE_HOLD_MS       500    /**< Touch time before a hold */
+#define CAPSENSE_GESTURE_SWIPE_MS      600    /**< Longest swipe */
+#define CAPSENSE_GESTURE_SWIPE_MIN     24     /**< Shortest swipe distance */
+
+/* Uncomment to keep a calibration record, see CAPSENSE_SaveCalibration().
+ * The baselines and windows are restored by CAPSENSE_Init() so touch
+ * detection is valid from the first frame. The record is kept in the flash
+ * page at CAPSENSE_CALIBRATION_ADDR, which must not hold code, unless
+ * CAPSENSE_CALIBRATION_STORAGE is defined and the application provides
+ * CAPSENSE_CalibrationRead() and CAPSENSE_CalibrationWrite(). */
+//#define CAPSENSE_CALIBRATION                  /**< Restore the stored calibration */
+//#define CAPSENSE_CALIBRATION_ADDR 0x000FE000  /**< Flash page of the record */
+//#define CAPSENSE_CALIBRATION_STORAGE          /**< Application record storage */
+
+/* Uncomment to collect timing and noise statistics, see CAPSENSE_GetStats().
+ * Timing uses the DWT cycle counter. */
+//#define CAPSENSE_STATS                      /**< Compile in the statistics */
+#define CAPSENSE_STATS_BINS       8           /**< Histogram bins per channel */
+#define CAPSENSE_STATS_BIN_SHIFT  2           /**< Histogram bin width 2^n counts */
+
+/* Uncomment to record every frame in a RAM ring buffer, to be streamed out
+ * over a debug UART or RTT for offline tuning, see CAPSENSE_TraceStart() */
+//#define CAPSENSE_TRACE_SIZE     1024          /**< Ring size in bytes, a power of two */
+#define CAPSENSE_TRACE_KEY_FRAMES 64          /**< Frames between key frames */
+
+/* Uncomment to capture samples with the LDMA and only wake up the CPU once
+ * every CAPSENSE_LDMA_FRAMES frames, see CAPSENSE_StartDmaScan(). Not
+ * available with CAPSENSE_NUM_FREQUENCIES > 1. */
+//#define CAPSENSE_LDMA_FRAMES    16            /**< Frames per LDMA batch */
+
+/* Size of the buffers of CAPSENSE_ProcessBatch() */
+#define CAPSENSE_BATCH_FRAMES     16          /**< Frames per CAPSENSE_Batch_t */
+
 #define DEBUG_ACMP0OUT_PORT     gpioPortC
 #define DEBUG_ACMP0OUT_PIN      3
 
@@ -40,6 +40,8 @@
 #include <capsenseconfig.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include "em_acmp.h"
 
 /***************************************************************************//**
  * @addtogroup kitdrv
@@ -55,12 +57,370 @@
 extern "C" {
 #endif
 
+/** Function called from interrupt context when a scan is complete. */
+typedef void (*CAPSENSE_ScanCallback_t)(void);
+
+/** Function called from interrupt context when a wake on touch scan ends. */
+typedef void (*CAPSENSE_WakeCallback_t)(bool touched);
+
+/** Touch event types. */
+typedef enum {
+  CAPSENSE_EVENT_PRESS,           /**< A channel was pressed */
+  CAPSENSE_EVENT_RELEASE,         /**< A channel was released */
+  CAPSENSE_EVENT_LONG_PRESS       /**< A channel is held down */
+} CAPSENSE_EventType_t;
+
+/** A debounced touch event. */
+typedef struct {
+  uint32_t timestamp;             /**< From CAPSENSE_GetTimestamp(), in ms */
+  uint8_t channel;                /**< The channel */
+  CAPSENSE_EventType_t type;      /**< What happened */
+} CAPSENSE_Event_t;
+
+/**************************************************************************//**
+ * @brief The largest number of channels of one context
+ *****************************************************************************/
+#if !defined(CAPSENSE_MAX_CHANNELS)
+#define CAPSENSE_MAX_CHANNELS ACMP_CHANNELS
+#endif
+
+/** A snapshot of all channels of a context at the end of one frame. */
+typedef struct {
+  uint32_t frame;                             /**< Frame number, starting at 1 */
+  uint32_t timestamp;                         /**< From CAPSENSE_GetTimestamp() */
+  uint32_t values[CAPSENSE_MAX_CHANNELS];     /**< Channel values */
+  uint32_t maxValues[CAPSENSE_MAX_CHANNELS];  /**< Channel baselines */
+} CAPSENSE_Frame_t;
+
+/** The analog bus allocation used while a context is scanned. */
+typedef struct {
+  uint32_t abus;                  /**< Value of GPIO->ABUSALLOC */
+  uint32_t bbus;                  /**< Value of GPIO->BBUSALLOC */
+  uint32_t cdbus;                 /**< Value of GPIO->CDBUSALLOC */
+} CAPSENSE_BusAlloc_t;
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+#if !defined(CAPSENSE_FILTER_OVERSAMPLE_SHIFT)
+#define CAPSENSE_FILTER_OVERSAMPLE_SHIFT 0
+#endif
+
+#if (CAPSENSE_FILTER_OVERSAMPLE_SHIFT > 0) \
+  || defined(CAPSENSE_FILTER_MEDIAN)       \
+  || defined(CAPSENSE_FILTER_IIR_SHIFT)
+#define CAPSENSE_FILTER_ENABLED
+
+/** The filter pipeline of a channel. Each stage is only compiled in when it
+ *  is enabled in capsenseconfig.h. */
+typedef struct {
+#if (CAPSENSE_FILTER_OVERSAMPLE_SHIFT > 0)
+  uint32_t sum;           /**< Sum of the samples accumulated so far */
+  uint8_t  samples;       /**< Number of samples accumulated so far */
+#endif
+#if defined(CAPSENSE_FILTER_MEDIAN)
+  uint32_t history[2];    /**< The two previous inputs of the median */
+#endif
+#if defined(CAPSENSE_FILTER_IIR_SHIFT)
+  uint32_t iir;           /**< The IIR output in 1/256 counts */
+#endif
+  bool     primed;        /**< Set after the first output */
+} CAPSENSE_Filter_t;
+#endif
+
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+/** The debounce state of a channel. */
+typedef struct {
+  uint32_t pressTime;     /**< Timestamp of the press event */
+  uint8_t  count;         /**< Consecutive frames disagreeing with state */
+  bool     pressed;       /**< Debounced state */
+  bool     longPress;     /**< Set when the long press event was queued */
+} CAPSENSE_Debounce_t;
+#endif
+
+#if defined(CAPSENSE_STATS)
+#if !defined(CAPSENSE_STATS_BINS)
+#define CAPSENSE_STATS_BINS 8
+#endif
+
+/** The running statistics of the raw samples of a channel. */
+typedef struct {
+  uint32_t samples;       /**< Number of samples */
+  uint32_t min;           /**< Smallest sample */
+  uint32_t max;           /**< Largest sample */
+  uint64_t sum;           /**< Sum of the samples */
+  uint64_t sumSquares;    /**< Sum of the squared samples */
+  uint32_t histogram[CAPSENSE_STATS_BINS];  /**< Samples around the baseline */
+} CAPSENSE_StatsAccum_t;
+#endif
+
+#if !defined(CAPSENSE_NUM_FREQUENCIES)
+#define CAPSENSE_NUM_FREQUENCIES 1
+#endif
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+/** The state of a channel at one ACMP resistor setting. */
+typedef struct {
+  uint32_t sample;        /**< Count of the running scan step */
+  uint32_t level;         /**< Slow average of the counts in 1/256 counts */
+  uint32_t last;          /**< Previous count, scaled to the first setting */
+  uint32_t noise;         /**< Mean change between samples in 1/256 counts */
+  uint32_t recip;         /**< Packed reciprocal of the level in counts */
+  uint32_t weight;        /**< Weight of the setting in the combined count */
+} CAPSENSE_Frequency_t;
+#endif
+
+#if defined(CAPSENSE_CHANNEL_ACMP)
+/** Number of ACMPs measuring channels in parallel */
+#define CAPSENSE_ACMPS          2
+#else
+#define CAPSENSE_ACMPS          1
+#endif
+
+/** One step of a scan, the channels measured together. */
+typedef struct {
+  uint32_t input[CAPSENSE_ACMPS];   /**< ACMP INPUTCTRL POSSEL of each channel */
+  uint32_t window;                  /**< Longest window of the channels */
+  uint8_t channel[CAPSENSE_ACMPS];  /**< Channel index on each ACMP */
+} CAPSENSE_ScanStep_t;
+
+/** The values of a channel published with one frame. */
+typedef struct {
+  uint32_t value;         /**< Channel value */
+  uint32_t maxValue;      /**< Channel baseline in counts */
+  uint32_t recip;         /**< Packed reciprocal of maxValue */
+} CAPSENSE_ChannelFrame_t;
+
+/** @endcond */
+
+/**************************************************************************//**
+ * @brief
+ *   The state of one channel. Applications only allocate it, the fields
+ *   are private to the driver.
+ *****************************************************************************/
+typedef struct {
+  /** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+  uint32_t value;                   /* Latest filtered value */
+  uint32_t maxValue;                /* Baseline in counts */
+  uint32_t recip;                   /* Packed reciprocal of maxValue */
+  uint32_t baseline;                /* Baseline in 1/256 counts, 0 if unset */
+  uint32_t window;                  /* TIMER0 top value */
+#if defined(CAPSENSE_FILTER_ENABLED)
+  CAPSENSE_Filter_t filter;
+#endif
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+  CAPSENSE_Debounce_t debounce;
+#endif
+  CAPSENSE_ChannelFrame_t frames[2];  /* Double buffered published values */
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  CAPSENSE_Frequency_t freq[CAPSENSE_NUM_FREQUENCIES];
+  uint32_t freqRecip;               /* Packed reciprocal of the weights */
+#endif
+#if defined(CAPSENSE_STATS)
+  CAPSENSE_StatsAccum_t stats;
+#endif
+#if defined(CAPSENSE_TRACE_SIZE)
+  uint32_t raw;                     /* Last unfiltered sample */
+  uint32_t traced[3];               /* Raw, value and baseline last traced */
+#endif
+  /** @endcond */
+} CAPSENSE_ChannelState_t;
+
+#if defined(CAPSENSE_STATS)
+/** A snapshot of the noise statistics of a channel. */
+typedef struct {
+  uint32_t samples;       /**< Number of raw samples */
+  uint32_t min;           /**< Smallest sample */
+  uint32_t max;           /**< Largest sample */
+  uint32_t mean;          /**< Mean sample */
+  uint32_t variance;      /**< Variance of the samples in counts squared */
+  /** Samples by distance from the baseline, in bins of
+   *  2^CAPSENSE_STATS_BIN_SHIFT counts. The bin CAPSENSE_STATS_BINS / 2
+   *  starts at the baseline, the outer bins also hold all samples beyond
+   *  them. */
+  uint32_t histogram[CAPSENSE_STATS_BINS];
+} CAPSENSE_ChannelStats_t;
+
+/** A snapshot of the timing statistics of the driver, in CPU cycles. */
+typedef struct {
+  uint32_t scans;           /**< Completed interrupt driven scans */
+  uint32_t scanCycles;      /**< Duration of the last scan */
+  uint32_t scanCyclesMax;   /**< Longest scan */
+  uint32_t interrupts;      /**< TIMER0 interrupts */
+  uint32_t latencyMax;      /**< Longest time from window end to handler */
+  uint64_t latencyTotal;    /**< Sum of the handler latencies */
+  uint32_t handlerMax;      /**< Longest run of the handler */
+  uint64_t handlerTotal;    /**< Sum of the handler run times */
+  uint64_t waitCycles;      /**< Time spent waiting in blocking calls */
+  uint32_t batchCycles;     /**< Duration of the last batch */
+} CAPSENSE_Stats_t;
+#endif
+
+/** Time each kind of peripheral spent measuring, in TIMER0 ticks summed
+ *  over its instances. */
+typedef struct {
+  uint32_t acmp;            /**< ACMPs running */
+  uint32_t timer0;          /**< TIMER0 timing a window */
+  uint32_t timer1;          /**< Pulse counters, TIMER1 and TIMER2 */
+  uint32_t prs;             /**< PRS channels routing the ACMP outputs */
+} CAPSENSE_MeasureTicks_t;
+
+#if !defined(CAPSENSE_BATCH_FRAMES)
+#define CAPSENSE_BATCH_FRAMES 16
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Buffered frames processed together by CAPSENSE_CtxProcessBatch().
+ *
+ * @details
+ *   The arrays are laid out by channel, so the samples of one channel are
+ *   contiguous and each output is produced by a loop over the frames.
+ *****************************************************************************/
+typedef struct {
+  uint32_t frames;        /**< Frames in the batch, at most CAPSENSE_BATCH_FRAMES */
+  /** Raw counts of each channel, filled in by the caller */
+  uint16_t counts[CAPSENSE_MAX_CHANNELS][CAPSENSE_BATCH_FRAMES];
+  /** Filtered values of each channel */
+  uint16_t values[CAPSENSE_MAX_CHANNELS][CAPSENSE_BATCH_FRAMES];
+  /** Values relative to the baseline of each channel, 256 at the baseline */
+  uint16_t levels[CAPSENSE_MAX_CHANNELS][CAPSENSE_BATCH_FRAMES];
+  /** Pressed channels of each frame, bit n for channel n */
+  uint32_t pressed[CAPSENSE_BATCH_FRAMES];
+  /** Channels with a new value in each frame, bit n for channel n */
+  uint32_t valid[CAPSENSE_BATCH_FRAMES];
+  /** Slider position of each frame, -1 if it can not be determined */
+  int16_t slider[CAPSENSE_BATCH_FRAMES];
+} CAPSENSE_Batch_t;
+
+/**************************************************************************//**
+ * @brief
+ *   A group of channels scanned together.
+ *
+ * @details
+ *   Each context has its own channel list, channel states, frames and
+ *   events, so groups of electrodes can be scanned at different rates.
+ *   All contexts share the ACMPs and TIMERs, and only one of them is
+ *   scanned at a time. Allocate contexts statically and set them up with
+ *   CAPSENSE_CtxInit(). The fields are private to the driver.
+ *****************************************************************************/
+typedef struct {
+  /** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+  const ACMP_Channel_TypeDef *channels;  /* ACMP input of each channel */
+  const uint8_t *channelAcmp;           /* ACMP of each channel, or NULL */
+  const bool *inUse;                    /* Channels to measure, or NULL */
+  const CAPSENSE_BusAlloc_t *busAlloc;  /* Bus allocation, or NULL */
+  CAPSENSE_ChannelState_t *state;       /* State of each channel */
+  uint8_t numChannels;
+  uint8_t numSteps;                     /* Entries in steps */
+  CAPSENSE_ScanStep_t steps[CAPSENSE_MAX_CHANNELS];  /* Scan table */
+  volatile uint32_t frameSeq;           /* Number of the last frame */
+  uint32_t frameTime[2];                /* Timestamps of the frames */
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+  CAPSENSE_Event_t events[CAPSENSE_EVENT_QUEUE_SIZE];
+  volatile uint32_t eventHead;          /* Events written, by the producer */
+  volatile uint32_t eventTail;          /* Events read, by the consumer */
+  volatile uint32_t eventsDropped;      /* Events lost to a full queue */
+#endif
+  /** @endcond */
+} CAPSENSE_Context_t;
+
+void CAPSENSE_CtxInit(CAPSENSE_Context_t *ctx,
+                      const ACMP_Channel_TypeDef *channels,
+                      const uint8_t *channelAcmp,
+                      CAPSENSE_ChannelState_t *state,
+                      uint8_t numChannels);
+CAPSENSE_Context_t *CAPSENSE_GetDefaultContext(void);
+void CAPSENSE_CtxSetChannelMask(CAPSENSE_Context_t *ctx, const bool *inUse);
+void CAPSENSE_CtxSetBusAlloc(CAPSENSE_Context_t *ctx,
+                             const CAPSENSE_BusAlloc_t *busAlloc);
+uint32_t CAPSENSE_CtxGetVal(CAPSENSE_Context_t *ctx, uint8_t channel);
+uint32_t CAPSENSE_CtxGetNormalizedVal(CAPSENSE_Context_t *ctx, uint8_t channel);
+bool CAPSENSE_CtxGetPressed(CAPSENSE_Context_t *ctx, uint8_t channel);
+void CAPSENSE_CtxGetSignals(CAPSENSE_Context_t *ctx,
+                            const uint8_t *map,
+                            uint8_t count,
+                            uint16_t *signals);
+int32_t CAPSENSE_CtxGetSliderPosition(CAPSENSE_Context_t *ctx);
+void CAPSENSE_CtxGetFrame(CAPSENSE_Context_t *ctx, CAPSENSE_Frame_t *frame);
+bool CAPSENSE_CtxProcessBatch(CAPSENSE_Context_t *ctx, CAPSENSE_Batch_t *batch);
+bool CAPSENSE_CtxSense(CAPSENSE_Context_t *ctx);
+bool CAPSENSE_CtxStartScan(CAPSENSE_Context_t *ctx,
+                           CAPSENSE_ScanCallback_t callback);
+bool CAPSENSE_CtxStartWakeScan(CAPSENSE_Context_t *ctx,
+                               CAPSENSE_WakeCallback_t callback);
+bool CAPSENSE_CtxScanComplete(CAPSENSE_Context_t *ctx);
+#if defined(CAPSENSE_LDMA_FRAMES)
+bool CAPSENSE_CtxStartDmaScan(CAPSENSE_Context_t *ctx,
+                              CAPSENSE_ScanCallback_t callback);
+#endif
+bool CAPSENSE_CtxTuneWindows(CAPSENSE_Context_t *ctx);
+uint32_t CAPSENSE_CtxGetWindow(CAPSENSE_Context_t *ctx, uint8_t channel);
+void CAPSENSE_CtxSetWindow(CAPSENSE_Context_t *ctx, uint8_t channel,
+                           uint32_t window);
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+bool CAPSENSE_CtxGetEvent(CAPSENSE_Context_t *ctx, CAPSENSE_Event_t *event);
+uint32_t CAPSENSE_CtxGetDroppedEvents(CAPSENSE_Context_t *ctx);
+#endif
+#if defined(CAPSENSE_CALIBRATION)
+bool CAPSENSE_CtxSaveCalibration(CAPSENSE_Context_t *ctx);
+bool CAPSENSE_CtxRestoreCalibration(CAPSENSE_Context_t *ctx);
+bool CAPSENSE_CalibrationRead(void *data, size_t size);
+bool CAPSENSE_CalibrationWrite(const void *data, size_t size);
+#endif
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+uint32_t CAPSENSE_CtxGetNoise(CAPSENSE_Context_t *ctx, uint8_t channel,
+                              uint8_t setting);
+#endif
+#if defined(CAPSENSE_STATS)
+void CAPSENSE_CtxGetChannelStats(CAPSENSE_Context_t *ctx, uint8_t channel,
+                                 CAPSENSE_ChannelStats_t *stats);
+void CAPSENSE_CtxResetStats(CAPSENSE_Context_t *ctx);
+void CAPSENSE_GetStats(CAPSENSE_Stats_t *stats);
+uint32_t CAPSENSE_GetCycles(void);
+#endif
+#if defined(CAPSENSE_TRACE_SIZE)
+void CAPSENSE_CtxTraceStart(CAPSENSE_Context_t *ctx);
+void CAPSENSE_TraceStop(void);
+size_t CAPSENSE_TraceRead(uint8_t *buffer, size_t size);
+uint32_t CAPSENSE_GetDroppedTraceFrames(void);
+#endif
+void CAPSENSE_GetMeasureTicks(CAPSENSE_MeasureTicks_t *ticks);
+uint32_t CAPSENSE_GetInterruptCount(void);
+uint32_t CAPSENSE_GetMeasureTickHz(void);
+
+/* Functions operating on the default context */
 uint32_t CAPSENSE_getVal(uint8_t channel);
 uint32_t CAPSENSE_getNormalizedVal(uint8_t channel);
 bool CAPSENSE_getPressed(uint8_t channel);
 int32_t CAPSENSE_getSliderPosition(void);
-void CAPSENSE_Sense(void);
+bool CAPSENSE_ProcessBatch(CAPSENSE_Batch_t *batch);
+void CAPSENSE_GetFrame(CAPSENSE_Frame_t *frame);
+bool CAPSENSE_Sense(void);
+bool CAPSENSE_StartScan(CAPSENSE_ScanCallback_t callback);
+bool CAPSENSE_StartWakeScan(CAPSENSE_WakeCallback_t callback);
+bool CAPSENSE_ScanComplete(void);
+#if defined(CAPSENSE_LDMA_FRAMES)
+bool CAPSENSE_StartDmaScan(CAPSENSE_ScanCallback_t callback);
+void CAPSENSE_StopDmaScan(void);
+#endif
 void CAPSENSE_Init(void);
+bool CAPSENSE_TuneWindows(void);
+uint32_t CAPSENSE_getWindow(uint8_t channel);
+void CAPSENSE_setWindow(uint8_t channel, uint32_t window);
+uint32_t CAPSENSE_GetTimestamp(void);
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+bool CAPSENSE_GetEvent(CAPSENSE_Event_t *event);
+uint32_t CAPSENSE_GetDroppedEvents(void);
+#endif
+#if defined(CAPSENSE_CALIBRATION)
+bool CAPSENSE_SaveCalibration(void);
+#endif
+#if defined(CAPSENSE_TRACE_SIZE)
+void CAPSENSE_TraceStart(void);
+#endif
+#if defined(CAPSENSE_STATS)
+void CAPSENSE_GetChannelStats(uint8_t channel, CAPSENSE_ChannelStats_t *stats);
+#endif
 
 #ifdef __cplusplus
 }
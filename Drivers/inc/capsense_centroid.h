@@ -0,0 +1,87 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense slider and pad centroid engine
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __CAPSENSE_CENTROID_H_
+#define __CAPSENSE_CENTROID_H_
+
+#include "capsense.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The largest number of touches found on a slider */
+#define CAPSENSE_CENTROID_MAX_TOUCHES 2
+
+/** Slider position units per channel, as for CAPSENSE_getSliderPosition() */
+#define CAPSENSE_CENTROID_RESOLUTION  16
+
+uint8_t CAPSENSE_CtxGetSliderTouches(CAPSENSE_Context_t *ctx,
+                                     const uint8_t *map,
+                                     uint8_t count,
+                                     int32_t *positions);
+bool CAPSENSE_CtxGetPadPosition(CAPSENSE_Context_t *ctx,
+                                const uint8_t *rows,
+                                uint8_t numRows,
+                                const uint8_t *columns,
+                                uint8_t numColumns,
+                                int32_t *x,
+                                int32_t *y);
+#if defined(CAPSENSE_SLIDER_MAP)
+uint8_t CAPSENSE_GetSliderTouches(int32_t *positions);
+#endif
+#if defined(CAPSENSE_PAD_ROWS) && defined(CAPSENSE_PAD_COLUMNS)
+bool CAPSENSE_GetPadPosition(int32_t *x, int32_t *y);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
+
+#endif /* __CAPSENSE_CENTROID_H_ */
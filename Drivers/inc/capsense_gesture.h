@@ -0,0 +1,134 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense gesture recognizer
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __CAPSENSE_GESTURE_H_
+#define __CAPSENSE_GESTURE_H_
+
+#include "capsense.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of positions kept for the swipe speed, a power of two */
+#if !defined(CAPSENSE_GESTURE_HISTORY)
+#define CAPSENSE_GESTURE_HISTORY      8
+#endif
+
+/** Number of gesture events that can be queued, a power of two */
+#if !defined(CAPSENSE_GESTURE_QUEUE_SIZE)
+#define CAPSENSE_GESTURE_QUEUE_SIZE   8
+#endif
+
+/** Gesture event types. */
+typedef enum {
+  CAPSENSE_GESTURE_TAP,           /**< A short touch without movement */
+  CAPSENSE_GESTURE_DOUBLE_TAP,    /**< Two taps in quick succession */
+  CAPSENSE_GESTURE_SWIPE,         /**< A quick movement ending in a release */
+  CAPSENSE_GESTURE_HOLD,          /**< A touch held without movement */
+  CAPSENSE_GESTURE_DRAG,          /**< The position changed while holding */
+  CAPSENSE_GESTURE_HOLD_END       /**< The held touch was released */
+} CAPSENSE_GestureType_t;
+
+/** A recognized gesture. */
+typedef struct {
+  uint32_t timestamp;             /**< Time of the gesture in ms */
+  int32_t position;               /**< Slider position of the gesture */
+  int32_t speed;                  /**< Swipe speed in position units per
+                                       second, negative towards 0 */
+  CAPSENSE_GestureType_t type;    /**< The gesture */
+} CAPSENSE_GestureEvent_t;
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+/** A time stamped slider position. */
+typedef struct {
+  int32_t position;
+  uint32_t timestamp;
+} CAPSENSE_GestureSample_t;
+
+/** @endcond */
+
+/**************************************************************************//**
+ * @brief
+ *   The state of the gesture recognizer of one slider. Applications only
+ *   allocate it, the fields are private to the driver.
+ *****************************************************************************/
+typedef struct {
+  /** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+  CAPSENSE_GestureSample_t history[CAPSENSE_GESTURE_HISTORY];
+  uint32_t samples;               /* Positions written to history */
+  uint8_t state;                  /* Recognizer state */
+  int32_t startPosition;          /* Position at touch down */
+  uint32_t startTime;             /* Time of touch down */
+  int32_t dragPosition;           /* Last position reported by a drag */
+  bool moved;                     /* Set when the touch left its start */
+  bool tapPending;                /* Set while a tap may become a double tap */
+  uint32_t tapTime;               /* Release time of the pending tap */
+  int32_t tapPosition;            /* Position of the pending tap */
+  CAPSENSE_GestureEvent_t events[CAPSENSE_GESTURE_QUEUE_SIZE];
+  volatile uint32_t eventHead;    /* Events written, by the producer */
+  volatile uint32_t eventTail;    /* Events read, by the consumer */
+  volatile uint32_t eventsDropped;
+  /** @endcond */
+} CAPSENSE_Gesture_t;
+
+void CAPSENSE_GestureInit(CAPSENSE_Gesture_t *gesture);
+void CAPSENSE_GestureUpdate(CAPSENSE_Gesture_t *gesture,
+                            int32_t position,
+                            uint32_t timestamp);
+bool CAPSENSE_GestureGetEvent(CAPSENSE_Gesture_t *gesture,
+                              CAPSENSE_GestureEvent_t *event);
+uint32_t CAPSENSE_GestureGetDroppedEvents(const CAPSENSE_Gesture_t *gesture);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
+
+#endif /* __CAPSENSE_GESTURE_H_ */
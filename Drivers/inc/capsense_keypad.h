@@ -0,0 +1,114 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense row and column keypad
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __CAPSENSE_KEYPAD_H_
+#define __CAPSENSE_KEYPAD_H_
+
+#include "capsense.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The largest number of keypad rows, at most 32 */
+#if !defined(CAPSENSE_KEYPAD_MAX_ROWS)
+#define CAPSENSE_KEYPAD_MAX_ROWS      8
+#endif
+
+/** The largest number of keypad columns, at most 32 */
+#if !defined(CAPSENSE_KEYPAD_MAX_COLUMNS)
+#define CAPSENSE_KEYPAD_MAX_COLUMNS   8
+#endif
+
+/** Size of a key bitmap in bytes, one bit per key in row major order */
+#define CAPSENSE_KEYPAD_KEY_BYTES \
+  ((CAPSENSE_KEYPAD_MAX_ROWS * CAPSENSE_KEYPAD_MAX_COLUMNS + 7) / 8)
+
+/**************************************************************************//**
+ * @brief
+ *   The state of a row and column keypad. Applications only allocate it,
+ *   the fields are private to the driver.
+ *****************************************************************************/
+typedef struct {
+  /** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+  CAPSENSE_Context_t rows;        /* Row electrodes, measured first */
+  CAPSENSE_Context_t columns;     /* Column electrodes, measured second */
+  CAPSENSE_ChannelState_t rowState[CAPSENSE_KEYPAD_MAX_ROWS];
+  CAPSENSE_ChannelState_t columnState[CAPSENSE_KEYPAD_MAX_COLUMNS];
+  bool rowScan[CAPSENSE_KEYPAD_MAX_ROWS];   /* Rows measured next frame */
+  uint8_t keys[CAPSENSE_KEYPAD_KEY_BYTES];  /* Decoded keys */
+  volatile uint32_t keySeq;       /* Incremented when keys change */
+  uint32_t ghosts;                /* Frames rejected as ambiguous */
+  uint8_t measurements;           /* Measurements of the last frame */
+  uint8_t fullScanCountdown;      /* Frames until the next full scan */
+  CAPSENSE_ScanCallback_t callback;
+  /** @endcond */
+} CAPSENSE_Keypad_t;
+
+void CAPSENSE_KeypadInit(CAPSENSE_Keypad_t *keypad,
+                         const ACMP_Channel_TypeDef *rows,
+                         uint8_t numRows,
+                         const CAPSENSE_BusAlloc_t *rowBus,
+                         const ACMP_Channel_TypeDef *columns,
+                         uint8_t numColumns,
+                         const CAPSENSE_BusAlloc_t *columnBus);
+bool CAPSENSE_KeypadStartScan(CAPSENSE_Keypad_t *keypad,
+                              CAPSENSE_ScanCallback_t callback);
+bool CAPSENSE_KeypadGetKey(CAPSENSE_Keypad_t *keypad,
+                           uint8_t row,
+                           uint8_t column);
+void CAPSENSE_KeypadGetKeys(CAPSENSE_Keypad_t *keypad, uint8_t *keys);
+uint8_t CAPSENSE_KeypadGetMeasurements(const CAPSENSE_Keypad_t *keypad);
+uint32_t CAPSENSE_KeypadGetGhosts(const CAPSENSE_Keypad_t *keypad);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
+
+#endif /* __CAPSENSE_KEYPAD_H_ */
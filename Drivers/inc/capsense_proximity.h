@@ -0,0 +1,95 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense proximity detection
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __CAPSENSE_PROXIMITY_H_
+#define __CAPSENSE_PROXIMITY_H_
+
+#include "capsense.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   The state of a proximity sensor. Applications only allocate it, the
+ *   fields are private to the driver.
+ *****************************************************************************/
+typedef struct {
+  /** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+  CAPSENSE_Context_t ctx;         /* The electrodes */
+  CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+  uint32_t sum;                   /* Counts accumulated so far */
+  uint32_t baseline;              /* Slow baseline in 1/256 counts */
+  uint32_t recipBase;             /* Baseline of recip, in counts */
+  uint32_t recip;                 /* 2^32 / recipBase */
+  uint32_t nearUpdates;           /* Consecutive updates while near */
+  uint16_t signal;                /* Drop below the baseline, 1/4096 */
+  uint8_t frames;                 /* Frames accumulated so far */
+  volatile uint8_t level;         /* Graded proximity level */
+  volatile bool near;             /* Debounced proximity state */
+  CAPSENSE_ScanCallback_t callback;
+  /** @endcond */
+} CAPSENSE_Proximity_t;
+
+bool CAPSENSE_ProximityInit(CAPSENSE_Proximity_t *prox,
+                            const ACMP_Channel_TypeDef *electrodes,
+                            uint8_t numElectrodes,
+                            const CAPSENSE_BusAlloc_t *busAlloc);
+bool CAPSENSE_ProximityStartScan(CAPSENSE_Proximity_t *prox,
+                                 CAPSENSE_ScanCallback_t callback);
+uint8_t CAPSENSE_ProximityGetLevel(const CAPSENSE_Proximity_t *prox);
+uint16_t CAPSENSE_ProximityGetSignal(const CAPSENSE_Proximity_t *prox);
+bool CAPSENSE_ProximityIsNear(const CAPSENSE_Proximity_t *prox);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
+
+#endif /* __CAPSENSE_PROXIMITY_H_ */
@@ -0,0 +1,379 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense slider and pad centroid engine
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "capsense_centroid.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+/**************************************************************************//**
+ * @brief The touch signal a channel must exceed to be part of a touch,
+ *        in 1/256 of its baseline
+ *****************************************************************************/
+#if !defined(CAPSENSE_CENTROID_THRESHOLD)
+#define CAPSENSE_CENTROID_THRESHOLD   32
+#endif
+
+/**************************************************************************//**
+ * @brief The valley between two peaks must be below this fraction, in
+ *        1/256, of the weaker peak for them to be two touches
+ *****************************************************************************/
+#if !defined(CAPSENSE_CENTROID_VALLEY)
+#define CAPSENSE_CENTROID_VALLEY      192
+#endif
+
+/** A group of neighbouring channels belonging to one touch. */
+typedef struct {
+  uint8_t first;          /**< First channel of the segment */
+  uint8_t last;           /**< Last channel of the segment */
+  uint8_t peak;           /**< Strongest channel of the segment */
+} Segment_TypeDef;
+
+#if defined(CAPSENSE_SLIDER_MAP)
+/** The channels of the default slider, in order. */
+static const uint8_t sliderMap[] = CAPSENSE_SLIDER_MAP;
+#endif
+
+#if defined(CAPSENSE_PAD_ROWS) && defined(CAPSENSE_PAD_COLUMNS)
+/** The row channels of the default pad, in order. */
+static const uint8_t padRows[] = CAPSENSE_PAD_ROWS;
+/** The column channels of the default pad, in order. */
+static const uint8_t padColumns[] = CAPSENSE_PAD_COLUMNS;
+#endif
+
+/** @endcond */
+
+/**************************************************************************//**
+ * @brief
+ *   Find the strongest channel above the threshold outside of a segment.
+ *
+ * @return
+ *   true if a channel was found.
+ *****************************************************************************/
+static bool CAPSENSE_FindPeak(const uint16_t *signals,
+                              uint8_t count,
+                              const Segment_TypeDef *exclude,
+                              uint8_t *peak)
+{
+  uint16_t max = CAPSENSE_CENTROID_THRESHOLD;
+  bool found = false;
+  uint8_t i;
+
+  for (i = 0; i < count; i++) {
+    if ((exclude != NULL) && (i >= exclude->first) && (i <= exclude->last)) {
+      continue;
+    }
+    if (signals[i] > max) {
+      max = signals[i];
+      *peak = i;
+      found = true;
+    }
+  }
+  return found;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Grow a segment from its peak while the signals fall and stay above the
+ *   threshold, without entering another segment.
+ *****************************************************************************/
+static void CAPSENSE_GrowSegment(const uint16_t *signals,
+                                 uint8_t count,
+                                 const Segment_TypeDef *exclude,
+                                 Segment_TypeDef *segment)
+{
+  uint8_t first = segment->peak;
+  uint8_t last = segment->peak;
+
+  while ((first > 0)
+         && (signals[first - 1] > CAPSENSE_CENTROID_THRESHOLD)
+         && (signals[first - 1] <= signals[first])
+         && ((exclude == NULL) || (first - 1 > exclude->last))) {
+    first--;
+  }
+  while ((last + 1 < count)
+         && (signals[last + 1] > CAPSENSE_CENTROID_THRESHOLD)
+         && (signals[last + 1] <= signals[last])
+         && ((exclude == NULL) || (last + 1 < exclude->first))) {
+    last++;
+  }
+  segment->first = first;
+  segment->last = last;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Check if two segments are separated by a deep enough valley.
+ *****************************************************************************/
+static bool CAPSENSE_Separated(const uint16_t *signals,
+                               const Segment_TypeDef *a,
+                               const Segment_TypeDef *b)
+{
+  uint8_t from = (a->peak < b->peak) ? a->peak : b->peak;
+  uint8_t to = (a->peak < b->peak) ? b->peak : a->peak;
+  uint16_t weaker = (signals[a->peak] < signals[b->peak])
+                    ? signals[a->peak] : signals[b->peak];
+  uint16_t valley = weaker;
+  uint8_t i;
+
+  for (i = from + 1; i < to; i++) {
+    if (signals[i] < valley) {
+      valley = signals[i];
+    }
+  }
+  return ((uint32_t) valley * 256)
+         < ((uint32_t) weaker * CAPSENSE_CENTROID_VALLEY);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Calculate the weighted centroid of a segment.
+ *
+ * @details
+ *   Each channel is weighted by its signal above the threshold, so the
+ *   edges of a touch fade out smoothly.
+ *
+ * @return
+ *   The position in CAPSENSE_CENTROID_RESOLUTION units per channel.
+ *****************************************************************************/
+static int32_t CAPSENSE_Centroid(const uint16_t *signals,
+                                 const Segment_TypeDef *segment)
+{
+  uint32_t sum = 0;
+  uint32_t moment = 0;
+  uint32_t weight;
+  uint8_t i;
+
+  for (i = segment->first; i <= segment->last; i++) {
+    weight = signals[i] - CAPSENSE_CENTROID_THRESHOLD;
+    sum += weight;
+    moment += weight * i;
+  }
+  return (int32_t) ((moment * CAPSENSE_CENTROID_RESOLUTION + sum / 2) / sum);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Find up to two touches in a row of signals.
+ *
+ * @return
+ *   The number of touches, with positions sorted in ascending order.
+ *****************************************************************************/
+static uint8_t CAPSENSE_FindTouches(const uint16_t *signals,
+                                    uint8_t count,
+                                    uint8_t maxTouches,
+                                    int32_t *positions)
+{
+  Segment_TypeDef segments[CAPSENSE_CENTROID_MAX_TOUCHES];
+  int32_t t;
+
+  if (!CAPSENSE_FindPeak(signals, count, NULL, &segments[0].peak)) {
+    return 0;
+  }
+  CAPSENSE_GrowSegment(signals, count, NULL, &segments[0]);
+
+  if (CAPSENSE_FindPeak(signals, count, &segments[0], &segments[1].peak)) {
+    CAPSENSE_GrowSegment(signals, count, &segments[0], &segments[1]);
+    if ((maxTouches < 2)
+        || !CAPSENSE_Separated(signals, &segments[0], &segments[1])) {
+      // A second bump on the same finger, merge it if it is adjacent
+      if (segments[1].last + 1 == segments[0].first) {
+        segments[0].first = segments[1].first;
+      } else if (segments[0].last + 1 == segments[1].first) {
+        segments[0].last = segments[1].last;
+      }
+    } else {
+      positions[1] = CAPSENSE_Centroid(signals, &segments[1]);
+      positions[0] = CAPSENSE_Centroid(signals, &segments[0]);
+      if (positions[1] < positions[0]) {
+        t = positions[0];
+        positions[0] = positions[1];
+        positions[1] = t;
+      }
+      return 2;
+    }
+  }
+
+  positions[0] = CAPSENSE_Centroid(signals, &segments[0]);
+  return 1;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Find the touches on a slider.
+ *
+ * @details
+ *   The slider is segmented at the valleys between signal peaks, and the
+ *   position of each touch is the weighted centroid of its segment. Two
+ *   fingers on the slider give two positions instead of one position
+ *   between them. The cost is linear in the number of channels.
+ *
+ * @param ctx
+ *   The context of the slider channels.
+ *
+ * @param map
+ *   The channels of the slider, in order.
+ *
+ * @param count
+ *   The number of channels in map, at most CAPSENSE_MAX_CHANNELS.
+ *
+ * @param positions
+ *   Filled in with up to CAPSENSE_CENTROID_MAX_TOUCHES positions in
+ *   ascending order, CAPSENSE_CENTROID_RESOLUTION units per channel.
+ *
+ * @return
+ *   The number of touches.
+ *****************************************************************************/
+uint8_t CAPSENSE_CtxGetSliderTouches(CAPSENSE_Context_t *ctx,
+                                     const uint8_t *map,
+                                     uint8_t count,
+                                     int32_t *positions)
+{
+  uint16_t signals[CAPSENSE_MAX_CHANNELS];
+
+  if (count > CAPSENSE_MAX_CHANNELS) {
+    count = CAPSENSE_MAX_CHANNELS;
+  }
+  CAPSENSE_CtxGetSignals(ctx, map, count, signals);
+  return CAPSENSE_FindTouches(signals, count,
+                              CAPSENSE_CENTROID_MAX_TOUCHES, positions);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Find the position of a touch on a row and column pad.
+ *
+ * @details
+ *   The row and column electrodes are each treated as a slider with a
+ *   single touch. Rows and columns come from the same frame when they are
+ *   in the same context and are read together.
+ *
+ * @param ctx
+ *   The context of the pad channels.
+ *
+ * @param rows
+ *   The row channels, in order.
+ *
+ * @param numRows
+ *   The number of rows.
+ *
+ * @param columns
+ *   The column channels, in order.
+ *
+ * @param numColumns
+ *   The number of columns.
+ *
+ * @param[out] x
+ *   The column position, CAPSENSE_CENTROID_RESOLUTION units per column.
+ *
+ * @param[out] y
+ *   The row position, CAPSENSE_CENTROID_RESOLUTION units per row.
+ *
+ * @return
+ *   true if the pad is touched.
+ *****************************************************************************/
+bool CAPSENSE_CtxGetPadPosition(CAPSENSE_Context_t *ctx,
+                                const uint8_t *rows,
+                                uint8_t numRows,
+                                const uint8_t *columns,
+                                uint8_t numColumns,
+                                int32_t *x,
+                                int32_t *y)
+{
+  uint8_t map[CAPSENSE_MAX_CHANNELS];
+  uint16_t signals[CAPSENSE_MAX_CHANNELS];
+  uint8_t i;
+
+  if ((uint32_t) numRows + numColumns > CAPSENSE_MAX_CHANNELS) {
+    return false;
+  }
+
+  // Read all electrodes from one frame
+  for (i = 0; i < numColumns; i++) {
+    map[i] = columns[i];
+  }
+  for (i = 0; i < numRows; i++) {
+    map[numColumns + i] = rows[i];
+  }
+  CAPSENSE_CtxGetSignals(ctx, map, numColumns + numRows, signals);
+
+  return (CAPSENSE_FindTouches(signals, numColumns, 1, x) == 1)
+         && (CAPSENSE_FindTouches(&signals[numColumns], numRows, 1, y) == 1);
+}
+
+#if defined(CAPSENSE_SLIDER_MAP)
+/**************************************************************************//**
+ * @brief Find the touches on the slider of the default context
+ * @details The slider channels are set with CAPSENSE_SLIDER_MAP.
+ * @param positions Filled in with up to CAPSENSE_CENTROID_MAX_TOUCHES
+ *        positions in ascending order.
+ * @return The number of touches.
+ *****************************************************************************/
+uint8_t CAPSENSE_GetSliderTouches(int32_t *positions)
+{
+  return CAPSENSE_CtxGetSliderTouches(CAPSENSE_GetDefaultContext(), sliderMap,
+                                      sizeof(sliderMap), positions);
+}
+#endif
+
+#if defined(CAPSENSE_PAD_ROWS) && defined(CAPSENSE_PAD_COLUMNS)
+/**************************************************************************//**
+ * @brief Find the position of a touch on the pad of the default context
+ * @details The pad channels are set with CAPSENSE_PAD_ROWS and
+ *          CAPSENSE_PAD_COLUMNS.
+ * @param[out] x The column position.
+ * @param[out] y The row position.
+ * @return true if the pad is touched.
+ *****************************************************************************/
+bool CAPSENSE_GetPadPosition(int32_t *x, int32_t *y)
+{
+  return CAPSENSE_CtxGetPadPosition(CAPSENSE_GetDefaultContext(),
+                                    padRows, sizeof(padRows),
+                                    padColumns, sizeof(padColumns), x, y);
+}
+#endif
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
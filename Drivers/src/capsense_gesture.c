@@ -0,0 +1,383 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense gesture recognizer
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "capsense_gesture.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+#if (CAPSENSE_GESTURE_HISTORY & (CAPSENSE_GESTURE_HISTORY - 1)) != 0
+#error "CAPSENSE_GESTURE_HISTORY must be a power of two"
+#endif
+#if (CAPSENSE_GESTURE_QUEUE_SIZE & (CAPSENSE_GESTURE_QUEUE_SIZE - 1)) != 0
+#error "CAPSENSE_GESTURE_QUEUE_SIZE must be a power of two"
+#endif
+
+/**************************************************************************//**
+ * @brief The longest touch in ms which is still a tap
+ *****************************************************************************/
+#if !defined(CAPSENSE_GESTURE_TAP_MS)
+#define CAPSENSE_GESTURE_TAP_MS         200
+#endif
+
+/**************************************************************************//**
+ * @brief The longest time in ms from the release of a tap to the touch of
+ *        the second tap of a double tap
+ *****************************************************************************/
+#if !defined(CAPSENSE_GESTURE_DOUBLE_TAP_MS)
+#define CAPSENSE_GESTURE_DOUBLE_TAP_MS  250
+#endif
+
+/**************************************************************************//**
+ * @brief The time in ms a touch must be held without movement for a hold
+ *****************************************************************************/
+#if !defined(CAPSENSE_GESTURE_HOLD_MS)
+#define CAPSENSE_GESTURE_HOLD_MS        500
+#endif
+
+/**************************************************************************//**
+ * @brief The longest touch in ms which is still a swipe
+ *****************************************************************************/
+#if !defined(CAPSENSE_GESTURE_SWIPE_MS)
+#define CAPSENSE_GESTURE_SWIPE_MS       600
+#endif
+
+/**************************************************************************//**
+ * @brief The movement, in slider position units, after which a touch is no
+ *        longer a tap or a hold. One channel is 16 units.
+ *****************************************************************************/
+#if !defined(CAPSENSE_GESTURE_MOVE_MIN)
+#define CAPSENSE_GESTURE_MOVE_MIN       8
+#endif
+
+/**************************************************************************//**
+ * @brief The shortest distance, in slider position units, of a swipe
+ *****************************************************************************/
+#if !defined(CAPSENSE_GESTURE_SWIPE_MIN)
+#define CAPSENSE_GESTURE_SWIPE_MIN      24
+#endif
+
+/**************************************************************************//**
+ * @brief The position change, in slider position units, reported by each
+ *        drag event
+ *****************************************************************************/
+#if !defined(CAPSENSE_GESTURE_DRAG_STEP)
+#define CAPSENSE_GESTURE_DRAG_STEP      4
+#endif
+
+/** Recognizer states. */
+#define GESTURE_IDLE            0   /**< Not touched */
+#define GESTURE_TOUCH           1   /**< Touched, not yet a hold */
+#define GESTURE_HOLD            2   /**< Touched and held */
+
+/** @endcond */
+
+/**************************************************************************//**
+ * @brief
+ *   Add an event to the gesture queue.
+ *
+ * @details
+ *   Single producer, single consumer queue like the touch event queue, so
+ *   CAPSENSE_GestureUpdate() may run from interrupt context.
+ *****************************************************************************/
+static void CAPSENSE_GesturePush(CAPSENSE_Gesture_t *gesture,
+                                 CAPSENSE_GestureType_t type,
+                                 int32_t position,
+                                 int32_t speed,
+                                 uint32_t timestamp)
+{
+  uint32_t head = gesture->eventHead;
+  CAPSENSE_GestureEvent_t *event;
+
+  if ((head - gesture->eventTail) >= CAPSENSE_GESTURE_QUEUE_SIZE) {
+    gesture->eventsDropped++;
+    return;
+  }
+
+  event = &gesture->events[head & (CAPSENSE_GESTURE_QUEUE_SIZE - 1)];
+  event->timestamp = timestamp;
+  event->position = position;
+  event->speed = speed;
+  event->type = type;
+
+  // Publish the event after it has been written
+  __DMB();
+  gesture->eventHead = head + 1;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Queue the pending tap if the time for a second tap has run out.
+ *****************************************************************************/
+static void CAPSENSE_GestureFlushTap(CAPSENSE_Gesture_t *gesture,
+                                     uint32_t timestamp,
+                                     bool force)
+{
+  if (gesture->tapPending
+      && (force || ((timestamp - gesture->tapTime)
+                    > CAPSENSE_GESTURE_DOUBLE_TAP_MS))) {
+    gesture->tapPending = false;
+    CAPSENSE_GesturePush(gesture, CAPSENSE_GESTURE_TAP,
+                         gesture->tapPosition, 0, gesture->tapTime);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Calculate the speed of the touch over the position history.
+ *
+ * @details
+ *   The speed is the distance from the oldest position in the history to
+ *   the newest, divided by the time between them.
+ *
+ * @return
+ *   The speed in position units per second.
+ *****************************************************************************/
+static int32_t CAPSENSE_GestureSpeed(const CAPSENSE_Gesture_t *gesture)
+{
+  const CAPSENSE_GestureSample_t *newest;
+  const CAPSENSE_GestureSample_t *oldest;
+  uint32_t count = gesture->samples;
+  uint32_t dt;
+
+  if (count < 2) {
+    return 0;
+  }
+  if (count > CAPSENSE_GESTURE_HISTORY) {
+    count = CAPSENSE_GESTURE_HISTORY;
+  }
+
+  newest = &gesture->history[(gesture->samples - 1)
+                             & (CAPSENSE_GESTURE_HISTORY - 1)];
+  oldest = &gesture->history[(gesture->samples - count)
+                             & (CAPSENSE_GESTURE_HISTORY - 1)];
+  dt = newest->timestamp - oldest->timestamp;
+  if (dt == 0) {
+    return 0;
+  }
+  return ((newest->position - oldest->position) * 1000) / (int32_t) dt;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Handle the release of the touch.
+ *****************************************************************************/
+static void CAPSENSE_GestureRelease(CAPSENSE_Gesture_t *gesture,
+                                    uint32_t timestamp)
+{
+  const CAPSENSE_GestureSample_t *last;
+  uint32_t duration = timestamp - gesture->startTime;
+  int32_t distance;
+
+  last = &gesture->history[(gesture->samples - 1)
+                           & (CAPSENSE_GESTURE_HISTORY - 1)];
+  distance = last->position - gesture->startPosition;
+
+  if (gesture->state == GESTURE_HOLD) {
+    CAPSENSE_GesturePush(gesture, CAPSENSE_GESTURE_HOLD_END,
+                         last->position, 0, timestamp);
+  } else if (gesture->moved) {
+    if (((distance >= CAPSENSE_GESTURE_SWIPE_MIN)
+         || (distance <= -CAPSENSE_GESTURE_SWIPE_MIN))
+        && (duration <= CAPSENSE_GESTURE_SWIPE_MS)) {
+      CAPSENSE_GesturePush(gesture, CAPSENSE_GESTURE_SWIPE, last->position,
+                           CAPSENSE_GestureSpeed(gesture), timestamp);
+    }
+  } else if (duration <= CAPSENSE_GESTURE_TAP_MS) {
+    if (gesture->tapPending) {
+      gesture->tapPending = false;
+      CAPSENSE_GesturePush(gesture, CAPSENSE_GESTURE_DOUBLE_TAP,
+                           gesture->startPosition, 0, timestamp);
+    } else {
+      gesture->tapPending = true;
+      gesture->tapTime = timestamp;
+      gesture->tapPosition = gesture->startPosition;
+    }
+  }
+
+  gesture->state = GESTURE_IDLE;
+}
+
+/**************************************************************************//**
+ * @brief Reset a gesture recognizer
+ * @param gesture The recognizer.
+ *****************************************************************************/
+void CAPSENSE_GestureInit(CAPSENSE_Gesture_t *gesture)
+{
+  gesture->samples = 0;
+  gesture->state = GESTURE_IDLE;
+  gesture->moved = false;
+  gesture->tapPending = false;
+  gesture->tapPosition = 0;
+  gesture->eventHead = 0;
+  gesture->eventTail = 0;
+  gesture->eventsDropped = 0;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Feed the slider position of a frame to a gesture recognizer.
+ *
+ * @details
+ *   Must be called once for every frame, also while the slider is not
+ *   touched, since pending taps are only reported when the time for a
+ *   second tap has run out. Each call takes constant time. The position
+ *   history only holds the last CAPSENSE_GESTURE_HISTORY positions of the
+ *   touch, which are used for the swipe speed.
+ *
+ * @param gesture
+ *   The recognizer.
+ *
+ * @param position
+ *   The position from CAPSENSE_getSliderPosition(), -1 if not touched.
+ *
+ * @param timestamp
+ *   The time of the frame in ms, for example the timestamp of the frame
+ *   from CAPSENSE_GetFrame().
+ *****************************************************************************/
+void CAPSENSE_GestureUpdate(CAPSENSE_Gesture_t *gesture,
+                            int32_t position,
+                            uint32_t timestamp)
+{
+  CAPSENSE_GestureSample_t *sample;
+  int32_t moved;
+
+  if (position < 0) {
+    if (gesture->state != GESTURE_IDLE) {
+      CAPSENSE_GestureRelease(gesture, timestamp);
+    }
+    CAPSENSE_GestureFlushTap(gesture, timestamp, false);
+    return;
+  }
+
+  if (gesture->state == GESTURE_IDLE) {
+    // Touch down, a new touch far from a pending tap is not a double tap
+    moved = position - gesture->tapPosition;
+    if ((moved > CAPSENSE_GESTURE_SWIPE_MIN)
+        || (moved < -CAPSENSE_GESTURE_SWIPE_MIN)) {
+      CAPSENSE_GestureFlushTap(gesture, timestamp, true);
+    } else {
+      CAPSENSE_GestureFlushTap(gesture, timestamp, false);
+    }
+    gesture->state = GESTURE_TOUCH;
+    gesture->samples = 0;
+    gesture->startPosition = position;
+    gesture->startTime = timestamp;
+    gesture->dragPosition = position;
+    gesture->moved = false;
+  }
+
+  sample = &gesture->history[gesture->samples & (CAPSENSE_GESTURE_HISTORY - 1)];
+  sample->position = position;
+  sample->timestamp = timestamp;
+  gesture->samples++;
+
+  moved = position - gesture->startPosition;
+  if ((moved >= CAPSENSE_GESTURE_MOVE_MIN)
+      || (moved <= -CAPSENSE_GESTURE_MOVE_MIN)) {
+    if (!gesture->moved) {
+      gesture->moved = true;
+      // A touch that moves is not the second tap of a double tap
+      CAPSENSE_GestureFlushTap(gesture, timestamp, true);
+    }
+  }
+
+  if (gesture->state == GESTURE_TOUCH) {
+    if (!gesture->moved
+        && ((timestamp - gesture->startTime) >= CAPSENSE_GESTURE_HOLD_MS)) {
+      gesture->state = GESTURE_HOLD;
+      CAPSENSE_GestureFlushTap(gesture, timestamp, true);
+      CAPSENSE_GesturePush(gesture, CAPSENSE_GESTURE_HOLD,
+                           position, 0, timestamp);
+    }
+  } else {
+    moved = position - gesture->dragPosition;
+    if ((moved >= CAPSENSE_GESTURE_DRAG_STEP)
+        || (moved <= -CAPSENSE_GESTURE_DRAG_STEP)) {
+      gesture->dragPosition = position;
+      CAPSENSE_GesturePush(gesture, CAPSENSE_GESTURE_DRAG,
+                           position, 0, timestamp);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief Get the oldest gesture event
+ * @details Must only be called from one thread of execution.
+ * @param gesture The recognizer.
+ * @param event Filled in with the event.
+ * @return true if an event was returned,
+ *         false if the queue is empty.
+ *****************************************************************************/
+bool CAPSENSE_GestureGetEvent(CAPSENSE_Gesture_t *gesture,
+                              CAPSENSE_GestureEvent_t *event)
+{
+  uint32_t tail = gesture->eventTail;
+
+  if (tail == gesture->eventHead) {
+    return false;
+  }
+
+  // Read the event before it can be overwritten
+  __DMB();
+  *event = gesture->events[tail & (CAPSENSE_GESTURE_QUEUE_SIZE - 1)];
+  __DMB();
+  gesture->eventTail = tail + 1;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief Get the number of gesture events lost because the queue was full
+ * @param gesture The recognizer.
+ * @return The number of events lost.
+ *****************************************************************************/
+uint32_t CAPSENSE_GestureGetDroppedEvents(const CAPSENSE_Gesture_t *gesture)
+{
+  return gesture->eventsDropped;
+}
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
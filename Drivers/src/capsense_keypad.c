@@ -0,0 +1,393 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense row and column keypad
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "capsense_keypad.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+#if (CAPSENSE_KEYPAD_MAX_ROWS > 32) || (CAPSENSE_KEYPAD_MAX_COLUMNS > 32)
+#error "A keypad has at most 32 rows and 32 columns"
+#endif
+
+/**************************************************************************//**
+ * @brief The number of frames between full scans of all rows when
+ *        CAPSENSE_KEYPAD_INCREMENTAL is defined
+ *****************************************************************************/
+#if !defined(CAPSENSE_KEYPAD_FULL_SCAN_FRAMES)
+#define CAPSENSE_KEYPAD_FULL_SCAN_FRAMES 16
+#endif
+
+/** The keypad being scanned. */
+static CAPSENSE_Keypad_t *activeKeypad;
+
+/** @endcond */
+
+/**************************************************************************//**
+ * @brief
+ *   Count the bits of a mask.
+ *****************************************************************************/
+static uint8_t CAPSENSE_KeypadBits(uint32_t mask)
+{
+  uint8_t bits = 0;
+
+  while (mask != 0) {
+    mask &= mask - 1;
+    bits++;
+  }
+  return bits;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Select the rows to measure in the next frame.
+ *
+ * @details
+ *   Without CAPSENSE_KEYPAD_INCREMENTAL all rows are measured. Otherwise
+ *   only the touched rows and their neighbours are measured. The columns
+ *   are always measured, so a touch on another row shows up as an
+ *   unexplained column and triggers a full scan in the next frame. All
+ *   rows are also measured every CAPSENSE_KEYPAD_FULL_SCAN_FRAMES frames
+ *   to keep their baselines current.
+ *****************************************************************************/
+static void CAPSENSE_KeypadSelectRows(CAPSENSE_Keypad_t *keypad,
+                                      uint32_t rowMask,
+                                      uint32_t columnMask)
+{
+  uint8_t numRows = keypad->rows.numChannels;
+  uint8_t row;
+#if defined(CAPSENSE_KEYPAD_INCREMENTAL)
+  uint32_t scanMask = rowMask | (rowMask << 1) | (rowMask >> 1);
+  bool full = (keypad->fullScanCountdown == 0)
+              || ((columnMask != 0) && (rowMask == 0));
+
+  if (full) {
+    keypad->fullScanCountdown = CAPSENSE_KEYPAD_FULL_SCAN_FRAMES;
+  } else {
+    keypad->fullScanCountdown--;
+  }
+  for (row = 0; row < numRows; row++) {
+    keypad->rowScan[row] = full || ((scanMask >> row) & 1);
+  }
+#else
+  (void) rowMask;
+  (void) columnMask;
+  for (row = 0; row < numRows; row++) {
+    keypad->rowScan[row] = true;
+  }
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Decode the keys from the touched rows and columns.
+ *
+ * @details
+ *   A touched key lowers the counts of its row and its column. One touched
+ *   row with any number of touched columns, or the other way around,
+ *   decodes to a unique set of keys. Two or more touched rows and columns
+ *   could be any of their crossings, so such a frame is rejected as
+ *   ghosting and the previous keys are kept.
+ *****************************************************************************/
+static void CAPSENSE_KeypadDecode(CAPSENSE_Keypad_t *keypad)
+{
+  uint8_t numRows = keypad->rows.numChannels;
+  uint8_t numColumns = keypad->columns.numChannels;
+  uint32_t rowMask = 0;
+  uint32_t columnMask = 0;
+  uint8_t row;
+  uint8_t column;
+  uint32_t key;
+  uint8_t measured = 0;
+
+  for (row = 0; row < numRows; row++) {
+    if (keypad->rowScan[row]) {
+      measured++;
+      if (CAPSENSE_CtxGetPressed(&keypad->rows, row)) {
+        rowMask |= 1UL << row;
+      }
+    }
+  }
+  for (column = 0; column < numColumns; column++) {
+    if (CAPSENSE_CtxGetPressed(&keypad->columns, column)) {
+      columnMask |= 1UL << column;
+    }
+  }
+  keypad->measurements = measured + numColumns;
+
+  if ((CAPSENSE_KeypadBits(rowMask) > 1)
+      && (CAPSENSE_KeypadBits(columnMask) > 1)) {
+    keypad->ghosts++;
+  } else {
+    for (key = 0; key < CAPSENSE_KEYPAD_KEY_BYTES; key++) {
+      keypad->keys[key] = 0;
+    }
+    for (row = 0; row < numRows; row++) {
+      if (!((rowMask >> row) & 1)) {
+        continue;
+      }
+      for (column = 0; column < numColumns; column++) {
+        if ((columnMask >> column) & 1) {
+          key = (uint32_t) row * numColumns + column;
+          keypad->keys[key >> 3] |= (uint8_t) (1U << (key & 7));
+        }
+      }
+    }
+    // Publish the keys after they have been written
+    __DMB();
+    keypad->keySeq++;
+  }
+
+  CAPSENSE_KeypadSelectRows(keypad, rowMask, columnMask);
+  CAPSENSE_CtxSetChannelMask(&keypad->rows, keypad->rowScan);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Called when the columns have been measured, completes the frame.
+ *****************************************************************************/
+static void CAPSENSE_KeypadColumnsDone(void)
+{
+  CAPSENSE_Keypad_t *keypad = activeKeypad;
+
+  CAPSENSE_KeypadDecode(keypad);
+  activeKeypad = NULL;
+  if (keypad->callback != NULL) {
+    keypad->callback();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Called when the rows have been measured, switches the analog buses to
+ *   the columns and measures them. If the columns can not be scanned the
+ *   frame is dropped without a decode, so the next scan can be started.
+ *****************************************************************************/
+static void CAPSENSE_KeypadRowsDone(void)
+{
+  if (!CAPSENSE_CtxStartScan(&activeKeypad->columns,
+                             CAPSENSE_KeypadColumnsDone)) {
+    activeKeypad = NULL;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Set up a row and column keypad.
+ *
+ * @details
+ *   Each key is a pair of electrodes, one on its row line and one on its
+ *   column line. A frame measures every row and every column once, so a
+ *   keypad of R rows and C columns needs R + C measurements for R * C
+ *   keys. The rows and columns may be on different ports, the analog bus
+ *   allocation is switched between the row and column phases.
+ *   CAPSENSE_Init() must be called first.
+ *
+ * @param keypad
+ *   The keypad.
+ *
+ * @param rows
+ *   The ACMP input of each row. Must stay valid while the keypad is used.
+ *
+ * @param numRows
+ *   The number of rows, at most CAPSENSE_KEYPAD_MAX_ROWS and
+ *   CAPSENSE_MAX_CHANNELS.
+ *
+ * @param rowBus
+ *   The bus allocation while measuring rows, or NULL for the default.
+ *
+ * @param columns
+ *   The ACMP input of each column. Must stay valid while the keypad is
+ *   used.
+ *
+ * @param numColumns
+ *   The number of columns, at most CAPSENSE_KEYPAD_MAX_COLUMNS and
+ *   CAPSENSE_MAX_CHANNELS.
+ *
+ * @param columnBus
+ *   The bus allocation while measuring columns, or NULL for the default.
+ *****************************************************************************/
+void CAPSENSE_KeypadInit(CAPSENSE_Keypad_t *keypad,
+                         const ACMP_Channel_TypeDef *rows,
+                         uint8_t numRows,
+                         const CAPSENSE_BusAlloc_t *rowBus,
+                         const ACMP_Channel_TypeDef *columns,
+                         uint8_t numColumns,
+                         const CAPSENSE_BusAlloc_t *columnBus)
+{
+  uint8_t i;
+
+  if (numRows > CAPSENSE_KEYPAD_MAX_ROWS) {
+    numRows = CAPSENSE_KEYPAD_MAX_ROWS;
+  }
+  if (numColumns > CAPSENSE_KEYPAD_MAX_COLUMNS) {
+    numColumns = CAPSENSE_KEYPAD_MAX_COLUMNS;
+  }
+
+  for (i = 0; i < CAPSENSE_KEYPAD_MAX_ROWS; i++) {
+    keypad->rowScan[i] = true;
+  }
+
+  CAPSENSE_CtxInit(&keypad->rows, rows, NULL, keypad->rowState, numRows);
+  CAPSENSE_CtxSetBusAlloc(&keypad->rows, rowBus);
+  CAPSENSE_CtxSetChannelMask(&keypad->rows, keypad->rowScan);
+  CAPSENSE_CtxInit(&keypad->columns, columns, NULL, keypad->columnState,
+                   numColumns);
+  CAPSENSE_CtxSetBusAlloc(&keypad->columns, columnBus);
+  for (i = 0; i < CAPSENSE_KEYPAD_KEY_BYTES; i++) {
+    keypad->keys[i] = 0;
+  }
+  keypad->keySeq = 0;
+  keypad->ghosts = 0;
+  keypad->measurements = 0;
+  keypad->fullScanCountdown = 0;
+  keypad->callback = NULL;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start a scan of the keypad and return immediately.
+ *
+ * @details
+ *   The rows are measured first and the columns are started from interrupt
+ *   context when the rows are done. The keys are decoded when the columns
+ *   are done, before the callback is called.
+ *
+ * @param keypad
+ *   The keypad.
+ *
+ * @param callback
+ *   Function to call from interrupt context when the keys have been
+ *   decoded, or NULL.
+ *
+ * @return
+ *   true if the scan was started,
+ *   false if a scan is already running.
+ *****************************************************************************/
+bool CAPSENSE_KeypadStartScan(CAPSENSE_Keypad_t *keypad,
+                              CAPSENSE_ScanCallback_t callback)
+{
+  if (activeKeypad != NULL) {
+    return false;
+  }
+
+  keypad->callback = callback;
+  activeKeypad = keypad;
+  if (!CAPSENSE_CtxStartScan(&keypad->rows, CAPSENSE_KeypadRowsDone)) {
+    activeKeypad = NULL;
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief Check if a key is pressed
+ * @param keypad The keypad.
+ * @param row The row of the key.
+ * @param column The column of the key.
+ * @return true if the key was pressed in the last decoded frame,
+ *         false if it was not or is not a key of the keypad.
+ *****************************************************************************/
+bool CAPSENSE_KeypadGetKey(CAPSENSE_Keypad_t *keypad,
+                           uint8_t row,
+                           uint8_t column)
+{
+  uint32_t key;
+
+  if ((row >= keypad->rows.numChannels)
+      || (column >= keypad->columns.numChannels)) {
+    return false;
+  }
+  key = (uint32_t) row * keypad->columns.numChannels + column;
+
+  return (keypad->keys[key >> 3] >> (key & 7)) & 1;
+}
+
+/**************************************************************************//**
+ * @brief Get a consistent copy of the pressed keys
+ * @param keypad The keypad.
+ * @param keys Filled in with CAPSENSE_KEYPAD_KEY_BYTES bytes, one bit for
+ *        each key in row major order.
+ *****************************************************************************/
+void CAPSENSE_KeypadGetKeys(CAPSENSE_Keypad_t *keypad, uint8_t *keys)
+{
+  uint32_t seq;
+  uint32_t i;
+
+  // The keys are only written from interrupt context, copy again if the
+  // copy was interrupted by a decode
+  do {
+    seq = keypad->keySeq;
+    __DMB();
+    for (i = 0; i < CAPSENSE_KEYPAD_KEY_BYTES; i++) {
+      keys[i] = keypad->keys[i];
+    }
+    __DMB();
+  } while (seq != keypad->keySeq);
+}
+
+/**************************************************************************//**
+ * @brief Get the number of measurements of the last keypad frame
+ * @param keypad The keypad.
+ * @return The number of rows and columns measured.
+ *****************************************************************************/
+uint8_t CAPSENSE_KeypadGetMeasurements(const CAPSENSE_Keypad_t *keypad)
+{
+  return keypad->measurements;
+}
+
+/**************************************************************************//**
+ * @brief Get the number of frames rejected because of ghosting
+ * @param keypad The keypad.
+ * @return The number of ambiguous frames.
+ *****************************************************************************/
+uint32_t CAPSENSE_KeypadGetGhosts(const CAPSENSE_Keypad_t *keypad)
+{
+  return keypad->ghosts;
+}
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
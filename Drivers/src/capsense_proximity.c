@@ -0,0 +1,307 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capacitive sense proximity detection
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "capsense_proximity.h"
+
+/***************************************************************************//**
+ * @addtogroup kitdrv
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup CapSense
+ * @{
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+#if !defined(CAPSENSE_PROXIMITY_WINDOW)
+#define CAPSENSE_PROXIMITY_WINDOW         200   /**< TIMER0 top value */
+#endif
+#if !defined(CAPSENSE_PROXIMITY_FRAMES)
+#define CAPSENSE_PROXIMITY_FRAMES         2     /**< Frames per level update */
+#endif
+#if !defined(CAPSENSE_PROXIMITY_BASELINE_SHIFT)
+#define CAPSENSE_PROXIMITY_BASELINE_SHIFT 8     /**< Baseline IIR weight 1/2^n */
+#endif
+#if !defined(CAPSENSE_PROXIMITY_RANGE)
+#define CAPSENSE_PROXIMITY_RANGE          64    /**< Signal of level 255, 1/4096 */
+#endif
+#if !defined(CAPSENSE_PROXIMITY_NEAR_LEVEL)
+#define CAPSENSE_PROXIMITY_NEAR_LEVEL     64    /**< Level reporting near */
+#endif
+#if !defined(CAPSENSE_PROXIMITY_MAX_NEAR)
+#define CAPSENSE_PROXIMITY_MAX_NEAR       256   /**< Updates before recalibrating */
+#endif
+
+/* TIMER1 samples the ACMP output through a synchronous PRS channel, so it
+ * counts at most one pulse every two HFCLK cycles, 256 per TIMER0 tick
+ * with the prescaler of 512. The count of one electrode must not wrap the
+ * 16 bit counter within the window. */
+#define CAPSENSE_PROXIMITY_MAX_COUNTS_PER_TICK 256UL
+
+#if (CAPSENSE_PROXIMITY_WINDOW * CAPSENSE_PROXIMITY_MAX_COUNTS_PER_TICK > 0xFFFFUL)
+#error "CAPSENSE_PROXIMITY_WINDOW is too long, the counts could wrap TIMER1"
+#endif
+
+/** Signal to level factor, level = (signal * factor) >> 16 */
+#define CAPSENSE_PROXIMITY_LEVEL_FACTOR \
+  ((255UL << 16) / CAPSENSE_PROXIMITY_RANGE)
+
+/** The proximity sensor being scanned. */
+static CAPSENSE_Proximity_t *activeProximity;
+
+/** @endcond */
+
+/**************************************************************************//**
+ * @brief
+ *   Update the proximity level from the accumulated counts.
+ *
+ * @details
+ *   An approaching hand adds capacitance to every electrode, lowering the
+ *   sum of their counts well before a touch would register on any one of
+ *   them. The signal is the drop of the sum below a slow baseline, and
+ *   the level grows linearly with it up to CAPSENSE_PROXIMITY_RANGE. The
+ *   baseline follows drift with a weight of 1/2^CAPSENSE_PROXIMITY_BASELINE_SHIFT
+ *   while nothing is near and is frozen otherwise. After
+ *   CAPSENSE_PROXIMITY_MAX_NEAR near updates, for example when an object
+ *   was left on the panel, the baseline is reset to the current sum.
+ *
+ *   The drop is scaled by a reciprocal of the baseline, which is only
+ *   recomputed once the baseline has moved by more than 1/256 since, so no
+ *   update divides while the baseline is steady.
+ *****************************************************************************/
+static void CAPSENSE_ProximityUpdate(CAPSENSE_Proximity_t *prox,
+                                     uint32_t sum)
+{
+  uint32_t base;
+  uint32_t signal;
+  uint32_t level;
+
+  if ((prox->baseline == 0)
+      || (prox->nearUpdates >= CAPSENSE_PROXIMITY_MAX_NEAR)) {
+    prox->baseline = sum << 8;
+    prox->nearUpdates = 0;
+    prox->recipBase = 0;
+  }
+
+  base = prox->baseline >> 8;
+  if ((base > prox->recipBase + (prox->recipBase >> 8))
+      || (base + (base >> 8) < prox->recipBase)) {
+    prox->recipBase = base;
+    prox->recip = (base == 0) ? 0 : UINT32_MAX / base;
+  }
+  signal = (sum < base)
+           ? (uint32_t) (((uint64_t) (base - sum) * prox->recip) >> 20) : 0;
+  level = (signal > CAPSENSE_PROXIMITY_RANGE) ? CAPSENSE_PROXIMITY_RANGE
+                                              : signal;
+  level = (level * CAPSENSE_PROXIMITY_LEVEL_FACTOR) >> 16;
+
+  prox->signal = (signal > UINT16_MAX) ? UINT16_MAX : (uint16_t) signal;
+  prox->level = (uint8_t) level;
+
+  // Release at half the near level
+  if (prox->level >= CAPSENSE_PROXIMITY_NEAR_LEVEL) {
+    prox->near = true;
+  } else if (prox->level < (CAPSENSE_PROXIMITY_NEAR_LEVEL / 2)) {
+    prox->near = false;
+  }
+
+  if (prox->near) {
+    prox->nearUpdates++;
+  } else {
+    prox->nearUpdates = 0;
+    prox->baseline += ((int32_t) (sum << 8) - (int32_t) prox->baseline)
+                      >> CAPSENSE_PROXIMITY_BASELINE_SHIFT;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Called when the electrodes have been measured, accumulates the frame.
+ *****************************************************************************/
+static void CAPSENSE_ProximityScanDone(void)
+{
+  CAPSENSE_Proximity_t *prox = activeProximity;
+  uint8_t channel;
+
+  for (channel = 0; channel < prox->ctx.numChannels; channel++) {
+    prox->sum += CAPSENSE_CtxGetVal(&prox->ctx, channel);
+  }
+  if (++prox->frames >= CAPSENSE_PROXIMITY_FRAMES) {
+    CAPSENSE_ProximityUpdate(prox, prox->sum);
+    prox->sum = 0;
+    prox->frames = 0;
+  }
+
+  activeProximity = NULL;
+  if (prox->callback != NULL) {
+    prox->callback();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Set up a proximity sensor.
+ *
+ * @details
+ *   The electrodes, typically the buttons of a panel, are combined into
+ *   one large sensor. The ACMP input mux connects a single pin at a time,
+ *   so the electrodes are measured in turn and their counts are summed.
+ *   Each one is measured with the long CAPSENSE_PROXIMITY_WINDOW, and
+ *   CAPSENSE_PROXIMITY_FRAMES frames are accumulated for each level update,
+ *   which resolves the small change of a hand some distance away.
+ *   CAPSENSE_Init() must be called first.
+ *
+ * @param prox
+ *   The proximity sensor.
+ *
+ * @param electrodes
+ *   The ACMP input of each electrode. Must stay valid while the sensor is
+ *   used.
+ *
+ * @param numElectrodes
+ *   The number of electrodes, at most CAPSENSE_MAX_CHANNELS.
+ *
+ * @param busAlloc
+ *   The bus allocation while measuring, or NULL for the default.
+ *
+ * @return
+ *   true if the sensor was set up,
+ *   false if there are more than CAPSENSE_MAX_CHANNELS electrodes.
+ *****************************************************************************/
+bool CAPSENSE_ProximityInit(CAPSENSE_Proximity_t *prox,
+                            const ACMP_Channel_TypeDef *electrodes,
+                            uint8_t numElectrodes,
+                            const CAPSENSE_BusAlloc_t *busAlloc)
+{
+  uint8_t channel;
+
+  if (numElectrodes > CAPSENSE_MAX_CHANNELS) {
+    return false;
+  }
+
+  CAPSENSE_CtxInit(&prox->ctx, electrodes, NULL, prox->state, numElectrodes);
+  CAPSENSE_CtxSetBusAlloc(&prox->ctx, busAlloc);
+  for (channel = 0; channel < prox->ctx.numChannels; channel++) {
+    CAPSENSE_CtxSetWindow(&prox->ctx, channel, CAPSENSE_PROXIMITY_WINDOW);
+  }
+
+  prox->sum = 0;
+  prox->baseline = 0;
+  prox->recipBase = 0;
+  prox->recip = 0;
+  prox->nearUpdates = 0;
+  prox->signal = 0;
+  prox->frames = 0;
+  prox->level = 0;
+  prox->near = false;
+  prox->callback = NULL;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start a scan of the proximity electrodes and return immediately.
+ *
+ * @details
+ *   The level is updated from interrupt context after every
+ *   CAPSENSE_PROXIMITY_FRAMES scans, before the callback is called. Meant
+ *   to run at a low rate while the application is idle, switching to
+ *   normal button scanning once CAPSENSE_ProximityIsNear() reports a hand.
+ *
+ * @param prox
+ *   The proximity sensor.
+ *
+ * @param callback
+ *   Function to call from interrupt context when the scan is done, or
+ *   NULL.
+ *
+ * @return
+ *   true if the scan was started,
+ *   false if a scan is already running.
+ *****************************************************************************/
+bool CAPSENSE_ProximityStartScan(CAPSENSE_Proximity_t *prox,
+                                 CAPSENSE_ScanCallback_t callback)
+{
+  if (activeProximity != NULL) {
+    return false;
+  }
+
+  prox->callback = callback;
+  activeProximity = prox;
+  if (!CAPSENSE_CtxStartScan(&prox->ctx, CAPSENSE_ProximityScanDone)) {
+    activeProximity = NULL;
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief Get the proximity level
+ * @param prox The proximity sensor.
+ * @return 0 with nothing near, up to 255 for a hand at the electrodes.
+ *****************************************************************************/
+uint8_t CAPSENSE_ProximityGetLevel(const CAPSENSE_Proximity_t *prox)
+{
+  return prox->level;
+}
+
+/**************************************************************************//**
+ * @brief Get the proximity signal, to tune the detection distance
+ * @param prox The proximity sensor.
+ * @return The drop of the summed counts below their baseline in 1/4096 of
+ *         the baseline.
+ *****************************************************************************/
+uint16_t CAPSENSE_ProximityGetSignal(const CAPSENSE_Proximity_t *prox)
+{
+  return prox->signal;
+}
+
+/**************************************************************************//**
+ * @brief Check if something is near the electrodes
+ * @param prox The proximity sensor.
+ * @return true once the level reached CAPSENSE_PROXIMITY_NEAR_LEVEL, until
+ *         it falls below half of it.
+ *****************************************************************************/
+bool CAPSENSE_ProximityIsNear(const CAPSENSE_Proximity_t *prox)
+{
+  return prox->near;
+}
+
+/** @} (end group CapSense) */
+/** @} (end group kitdrv) */
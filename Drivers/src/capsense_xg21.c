@@ -35,12 +35,21 @@
  ******************************************************************************/
 
 #include "em_device.h"
+#include "em_common.h"
 #include "em_acmp.h"
 #include "em_cmu.h"
+#include "em_core.h"
 #include "em_emu.h"
 #include "em_prs.h"
 #include "em_timer.h"
 #include "capsense.h"
+#if defined(CAPSENSE_LDMA_FRAMES)
+#include "em_ldma.h"
+#endif
+#if defined(CAPSENSE_CALIBRATION)
+#include <string.h>
+#include "em_msc.h"
+#endif
 
 /***************************************************************************//**
  * @addtogroup kitdrv
@@ -52,259 +61,3693 @@
  * @brief Capacitive sensing driver
  *
  * @details
- *  Capacitive sensing driver using TIMER and ACMP peripherals.
+ *  Capacitive sensing driver using TIMER and ACMP peripherals.
+ *
+ * @{
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+/** Marks an ACMP without a channel to measure */
+#define CHANNEL_NONE            0xFF
+
+#if (ACMP_CHANNELS > CAPSENSE_MAX_CHANNELS)
+#error "ACMP_CHANNELS must not be larger than CAPSENSE_MAX_CHANNELS"
+#endif
+
+#if (CAPSENSE_MAX_CHANNELS > 32)
+#error "CAPSENSE_MAX_CHANNELS must not be larger than 32, the batch masks have a bit per channel"
+#endif
+
+/** The context owning the ACMPs and TIMERs, NULL before the first scan. */
+static CAPSENSE_Context_t *activeCtx;
+/** The current channel we are sensing on each ACMP, CHANNEL_NONE if idle. */
+static volatile uint8_t currentChannels[CAPSENSE_ACMPS];
+/** The step of the scan table being measured */
+static uint8_t scanStep;
+/** ACMP INPUTCTRL without the input, for each resistor setting */
+static uint32_t inputCtrlBase[CAPSENSE_NUM_FREQUENCIES];
+/** Flag set while an interrupt chained scan is running. */
+static volatile bool scanActive;
+/** Function called from interrupt context when a scan completes. */
+static CAPSENSE_ScanCallback_t scanCallback;
+/** The bus allocation set up by CAPSENSE_Init(). */
+static CAPSENSE_BusAlloc_t initBusAlloc;
+/** Flag set while a wake on touch scan is running. */
+static volatile bool wakeScan;
+/** Set when a channel of the wake on touch scan is probably touched. */
+static bool wakeTouched;
+/** The ACMPs whose count has not reached the wake threshold, one bit each. */
+static volatile uint8_t wakePending;
+/** Function called from interrupt context when a wake on touch scan ends. */
+static CAPSENSE_WakeCallback_t wakeCallback;
+/** Flag set while a raw measurement for window tuning is running. */
+static volatile bool rawMeasureActive;
+/** Flag set while CAPSENSE_CtxProcessBatch() runs, no scan may start. */
+static volatile bool batchActive;
+/** The count of the last raw measurement. */
+static volatile uint32_t rawMeasureCount;
+/** TIMER0 ticks spent measuring since CAPSENSE_Init(), wraps. */
+static volatile uint32_t measureTicks;
+/** Interrupts taken by the driver since CAPSENSE_Init(), wraps. */
+static volatile uint32_t interruptCount;
+/** Set from CAPSENSE_EnableAcmps() until the ACMPs have started up. */
+static bool acmpsStarting;
+/** The step measured when the warm-up window expires, NULL if none. */
+static const CAPSENSE_ScanStep_t *warmupStep;
+
+/** TIMER0 prescaler set up by CAPSENSE_Init() */
+#define TIMER0_PRESCALE         512
+
+#if defined(CAPSENSE_CH_IN_USE)
+/**************************************************************************//**
+ * @brief
+ *   A bit vector which represents the channels to iterate through
+ *
+ * @note
+ *   This API is deprecated and new application should define
+ *   CAPSENSE_CHANNELS instead of CAPSENSE_CH_IN_USE.
+ *
+ * @param ACMP_CHANNELS
+ *   Vector of channels.
+ *****************************************************************************/
+static const bool channelsInUse[ACMP_CHANNELS] = CAPSENSE_CH_IN_USE;
+#elif defined(CAPSENSE_CHANNELS)
+/**************************************************************************//**
+ * @brief
+ *   An array of channels that the capsense driver should iterate through.
+ *
+ * @param CAPSENSE_CHANNELS
+ *   Initializer list that contains all the channels that the application
+ *   would like to use for capsense.
+ *
+ * @param ACMP_CHANNELS
+ *   The number of channels in the array
+ *****************************************************************************/
+static const ACMP_Channel_TypeDef channelList[ACMP_CHANNELS] = CAPSENSE_CHANNELS;
+#endif
+
+#if defined(CAPSENSE_CHANNEL_ACMP)
+/**************************************************************************//**
+ * @brief
+ *   The ACMP (0 or 1) measuring each channel. Channels on different ACMPs
+ *   are measured at the same time.
+ *
+ * @param CAPSENSE_CHANNEL_ACMP
+ *   Initializer list with one ACMP number for each channel.
+ *****************************************************************************/
+static const uint8_t channelAcmp[ACMP_CHANNELS] = CAPSENSE_CHANNEL_ACMP;
+
+#if !defined(CAPSENSE_ACMP1_CDBUSALLOC)
+#define CAPSENSE_ACMP1_CDBUSALLOC GPIO_CDBUSALLOC_CDEVEN0_ACMP1
+#endif
+#endif
+
+/** The comparators, indexed by ACMP number. */
+static ACMP_TypeDef * const acmps[CAPSENSE_ACMPS] = {
+  ACMP0,
+#if (CAPSENSE_ACMPS > 1)
+  ACMP1,
+#endif
+};
+
+/** The timers counting the pulses of each ACMP, indexed by ACMP number. */
+static TIMER_TypeDef * const counters[CAPSENSE_ACMPS] = {
+  TIMER1,
+#if (CAPSENSE_ACMPS > 1)
+  TIMER2,
+#endif
+};
+
+/** The interrupts of the counter timers, indexed by ACMP number. */
+static const IRQn_Type counterIrqs[CAPSENSE_ACMPS] = {
+  TIMER1_IRQn,
+#if (CAPSENSE_ACMPS > 1)
+  TIMER2_IRQn,
+#endif
+};
+
+/**************************************************************************//**
+ * @brief The NUM_SLIDER_CHANNELS specifies how many of the ACMP_CHANNELS
+ *        are used for a touch slider
+ *****************************************************************************/
+#if !defined(NUM_SLIDER_CHANNELS)
+#define NUM_SLIDER_CHANNELS 4
+#endif
+
+/**************************************************************************//**
+ * @brief The TIMER0 top value used for channels which have not been tuned
+ *****************************************************************************/
+#if !defined(CAPSENSE_WINDOW_DEFAULT)
+#define CAPSENSE_WINDOW_DEFAULT 10
+#endif
+
+/**************************************************************************//**
+ * @brief The TIMER0 top value of the window letting the ACMPs start up
+ *****************************************************************************/
+#if !defined(CAPSENSE_WARMUP_WINDOW)
+#define CAPSENSE_WARMUP_WINDOW 0
+#endif
+
+/**************************************************************************//**
+ * @brief The TIMER0 top value while a wake on touch window runs
+ * @details TIMER0 only tells how long the counts took to reach their
+ *          thresholds, it must not wrap within a window.
+ *****************************************************************************/
+#define CAPSENSE_WAKE_TOP       0xFFFF
+
+/**************************************************************************//**
+ * @brief The largest TIMER0 top value the window tuner may select
+ *****************************************************************************/
+#if !defined(CAPSENSE_WINDOW_MAX)
+#define CAPSENSE_WINDOW_MAX 100
+#endif
+
+/**************************************************************************//**
+ * @brief The count delta a touch must cause on a tuned channel
+ *****************************************************************************/
+#if !defined(CAPSENSE_TUNE_MIN_DELTA)
+#define CAPSENSE_TUNE_MIN_DELTA 16
+#endif
+
+/**************************************************************************//**
+ * @brief The expected count drop of a touch, in 1/256 of the baseline
+ *****************************************************************************/
+#if !defined(CAPSENSE_TUNE_TOUCH_RATIO)
+#define CAPSENSE_TUNE_TOUCH_RATIO 32
+#endif
+
+/**************************************************************************//**
+ * @brief The number of measurements the tuner may use for each channel
+ *****************************************************************************/
+#if !defined(CAPSENSE_TUNE_ITERATIONS)
+#define CAPSENSE_TUNE_ITERATIONS 4
+#endif
+
+/**************************************************************************//**
+ * @brief The baseline follows an idle channel with an IIR filter of weight
+ *        1 / 2^CAPSENSE_BASELINE_SHIFT
+ *****************************************************************************/
+#if !defined(CAPSENSE_BASELINE_SHIFT)
+#define CAPSENSE_BASELINE_SHIFT 6
+#endif
+
+/**************************************************************************//**
+ * @brief The maximum baseline increase per sample, in 1/256 counts
+ *****************************************************************************/
+#if !defined(CAPSENSE_BASELINE_MAX_RISE)
+#define CAPSENSE_BASELINE_MAX_RISE 64
+#endif
+
+/**************************************************************************//**
+ * @brief The maximum baseline decrease per sample, in 1/256 counts
+ *****************************************************************************/
+#if !defined(CAPSENSE_BASELINE_MAX_FALL)
+#define CAPSENSE_BASELINE_MAX_FALL 16
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   The state of the channels of the default context.
+ *
+ * @details
+ *   Each entry holds the latest value, the baseline, the packed fixed point
+ *   reciprocal of the baseline, the window and the filter state of one
+ *   channel. The reciprocal is m << 5 | l, where l = ceil(log2(max)) and
+ *   m = ceil(2^(24 + l) / max). For any 24 bit n, (n * m) >> (24 + l) is
+ *   exactly n / max.
+ * @param ACMP_CHANNELS Vector of channels.
+ *****************************************************************************/
+static CAPSENSE_ChannelState_t defaultState[ACMP_CHANNELS];
+
+/** The context used by the functions without a context parameter. */
+static CAPSENSE_Context_t defaultContext;
+
+/**************************************************************************//**
+ * @brief
+ *   Reciprocals used by the slider interpolation, ceil(2^20 / d) for
+ *   d = SLIDER_RECIP_MIN..256. For any n <= 2048, (n * m) >> 20 is exactly
+ *   n / d.
+ *****************************************************************************/
+#define SLIDER_RECIP_MIN        33
+static const uint16_t sliderRecip[256 - SLIDER_RECIP_MIN + 1] = {
+  31776, 30841, 29960, 29128, 28340, 27595, 26887, 26215,
+  25576, 24967, 24386, 23832, 23302, 22796, 22311, 21846,
+  21400, 20972, 20561, 20165, 19785, 19419, 19066, 18725,
+  18397, 18079, 17773, 17477, 17190, 16913, 16645, 16384,
+  16132, 15888, 15651, 15421, 15197, 14980, 14769, 14564,
+  14365, 14170, 13982, 13798, 13618, 13444, 13274, 13108,
+  12946, 12788, 12634, 12484, 12337, 12193, 12053, 11916,
+  11782, 11651, 11523, 11398, 11276, 11156, 11038, 10923,
+  10811, 10700, 10592, 10486, 10382, 10281, 10181, 10083,
+   9987,  9893,  9800,  9710,  9620,  9533,  9447,  9363,
+   9280,  9199,  9119,  9040,  8963,  8887,  8812,  8739,
+   8666,  8595,  8526,  8457,  8389,  8323,  8257,  8192,
+   8129,  8066,  8005,  7944,  7885,  7826,  7768,  7711,
+   7654,  7599,  7544,  7490,  7437,  7385,  7333,  7282,
+   7232,  7183,  7134,  7085,  7038,  6991,  6945,  6899,
+   6854,  6809,  6766,  6722,  6679,  6637,  6595,  6554,
+   6513,  6473,  6433,  6394,  6356,  6317,  6279,  6242,
+   6205,  6169,  6133,  6097,  6062,  6027,  5992,  5958,
+   5925,  5891,  5858,  5826,  5794,  5762,  5730,  5699,
+   5668,  5638,  5608,  5578,  5549,  5519,  5490,  5462,
+   5434,  5406,  5378,  5350,  5323,  5296,  5270,  5243,
+   5217,  5191,  5166,  5141,  5116,  5091,  5066,  5042,
+   5018,  4994,  4970,  4947,  4923,  4900,  4878,  4855,
+   4833,  4810,  4789,  4767,  4745,  4724,  4703,  4682,
+   4661,  4640,  4620,  4600,  4579,  4560,  4540,  4520,
+   4501,  4482,  4463,  4444,  4425,  4406,  4388,  4370,
+   4351,  4333,  4316,  4298,  4280,  4263,  4246,  4229,
+   4212,  4195,  4178,  4162,  4145,  4129,  4113,  4096
+};
+
+#if defined(CAPSENSE_LDMA_FRAMES)
+#if !defined(CAPSENSE_CHANNELS)
+#error "LDMA sample capture requires CAPSENSE_CHANNELS"
+#endif
+#if defined(CAPSENSE_CHANNEL_ACMP)
+#error "LDMA sample capture only supports ACMP0"
+#endif
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+#error "LDMA sample capture does not support CAPSENSE_NUM_FREQUENCIES > 1"
+#endif
+
+#if !defined(CAPSENSE_LDMA_CH)
+#define CAPSENSE_LDMA_CH        0     /**< LDMA channel sequencing the scan */
+#endif
+
+/** Largest number of samples captured in one half of the sample ring buffer. */
+#define LDMA_BATCH_SAMPLES      (CAPSENSE_LDMA_FRAMES * CAPSENSE_MAX_CHANNELS)
+/** Descriptors run for each sample: TIMER1 count, ACMP input, TIMER0 window. */
+#define LDMA_SAMPLE_DESCS       3
+
+/**************************************************************************//**
+ * @brief
+ *   Ring buffer of raw TIMER1 counts written by the LDMA. The CPU processes
+ *   one half while the LDMA fills the other.
+ *****************************************************************************/
+static volatile uint32_t ldmaSamples[2][LDMA_BATCH_SAMPLES];
+
+/** ACMP INPUTCTRL values written by the LDMA, one for each channel. */
+static uint32_t ldmaInputCtrl[CAPSENSE_MAX_CHANNELS];
+/** TIMER0 TOPB values written by the LDMA, one for each channel. */
+static uint32_t ldmaWindows[CAPSENSE_MAX_CHANNELS];
+
+/**************************************************************************//**
+ * @brief
+ *   Descriptor chain run by the LDMA, looping over both halves of the sample
+ *   ring buffer. Each sample is a triple of linked descriptors, so the count
+ *   is always copied before the next input and window are selected.
+ *****************************************************************************/
+static LDMA_Descriptor_t ldmaDesc[2 * LDMA_BATCH_SAMPLES][LDMA_SAMPLE_DESCS];
+
+/** Number of samples in one half of the sample ring buffer. */
+static uint32_t ldmaBatchSamples;
+/** The half of ldmaSamples that will complete next. */
+static uint8_t ldmaHalf;
+/** The channel of the next sample in ldmaSamples. */
+static uint8_t ldmaChannel;
+/** The raw TIMER1 count of the previous sample. */
+static uint32_t ldmaLastCount;
+/** Flag set while LDMA sample capture is running. */
+static volatile bool ldmaActive;
+/** Function called from interrupt context after each batch of frames. */
+static CAPSENSE_ScanCallback_t ldmaCallback;
+#endif
+
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+#if (CAPSENSE_EVENT_QUEUE_SIZE & (CAPSENSE_EVENT_QUEUE_SIZE - 1)) != 0
+#error "CAPSENSE_EVENT_QUEUE_SIZE must be a power of two"
+#endif
+
+#if !defined(CAPSENSE_DEBOUNCE_ATTACK)
+#define CAPSENSE_DEBOUNCE_ATTACK   2  /**< Touched frames before a press */
+#endif
+#if !defined(CAPSENSE_DEBOUNCE_RELEASE)
+#define CAPSENSE_DEBOUNCE_RELEASE  2  /**< Untouched frames before a release */
+#endif
+#if !defined(CAPSENSE_LONG_PRESS_MS)
+#define CAPSENSE_LONG_PRESS_MS     1000 /**< Press time before a long press */
+#endif
+#endif
+
+#if defined(CAPSENSE_CALIBRATION)
+#if !defined(CAPSENSE_CALIBRATION_STORAGE) && !defined(CAPSENSE_CALIBRATION_ADDR)
+#error "CAPSENSE_CALIBRATION needs a flash page in CAPSENSE_CALIBRATION_ADDR"
+#endif
+
+/** Identifies a calibration record, "CSCR" */
+#define CALIBRATION_MAGIC       0x52435343UL
+/** Incremented when the layout of the record changes */
+#define CALIBRATION_VERSION     1
+
+/** The stored calibration of one channel. */
+typedef struct {
+  uint32_t baseline;      /**< Baseline in 1/256 counts, 0 if unset */
+  uint16_t window;        /**< TIMER0 top value */
+  uint8_t  input;         /**< ACMP input, to detect a changed channel list */
+  uint8_t  acmp;          /**< ACMP number */
+} CalibrationChannel_TypeDef;
+
+/** The calibration record of a context. */
+typedef struct {
+  uint32_t magic;         /**< CALIBRATION_MAGIC */
+  uint16_t crc;           /**< CRC-16-CCITT of the rest of the record */
+  uint8_t  version;       /**< CALIBRATION_VERSION */
+  uint8_t  numChannels;   /**< Number of valid entries in channels */
+  CalibrationChannel_TypeDef channels[CAPSENSE_MAX_CHANNELS];
+} Calibration_TypeDef;
+#endif
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+#if !defined(CAPSENSE_FREQUENCIES)
+#error "CAPSENSE_FREQUENCIES must list CAPSENSE_NUM_FREQUENCIES resistor settings"
+#endif
+#if !defined(CAPSENSE_FREQ_LEVEL_SHIFT)
+#define CAPSENSE_FREQ_LEVEL_SHIFT 6   /**< IIR weight 1/2^n of the setting levels */
+#endif
+#if !defined(CAPSENSE_FREQ_NOISE_SHIFT)
+#define CAPSENSE_FREQ_NOISE_SHIFT 4   /**< IIR weight 1/2^n of the noise estimates */
+#endif
+/**
+ * Weights of a noise n = m * 2^e / 16 with 16 <= m < 32, round(2^18 / m^2)
+ * shifted right by 2 * e. The weights of a channel are taken relative to
+ * its least noisy setting, so they range from 1024 down to 0.
+ */
+#define FREQ_WEIGHT_MANTISSA    16
+static const uint16_t freqWeights[FREQ_WEIGHT_MANTISSA] = {
+  1024, 907, 809, 726, 655, 594, 542, 496,
+   455, 419, 388, 360, 334, 312, 291, 273
+};
+
+/** The ACMP capsense resistor of each setting, the first one is also used
+ *  for window tuning, wake on touch and LDMA scans */
+static const ACMP_CapsenseResistor_TypeDef frequencies[CAPSENSE_NUM_FREQUENCIES]
+  = CAPSENSE_FREQUENCIES;
+/** The setting measured by the running scan step */
+static uint8_t freqIndex;
+#endif
+
+#if defined(CAPSENSE_COMMON_MODE)
+#if !defined(CAPSENSE_COMMON_MODE_TRIM_SHIFT)
+#define CAPSENSE_COMMON_MODE_TRIM_SHIFT 2   /**< Trim n/2^k, at least 1, channels off each end */
+#endif
+#if !defined(CAPSENSE_COMMON_MODE_MIN_CHANNELS)
+#define CAPSENSE_COMMON_MODE_MIN_CHANNELS 3 /**< Fewest channels to estimate from */
+#endif
+#if (CAPSENSE_COMMON_MODE_MIN_CHANNELS < 3)
+#error "CAPSENSE_COMMON_MODE_MIN_CHANNELS must be at least 3 to trim both ends"
+#endif
+
+/** 2^24 / k, so the trimmed mean of k deviations needs no division */
+#define COMMON_MODE_RECIP(k)    ((int32_t) ((1UL << 24) / (k)))
+
+/** The reciprocals of the numbers of averaged deviations, at most 30 */
+static const int32_t commonModeRecip[31] = {
+  0,                     COMMON_MODE_RECIP(1),  COMMON_MODE_RECIP(2),
+  COMMON_MODE_RECIP(3),  COMMON_MODE_RECIP(4),  COMMON_MODE_RECIP(5),
+  COMMON_MODE_RECIP(6),  COMMON_MODE_RECIP(7),  COMMON_MODE_RECIP(8),
+  COMMON_MODE_RECIP(9),  COMMON_MODE_RECIP(10), COMMON_MODE_RECIP(11),
+  COMMON_MODE_RECIP(12), COMMON_MODE_RECIP(13), COMMON_MODE_RECIP(14),
+  COMMON_MODE_RECIP(15), COMMON_MODE_RECIP(16), COMMON_MODE_RECIP(17),
+  COMMON_MODE_RECIP(18), COMMON_MODE_RECIP(19), COMMON_MODE_RECIP(20),
+  COMMON_MODE_RECIP(21), COMMON_MODE_RECIP(22), COMMON_MODE_RECIP(23),
+  COMMON_MODE_RECIP(24), COMMON_MODE_RECIP(25), COMMON_MODE_RECIP(26),
+  COMMON_MODE_RECIP(27), COMMON_MODE_RECIP(28), COMMON_MODE_RECIP(29),
+  COMMON_MODE_RECIP(30),
+};
+#endif
+
+#if defined(CAPSENSE_STATS)
+#if !defined(CAPSENSE_STATS_BIN_SHIFT)
+#define CAPSENSE_STATS_BIN_SHIFT 2    /**< Histogram bin width 2^n counts */
+#endif
+
+/** Odd while the interrupt handlers update the statistics */
+static volatile uint32_t statsSeq;
+/** The timing statistics */
+static CAPSENSE_Stats_t timingStats;
+/** CPU cycles per TIMER0 tick */
+static uint32_t statsTickCycles;
+/** Expected end of the running measurement window */
+static uint32_t statsWindowEnd;
+/** Start of the running scan */
+static uint32_t statsScanStart;
+#endif
+
+#if defined(CAPSENSE_TRACE_SIZE)
+#if (CAPSENSE_TRACE_SIZE & (CAPSENSE_TRACE_SIZE - 1)) != 0
+#error "CAPSENSE_TRACE_SIZE must be a power of two"
+#endif
+
+#if !defined(CAPSENSE_TRACE_KEY_FRAMES)
+#define CAPSENSE_TRACE_KEY_FRAMES 64  /**< Frames between key frames */
+#endif
+
+/** Set in the tag byte of a key frame */
+#define TRACE_TAG_KEY           0x80
+/** Longest encoding of a 32 bit varint */
+#define TRACE_VARINT_MAX        5
+/** Longest record of a context, see CAPSENSE_TraceFrame() */
+#define TRACE_RECORD_MAX(n)     (1U + 3U * TRACE_VARINT_MAX \
+                                 + (n) * 4U * TRACE_VARINT_MAX)
+
+/** The trace ring buffer */
+static uint8_t traceBuffer[CAPSENSE_TRACE_SIZE];
+/** Bytes written, by the interrupt handlers */
+static volatile uint32_t traceHead;
+/** Bytes read, by the application */
+static volatile uint32_t traceTail;
+/** The traced context, or NULL while stopped */
+static CAPSENSE_Context_t * volatile traceCtx;
+/** Timestamp of the last traced frame */
+static uint32_t traceTime;
+/** Frames until the next key frame, 0 forces one */
+static uint32_t traceKeyCountdown;
+/** Frames lost to a full ring */
+static volatile uint32_t traceDropped;
+#endif
+
+/** @endcond */
+
+/**************************************************************************//**
+ * @brief
+ *   Get a timestamp in milliseconds for touch events.
+ *
+ * @details
+ *   The default implementation returns 0. The application should provide
+ *   its own time source.
+ *****************************************************************************/
+SL_WEAK uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return 0;
+}
+
+#if defined(CAPSENSE_STATS)
+/**************************************************************************//**
+ * @brief
+ *   Get the CPU cycle counter for the statistics.
+ *
+ * @details
+ *   The default implementation reads the DWT cycle counter, which
+ *   CAPSENSE_Init() enables. A host build replaces it with its virtual
+ *   time so its statistics are comparable with the target.
+ *****************************************************************************/
+SL_WEAK uint32_t CAPSENSE_GetCycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start an update of the statistics.
+ *
+ * @details
+ *   Updates are not nested. Outside interrupt context the update must be
+ *   made in a critical section, or a handler could start and complete its
+ *   own update in the middle of it and the readers would take the
+ *   statistics as consistent.
+ *****************************************************************************/
+static inline void CAPSENSE_StatsBegin(void)
+{
+  statsSeq++;
+  __DMB();
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Complete an update of the statistics.
+ *****************************************************************************/
+static inline void CAPSENSE_StatsEnd(void)
+{
+  __DMB();
+  statsSeq++;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Add a raw sample to the statistics of a channel.
+ *****************************************************************************/
+static void CAPSENSE_StatsSample(CAPSENSE_ChannelState_t *state,
+                                 uint32_t count)
+{
+  CAPSENSE_StatsAccum_t *acc = &state->stats;
+  int32_t bin = CAPSENSE_STATS_BINS / 2;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (state->maxValue != 0) {
+    bin += ((int32_t) count - (int32_t) state->maxValue)
+           >> CAPSENSE_STATS_BIN_SHIFT;
+    if (bin < 0) {
+      bin = 0;
+    } else if (bin >= CAPSENSE_STATS_BINS) {
+      bin = CAPSENSE_STATS_BINS - 1;
+    }
+  }
+
+  // Also called by CAPSENSE_CtxProcessBatch() outside interrupt context
+  CORE_ENTER_ATOMIC();
+  CAPSENSE_StatsBegin();
+  if ((acc->samples == 0) || (count < acc->min)) {
+    acc->min = count;
+  }
+  if (count > acc->max) {
+    acc->max = count;
+  }
+  acc->samples++;
+  acc->sum += count;
+  acc->sumSquares += (uint64_t) count * count;
+  acc->histogram[bin]++;
+  CAPSENSE_StatsEnd();
+  CORE_EXIT_ATOMIC();
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Calculate the packed fixed point reciprocal of a 16 bit divisor.
+ *
+ * @details
+ *   The 40 bit dividend 2^(24 + l) is split in two so that only 32 bit
+ *   divisions are needed.
+ *
+ * @return
+ *   The reciprocal in the format of the recip channel state, or 0 when d
+ *   is 0.
+ *****************************************************************************/
+static uint32_t CAPSENSE_Reciprocal(uint32_t d)
+{
+  uint32_t l;
+  uint32_t hi;
+  uint32_t rem;
+  uint32_t m;
+
+  if (d == 0) {
+    return 0;
+  }
+
+  l = (d > 1) ? (32 - __CLZ(d - 1)) : 0;
+
+  hi  = 1UL << (8 + l);
+  m   = (hi / d) << 16;
+  rem = (hi % d) << 16;
+  m  |= rem / d;
+  if (rem % d) {
+    m++;
+  }
+  return (m << 5) | l;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Divide by multiplying with a packed reciprocal.
+ * @param value A dividend below 2^32.
+ * @param recip The reciprocal of the divisor.
+ * @return value / divisor, rounded down
+ *****************************************************************************/
+static inline uint32_t CAPSENSE_Divide(uint32_t value, uint32_t recip)
+{
+  return (uint32_t) (((uint64_t) value * (recip >> 5))
+                     >> (24 + (recip & 0x1F)));
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Normalize a value with a packed reciprocal.
+ * @param value A 16 bit TIMER1 count.
+ * @param recip The reciprocal of the maximum value.
+ * @return value * 256 / max
+ *****************************************************************************/
+static inline uint32_t CAPSENSE_Normalize(uint32_t value, uint32_t recip)
+{
+  return (uint32_t) (((uint64_t) (value << 8) * (recip >> 5))
+                     >> (24 + (recip & 0x1F)));
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Update the baseline of a channel with a new sample.
+ *
+ * @details
+ *   While the channel is idle the baseline follows the sample slowly, and
+ *   never moves more than CAPSENSE_BASELINE_MAX_RISE or
+ *   CAPSENSE_BASELINE_MAX_FALL per sample. While the channel is touched
+ *   the baseline is frozen. A noise spike or a temperature drift therefore
+ *   only moves the touch threshold by a bounded amount.
+ *
+ * @return
+ *   The baseline in counts.
+ *****************************************************************************/
+static uint32_t CAPSENSE_UpdateBaseline(CAPSENSE_ChannelState_t *state,
+                                        uint32_t count)
+{
+  uint32_t baseline = state->baseline;
+  int32_t step;
+
+  if (baseline == 0) {
+    // First sample of the channel
+    baseline = count << 8;
+  } else if (count >= (baseline - (baseline >> 2)) >> 8) {
+    // Not touched, track with a bounded IIR step
+    step = ((int32_t) (count << 8) - (int32_t) baseline)
+           >> CAPSENSE_BASELINE_SHIFT;
+    if (step > CAPSENSE_BASELINE_MAX_RISE) {
+      step = CAPSENSE_BASELINE_MAX_RISE;
+    } else if (step < -CAPSENSE_BASELINE_MAX_FALL) {
+      step = -CAPSENSE_BASELINE_MAX_FALL;
+    }
+    baseline += step;
+  }
+
+  state->baseline = baseline;
+  return baseline >> 8;
+}
+
+#if defined(CAPSENSE_FILTER_ENABLED)
+/**************************************************************************//**
+ * @brief
+ *   Run a sample through the filter pipeline of a channel.
+ *
+ * @details
+ *   The stages are, in order:
+ *   - accumulation of 2^CAPSENSE_FILTER_OVERSAMPLE_SHIFT samples, which
+ *     decimates them to their average
+ *   - median of the last three decimated values
+ *   - first order IIR with weight 1/2^CAPSENSE_FILTER_IIR_SHIFT
+ *
+ * @param[in,out] count
+ *   The raw sample, replaced by the filter output.
+ *
+ * @return
+ *   true if the pipeline produced an output,
+ *   false if more samples are needed.
+ *****************************************************************************/
+static bool CAPSENSE_Filter(CAPSENSE_Filter_t *filter, uint32_t *count)
+{
+  uint32_t x = *count;
+
+#if (CAPSENSE_FILTER_OVERSAMPLE_SHIFT > 0)
+  filter->sum += x;
+  if (++filter->samples < (1U << CAPSENSE_FILTER_OVERSAMPLE_SHIFT)) {
+    return false;
+  }
+  x = filter->sum >> CAPSENSE_FILTER_OVERSAMPLE_SHIFT;
+  filter->sum = 0;
+  filter->samples = 0;
+#endif
+
+#if defined(CAPSENSE_FILTER_MEDIAN)
+  {
+    uint32_t a = filter->primed ? filter->history[0] : x;
+    uint32_t b = filter->primed ? filter->history[1] : x;
+
+    filter->history[0] = b;
+    filter->history[1] = x;
+
+    // Median of a, b and x
+    if (a > b) {
+      uint32_t t = a;
+      a = b;
+      b = t;
+    }
+    x = (x < a) ? a : ((x > b) ? b : x);
+  }
+#endif
+
+#if defined(CAPSENSE_FILTER_IIR_SHIFT)
+  if (!filter->primed) {
+    filter->iir = x << 8;
+  } else {
+    filter->iir += ((int32_t) (x << 8) - (int32_t) filter->iir)
+                   >> CAPSENSE_FILTER_IIR_SHIFT;
+  }
+  x = filter->iir >> 8;
+#endif
+
+  filter->primed = true;
+  *count = x;
+  return true;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Update the baseline of a channel with its value.
+ *
+ * @details
+ *   The baseline in counts and its reciprocal are only written when the
+ *   baseline changes by a whole count.
+ *****************************************************************************/
+static void CAPSENSE_TrackBaseline(CAPSENSE_ChannelState_t *state)
+{
+  uint32_t max = CAPSENSE_UpdateBaseline(state, state->value);
+
+  if (max != state->maxValue) {
+    state->maxValue = max;
+    state->recip = CAPSENSE_Reciprocal(max);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Store a new sample for a channel.
+ *
+ * @details
+ *   The sample is run through the filter pipeline. The filter output is
+ *   stored as the value of the channel and the baseline of the channel is
+ *   updated. With CAPSENSE_COMMON_MODE the baselines are only updated when
+ *   the frame is complete, from the values after common mode rejection.
+ *
+ * @return
+ *   true if a new value was stored,
+ *   false if the filter needs more samples.
+ *****************************************************************************/
+static bool CAPSENSE_StoreSample(CAPSENSE_Context_t *ctx,
+                                 uint8_t channel,
+                                 uint32_t count)
+{
+  CAPSENSE_ChannelState_t *state = &ctx->state[channel];
+
+#if defined(CAPSENSE_TRACE_SIZE)
+  state->raw = count;
+#endif
+
+#if defined(CAPSENSE_STATS)
+  CAPSENSE_StatsSample(state, count);
+#endif
+
+#if defined(CAPSENSE_FILTER_ENABLED)
+  if (!CAPSENSE_Filter(&state->filter, &count)) {
+    return false;
+  }
+#endif
+
+  // Store the value of the channel
+  state->value = count;
+
+#if !defined(CAPSENSE_COMMON_MODE)
+  CAPSENSE_TrackBaseline(state);
+#endif
+  return true;
+}
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+/**************************************************************************//**
+ * @brief
+ *   Combine the counts of a channel measured at every resistor setting.
+ *
+ * @details
+ *   Each setting makes the ACMP oscillate at a different frequency, so
+ *   narrowband interference near one of them only corrupts the samples of
+ *   that setting. The counts of the other settings are scaled to the first
+ *   one with the ratio of their slow averages. The noise of each setting
+ *   is tracked as the average change between consecutive samples, and the
+ *   result is the average of the scaled counts weighted by the inverse of
+ *   their squared noise. A clean setting therefore dominates while another
+ *   one is disturbed, and all settings count alike when none is.
+ *
+ *   This runs in the TIMER0 interrupt, so it only multiplies with the
+ *   reciprocals and weights of CAPSENSE_UpdateFrequencyWeights(), which
+ *   lag the levels and noise estimates by at most one scan. Until the
+ *   settings have levels the count of the first setting is used.
+ *
+ * @return
+ *   The combined count.
+ *****************************************************************************/
+static uint32_t CAPSENSE_CombineFrequencies(CAPSENSE_ChannelState_t *state)
+{
+  CAPSENSE_Frequency_t *f;
+  uint32_t sum = 0;
+  uint32_t x;
+  bool scaled = true;
+  uint8_t i;
+
+  for (i = 0; i < CAPSENSE_NUM_FREQUENCIES; i++) {
+    f = &state->freq[i];
+    x = f->sample;
+
+    if (f->level == 0) {
+      f->level = x << 8;
+      f->last = x;
+    } else {
+      f->level += ((int32_t) (x << 8) - (int32_t) f->level)
+                  >> CAPSENSE_FREQ_LEVEL_SHIFT;
+    }
+
+    // Scale to the first setting, whose level was updated above
+    if (i > 0) {
+      if (f->recip == 0) {
+        scaled = false;
+        continue;
+      }
+      x = CAPSENSE_Divide(x * (state->freq[0].level >> 8), f->recip);
+    }
+
+    f->noise += ((int32_t) (((x > f->last) ? x - f->last : f->last - x) << 8)
+                 - (int32_t) f->noise) >> CAPSENSE_FREQ_NOISE_SHIFT;
+    f->last = x;
+
+    sum += x * f->weight;
+  }
+
+  if (!scaled) {
+    // No levels before the first scan, the first setting stands alone
+    return state->freq[0].sample;
+  }
+  return CAPSENSE_Divide(sum, state->freqRecip);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Update the reciprocals and weights used to combine the resistor
+ *   settings of a channel.
+ *
+ * @details
+ *   The weights come from the freqWeights table, with the noise clamped
+ *   to at least one count. Without a level yet a setting is not scaled,
+ *   and without noise estimates all settings weigh the same. Called
+ *   before each scan so the divisions stay out of the interrupt.
+ *****************************************************************************/
+static void CAPSENSE_UpdateFrequencyWeights(CAPSENSE_ChannelState_t *state)
+{
+  CAPSENSE_Frequency_t *f;
+  uint32_t noise;
+  uint32_t shift;
+  uint32_t weights = 0;
+  uint8_t exponent[CAPSENSE_NUM_FREQUENCIES];
+  uint8_t least = 32;
+  uint8_t i;
+
+  for (i = 0; i < CAPSENSE_NUM_FREQUENCIES; i++) {
+    f = &state->freq[i];
+    f->recip = CAPSENSE_Reciprocal(f->level >> 8);
+
+    noise = (f->noise < 256) ? 256 : f->noise;
+    exponent[i] = (uint8_t) (32 - __CLZ(noise) - 5);
+    if (exponent[i] < least) {
+      least = exponent[i];
+    }
+  }
+
+  for (i = 0; i < CAPSENSE_NUM_FREQUENCIES; i++) {
+    f = &state->freq[i];
+    noise = (f->noise < 256) ? 256 : f->noise;
+    shift = 2 * (uint32_t) (exponent[i] - least);
+    f->weight = (shift < 16)
+                ? freqWeights[(noise >> exponent[i]) - FREQ_WEIGHT_MANTISSA]
+                  >> shift
+                : 0;
+    weights += f->weight;
+  }
+  state->freqRecip = CAPSENSE_Reciprocal(weights);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Store the sample of a channel at the current resistor setting.
+ *
+ * @return
+ *   true if a new value was stored,
+ *   false if more samples are needed.
+ *****************************************************************************/
+static bool CAPSENSE_StoreFrequency(CAPSENSE_Context_t *ctx,
+                                    uint8_t channel,
+                                    uint32_t count)
+{
+  CAPSENSE_ChannelState_t *state = &ctx->state[channel];
+
+  state->freq[freqIndex].sample = count;
+  if (freqIndex < (CAPSENSE_NUM_FREQUENCIES - 1)) {
+    return false;
+  }
+  return CAPSENSE_StoreSample(ctx, channel,
+                              CAPSENSE_CombineFrequencies(state));
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Get the ACMP input of a channel index.
+ *****************************************************************************/
+static inline ACMP_Channel_TypeDef
+CAPSENSE_ChannelInput(const CAPSENSE_Context_t *ctx, uint8_t channel)
+{
+  if (ctx->channels == NULL) {
+    return (ACMP_Channel_TypeDef) channel;
+  }
+  return ctx->channels[channel];
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Get the ACMP number of a channel index.
+ *****************************************************************************/
+static inline uint8_t CAPSENSE_ChannelAcmp(const CAPSENSE_Context_t *ctx,
+                                           uint8_t channel)
+{
+#if (CAPSENSE_ACMPS > 1)
+  if (ctx->channelAcmp != NULL) {
+    return ctx->channelAcmp[channel];
+  }
+#else
+  (void) ctx;
+  (void) channel;
+#endif
+  return 0;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Check if a channel index should be measured.
+ *****************************************************************************/
+static inline bool CAPSENSE_ChannelInUse(const CAPSENSE_Context_t *ctx,
+                                         uint8_t channel)
+{
+  return (ctx->inUse == NULL) || ctx->inUse[channel];
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Find the next channel index to measure on an ACMP.
+ *
+ * @param acmp
+ *   The ACMP number.
+ *
+ * @param channel
+ *   The first channel index to consider.
+ *
+ * @return
+ *   The next channel index in use, or CHANNEL_NONE if there are none left.
+ *****************************************************************************/
+static uint8_t CAPSENSE_NextChannel(const CAPSENSE_Context_t *ctx,
+                                    uint8_t acmp,
+                                    uint8_t channel)
+{
+  /* Skip the channels that are not in use or on another ACMP */
+  while (channel < ctx->numChannels) {
+    if (CAPSENSE_ChannelInUse(ctx, channel)
+        && (CAPSENSE_ChannelAcmp(ctx, channel) == acmp)) {
+      return channel;
+    }
+    channel++;
+  }
+  return CHANNEL_NONE;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Build the scan table of a context.
+ *
+ * @details
+ *   Each step holds the channels measured together, one on each ACMP, with
+ *   their ACMP inputs and the longest of their windows. Channels which are
+ *   not in use are left out, so the interrupt handler only walks the table
+ *   and writes registers. Rebuilt whenever the channel list, the channel
+ *   mask or a window changes.
+ *****************************************************************************/
+static void CAPSENSE_BuildScanTable(CAPSENSE_Context_t *ctx)
+{
+  CAPSENSE_ScanStep_t *step;
+  uint8_t next[CAPSENSE_ACMPS];
+  uint8_t numSteps = 0;
+  uint8_t channel;
+  uint8_t a;
+  bool found;
+
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    next[a] = CAPSENSE_NextChannel(ctx, a, 0);
+  }
+
+  // Every step takes at least one channel, so the table can not overflow
+  while (1) {
+    found = false;
+    for (a = 0; a < CAPSENSE_ACMPS; a++) {
+      found |= (next[a] != CHANNEL_NONE);
+    }
+    if (!found) {
+      break;
+    }
+
+    step = &ctx->steps[numSteps++];
+    step->window = 0;
+    for (a = 0; a < CAPSENSE_ACMPS; a++) {
+      channel = next[a];
+      step->channel[a] = channel;
+      step->input[a] = 0;
+      if (channel == CHANNEL_NONE) {
+        continue;
+      }
+      step->input[a] = (uint32_t) CAPSENSE_ChannelInput(ctx, channel)
+                       << _ACMP_INPUTCTRL_POSSEL_SHIFT;
+      if (ctx->state[channel].window > step->window) {
+        step->window = ctx->state[channel].window;
+      }
+      next[a] = CAPSENSE_NextChannel(ctx, a, channel + 1);
+    }
+  }
+  ctx->numSteps = numSteps;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Select the next step of a scan, one channel on each ACMP.
+ *
+ * @param first
+ *   true to select the first step of the scan.
+ *
+ * @return
+ *   true if there is a channel left to measure.
+ *****************************************************************************/
+static inline bool CAPSENSE_NextStep(const CAPSENSE_Context_t *ctx,
+                                     bool first)
+{
+  scanStep = first ? 0 : scanStep + 1;
+  return scanStep < ctx->numSteps;
+}
+
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+/**************************************************************************//**
+ * @brief
+ *   Add an event to the queue of a context. Only called from interrupt
+ *   context.
+ *
+ * @details
+ *   Single producer, single consumer event queue. The interrupt handlers
+ *   only write eventHead and the application only writes eventTail, so no
+ *   locking is needed.
+ *****************************************************************************/
+static void CAPSENSE_PushEvent(CAPSENSE_Context_t *ctx,
+                               uint8_t channel,
+                               CAPSENSE_EventType_t type,
+                               uint32_t timestamp)
+{
+  uint32_t head = ctx->eventHead;
+  CAPSENSE_Event_t *event;
+
+  if ((head - ctx->eventTail) >= CAPSENSE_EVENT_QUEUE_SIZE) {
+    ctx->eventsDropped++;
+    return;
+  }
+
+  event = &ctx->events[head & (CAPSENSE_EVENT_QUEUE_SIZE - 1)];
+  event->timestamp = timestamp;
+  event->channel = channel;
+  event->type = type;
+
+  // Publish the event after it has been written
+  __DMB();
+  ctx->eventHead = head + 1;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Run the debounce state machine of every channel of a context.
+ *
+ * @details
+ *   A press needs CAPSENSE_DEBOUNCE_ATTACK consecutive touched frames and
+ *   a release CAPSENSE_DEBOUNCE_RELEASE consecutive untouched frames. A
+ *   long press event is queued once when a press lasts
+ *   CAPSENSE_LONG_PRESS_MS.
+ *****************************************************************************/
+static void CAPSENSE_Debounce(CAPSENSE_Context_t *ctx)
+{
+  uint8_t channel;
+  uint32_t now = CAPSENSE_GetTimestamp();
+  CAPSENSE_Debounce_t *state;
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    if (!CAPSENSE_ChannelInUse(ctx, channel)) {
+      continue;
+    }
+    state = &ctx->state[channel].debounce;
+
+    if (CAPSENSE_CtxGetPressed(ctx, channel) == state->pressed) {
+      state->count = 0;
+    } else if (++state->count >= (state->pressed ? CAPSENSE_DEBOUNCE_RELEASE
+                                                 : CAPSENSE_DEBOUNCE_ATTACK)) {
+      state->count = 0;
+      state->pressed = !state->pressed;
+      if (state->pressed) {
+        state->pressTime = now;
+        state->longPress = false;
+        CAPSENSE_PushEvent(ctx, channel, CAPSENSE_EVENT_PRESS, now);
+      } else {
+        CAPSENSE_PushEvent(ctx, channel, CAPSENSE_EVENT_RELEASE, now);
+      }
+    }
+
+    if (state->pressed && !state->longPress
+        && ((now - state->pressTime) >= CAPSENSE_LONG_PRESS_MS)) {
+      state->longPress = true;
+      CAPSENSE_PushEvent(ctx, channel, CAPSENSE_EVENT_LONG_PRESS, now);
+    }
+  }
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Publish the current channel values of a context as a new frame.
+ *
+ * @details
+ *   Only called from interrupt context, or by CAPSENSE_CtxProcessBatch()
+ *   while the context is not scanned. Frame number n is written to
+ *   buffer n & 1 of each channel while readers may still copy frame n - 1
+ *   from the other buffer, and then published by advancing frameSeq.
+ *****************************************************************************/
+static void CAPSENSE_PublishFrame(CAPSENSE_Context_t *ctx)
+{
+  uint32_t seq = ctx->frameSeq + 1;
+  CAPSENSE_ChannelState_t *state;
+  CAPSENSE_ChannelFrame_t *frame;
+  uint8_t channel;
+
+  ctx->frameTime[seq & 1] = CAPSENSE_GetTimestamp();
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    state = &ctx->state[channel];
+    frame = &state->frames[seq & 1];
+    frame->value = state->value;
+    frame->maxValue = state->maxValue;
+    frame->recip = state->recip;
+  }
+
+  // Publish the frame after it has been written
+  __DMB();
+  ctx->frameSeq = seq;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start reading the last published frame of a context.
+ *
+ * @param[out] seq
+ *   The frame number, to pass to CAPSENSE_ReadRetry().
+ *
+ * @return
+ *   The index of the channel frame buffers to read from.
+ *****************************************************************************/
+static inline uint32_t CAPSENSE_ReadBegin(const CAPSENSE_Context_t *ctx,
+                                          uint32_t *seq)
+{
+  *seq = ctx->frameSeq;
+  __DMB();
+  return *seq & 1;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Check if a frame read must be retried.
+ *
+ * @details
+ *   Frames are only written from interrupt context, so a writer always
+ *   completes while a reader is interrupted. One new frame goes to the
+ *   other buffer and does not disturb the reader. Only when two or more
+ *   frames were published during the read may the buffer have been
+ *   overwritten.
+ *
+ * @return
+ *   true if the data read since CAPSENSE_ReadBegin() may be torn.
+ *****************************************************************************/
+static inline bool CAPSENSE_ReadRetry(const CAPSENSE_Context_t *ctx,
+                                      uint32_t seq)
+{
+  __DMB();
+  return (ctx->frameSeq - seq) > 1;
+}
+
+#if defined(CAPSENSE_COMMON_MODE)
+/**************************************************************************//**
+ * @brief
+ *   Sum a range of 16 bit values.
+ *
+ * @details
+ *   With the DSP extension, two values are packed with __PKHBT() and added
+ *   per __SMLAD().
+ *****************************************************************************/
+static int32_t CAPSENSE_Sum16(const int16_t *values, uint32_t first,
+                              uint32_t end)
+{
+  int32_t sum = 0;
+  uint32_t i = first;
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+  for (; (i + 1) < end; i += 2) {
+    sum = (int32_t) __SMLAD(__PKHBT((uint16_t) values[i],
+                                    (uint32_t) values[i + 1], 16),
+                            0x00010001UL, (uint32_t) sum);
+  }
+#endif
+  for (; i < end; i++) {
+    sum += values[i];
+  }
+  return sum;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Remove the shift common to all channels of a frame.
+ *
+ * @details
+ *   Supply noise and a hand hovering over the panel move the counts of all
+ *   channels together, so judging each channel against its own baseline
+ *   gives false presses or missed releases. The deviation of each channel
+ *   from its baseline is taken in 1/256 of the baseline and scaled to
+ *   1/4096, so the mean keeps a fraction of the step. The common mode
+ *   is the trimmed mean of the deviations. It drops the n/2^k, but at least
+ *   one, lowest and highest deviations, so a minority of touched channels
+ *   does not bias it. With three channels that is their median, which
+ *   still follows a shift while one of them is touched. The common mode is
+ *   removed from every channel value before the frame is published and
+ *   thresholded.
+ *
+ *   Channels without a baseline are left out. When fewer than
+ *   CAPSENSE_COMMON_MODE_MIN_CHANNELS channels remain the frame is left
+ *   as it is.
+ *****************************************************************************/
+static void CAPSENSE_CommonMode(CAPSENSE_Context_t *ctx)
+{
+  int16_t dev[CAPSENSE_MAX_CHANNELS];
+  CAPSENSE_ChannelState_t *state;
+  int32_t d;
+  int32_t common;
+  int32_t value;
+  uint32_t n = 0;
+  uint32_t trim;
+  uint32_t i;
+  uint8_t channel;
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    state = &ctx->state[channel];
+    if (!CAPSENSE_ChannelInUse(ctx, channel) || (state->recip == 0)) {
+      continue;
+    }
+    d = ((int32_t) CAPSENSE_Normalize(state->value, state->recip) - 256) << 4;
+    if (d > INT16_MAX) {
+      d = INT16_MAX;
+    }
+
+    // Insertion sort, the lists are short
+    for (i = n; (i > 0) && (dev[i - 1] > d); i--) {
+      dev[i] = dev[i - 1];
+    }
+    dev[i] = (int16_t) d;
+    n++;
+  }
+
+  if (n < CAPSENSE_COMMON_MODE_MIN_CHANNELS) {
+    return;
+  }
+
+  trim = n >> CAPSENSE_COMMON_MODE_TRIM_SHIFT;
+  if (trim == 0) {
+    trim = 1;
+  }
+  common = (int32_t) (((int64_t) CAPSENSE_Sum16(dev, trim, n - trim)
+                       * commonModeRecip[n - 2 * trim]) >> 24);
+  if (common == 0) {
+    return;
+  }
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    state = &ctx->state[channel];
+    if (!CAPSENSE_ChannelInUse(ctx, channel) || (state->recip == 0)) {
+      continue;
+    }
+    value = (int32_t) state->value
+            - (int32_t) (((int64_t) common * state->maxValue) >> 12);
+    state->value = (value > 0) ? (uint32_t) value : 0;
+  }
+}
+#endif
+
+#if defined(CAPSENSE_TRACE_SIZE)
+/**************************************************************************//**
+ * @brief
+ *   Write an unsigned LEB128 varint to the trace ring.
+ *
+ * @return
+ *   The ring position after the varint.
+ *****************************************************************************/
+static inline uint32_t CAPSENSE_TraceVarint(uint32_t pos, uint32_t x)
+{
+  while (x >= 0x80) {
+    traceBuffer[pos++ & (CAPSENSE_TRACE_SIZE - 1)] = (uint8_t) (x | 0x80);
+    x >>= 7;
+  }
+  traceBuffer[pos++ & (CAPSENSE_TRACE_SIZE - 1)] = (uint8_t) x;
+  return pos;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Write the difference of two counts to the trace ring as a zigzag
+ *   encoded varint, so small changes of either sign take one byte.
+ *
+ * @return
+ *   The ring position after the varint.
+ *****************************************************************************/
+static inline uint32_t CAPSENSE_TraceDelta(uint32_t pos,
+                                           uint32_t x,
+                                           uint32_t *last)
+{
+  int32_t delta = (int32_t) (x - *last);
+
+  *last = x;
+  return CAPSENSE_TraceVarint(pos, ((uint32_t) delta << 1)
+                                   ^ (uint32_t) (delta >> 31));
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Append the frame just published by a context to the trace. Only called
+ *   from interrupt context.
+ *
+ * @details
+ *   A record is the tag byte, the number of channels with TRACE_TAG_KEY
+ *   set for a key frame, followed by varints:
+ *   - the time since the previous record in milliseconds, or the
+ *     timestamp for a key frame
+ *   - a bitmap of the channels below their touch threshold
+ *   - a bitmap of the debounced pressed channels, 0 without events
+ *   - for each channel the raw sample, the filtered value and the baseline
+ *     in counts. A key frame stores them as plain varints followed by the
+ *     window, a delta frame as zigzag encoded differences from the
+ *     previous record.
+ *
+ *   With oversampling the raw sample is the last sample of the group. A
+ *   record is only written when it fits completely, otherwise the frame
+ *   is counted as dropped and the next record is a key frame. Key frames
+ *   are also written every CAPSENSE_TRACE_KEY_FRAMES frames, so a reader
+ *   can start decoding at any key frame.
+ *****************************************************************************/
+static void CAPSENSE_TraceFrame(CAPSENSE_Context_t *ctx)
+{
+  CAPSENSE_ChannelState_t *state;
+  uint32_t pos = traceHead;
+  uint32_t now = ctx->frameTime[ctx->frameSeq & 1];
+  uint32_t touched = 0;
+  uint32_t pressed = 0;
+  bool key;
+  uint8_t channel;
+
+  if ((CAPSENSE_TRACE_SIZE - (pos - traceTail))
+      < TRACE_RECORD_MAX(ctx->numChannels)) {
+    traceDropped++;
+    traceKeyCountdown = 0;
+    return;
+  }
+
+  key = (traceKeyCountdown == 0);
+  traceKeyCountdown = key ? CAPSENSE_TRACE_KEY_FRAMES - 1
+                          : traceKeyCountdown - 1;
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    state = &ctx->state[channel];
+    if (state->value < state->maxValue - (state->maxValue >> 2)) {
+      touched |= 1UL << channel;
+    }
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+    if (state->debounce.pressed) {
+      pressed |= 1UL << channel;
+    }
+#endif
+  }
+
+  traceBuffer[pos++ & (CAPSENSE_TRACE_SIZE - 1)] =
+    ctx->numChannels | (key ? TRACE_TAG_KEY : 0);
+  pos = CAPSENSE_TraceVarint(pos, key ? now : now - traceTime);
+  pos = CAPSENSE_TraceVarint(pos, touched);
+  pos = CAPSENSE_TraceVarint(pos, pressed);
+  traceTime = now;
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    state = &ctx->state[channel];
+    if (key) {
+      state->traced[0] = state->raw;
+      state->traced[1] = state->value;
+      state->traced[2] = state->maxValue;
+      pos = CAPSENSE_TraceVarint(pos, state->raw);
+      pos = CAPSENSE_TraceVarint(pos, state->value);
+      pos = CAPSENSE_TraceVarint(pos, state->maxValue);
+      pos = CAPSENSE_TraceVarint(pos, state->window);
+    } else {
+      pos = CAPSENSE_TraceDelta(pos, state->raw, &state->traced[0]);
+      pos = CAPSENSE_TraceDelta(pos, state->value, &state->traced[1]);
+      pos = CAPSENSE_TraceDelta(pos, state->maxValue, &state->traced[2]);
+    }
+  }
+
+  // Publish the record after it has been written
+  __DMB();
+  traceHead = pos;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Called from interrupt context when all channels have been measured.
+ *****************************************************************************/
+static void CAPSENSE_FrameComplete(CAPSENSE_Context_t *ctx)
+{
+#if defined(CAPSENSE_COMMON_MODE)
+  uint8_t channel;
+
+  CAPSENSE_CommonMode(ctx);
+
+  // The baselines follow the values without the common mode
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    if (CAPSENSE_ChannelInUse(ctx, channel)) {
+      CAPSENSE_TrackBaseline(&ctx->state[channel]);
+    }
+  }
+#endif
+
+  CAPSENSE_PublishFrame(ctx);
+
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+  CAPSENSE_Debounce(ctx);
+#endif
+
+#if defined(CAPSENSE_TRACE_SIZE)
+  if (ctx == traceCtx) {
+    CAPSENSE_TraceFrame(ctx);
+  }
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Connect the analog buses of a context to the ACMPs.
+ *****************************************************************************/
+static void CAPSENSE_ApplyBusAlloc(const CAPSENSE_Context_t *ctx)
+{
+  const CAPSENSE_BusAlloc_t *alloc = (ctx->busAlloc != NULL)
+                                     ? ctx->busAlloc : &initBusAlloc;
+
+  GPIO->ABUSALLOC = alloc->abus;
+  GPIO->BBUSALLOC = alloc->bbus;
+  GPIO->CDBUSALLOC = alloc->cdbus;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Get the count below which a channel is probably touched, the same
+ *   threshold as CAPSENSE_CtxGetPressed().
+ *****************************************************************************/
+static inline uint32_t CAPSENSE_WakeThreshold(const CAPSENSE_ChannelState_t *state)
+{
+  return state->maxValue - (state->maxValue >> 2);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Enable the ACMPs for sensing.
+ *
+ * @details
+ *   An ACMP only oscillates once its startup time has passed, so the first
+ *   window after this is preceded by a warm-up window, see
+ *   CAPSENSE_StartFirstWindow().
+ *****************************************************************************/
+static void CAPSENSE_EnableAcmps(void)
+{
+  uint8_t a;
+
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    ACMP_Enable(acmps[a]);
+  }
+  acmpsStarting = true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Disable the ACMPs while not sensing to reduce power consumption.
+ *****************************************************************************/
+static void CAPSENSE_DisableAcmps(void)
+{
+  uint8_t a;
+
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    ACMP_Disable(acmps[a]);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start measuring the current channels without waiting for completion.
+ *
+ * @details
+ *   Every ACMP with a channel counts pulses on its own timer, all gated by
+ *   the same TIMER0 window. Wake on touch windows are not gated, each count
+ *   interrupts once it reaches its threshold, see CAPSENSE_CounterIrq().
+ *
+ * @param window
+ *   The TIMER0 top value of the measurement.
+ *****************************************************************************/
+static void CAPSENSE_StartWindow(const CAPSENSE_Context_t *ctx,
+                                 const CAPSENSE_ScanStep_t *step)
+{
+  uint32_t window = step->window;
+  uint8_t channel;
+  uint8_t a;
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  uint32_t base = inputCtrlBase[(rawMeasureActive || wakeScan)
+                                ? 0 : freqIndex];
+#else
+  uint32_t base = inputCtrlBase[0];
+#endif
+
+  // Set up the specified channels
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    channel = step->channel[a];
+    currentChannels[a] = channel;
+    if (channel != CHANNEL_NONE) {
+      acmps[a]->INPUTCTRL = base | step->input[a];
+      if (wakeScan) {
+        // CC0 interrupts once the count reaches the touch threshold, a
+        // channel without a baseline right away
+        TIMER_CompareSet(counters[a], 0,
+                         (ctx->state[channel].maxValue == 0)
+                         ? 1 : CAPSENSE_WakeThreshold(&ctx->state[channel]));
+        TIMER_IntClear(counters[a], TIMER_IF_CC0);
+        TIMER_IntEnable(counters[a], TIMER_IEN_CC0);
+        wakePending |= 1U << a;
+      }
+    }
+  }
+
+  // Reset timers
+  TIMER_CounterSet(TIMER0, 0);
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    TIMER_CounterSet(counters[a], 0);
+  }
+
+  TIMER_IntClear(TIMER0, TIMER_IEN_OF);
+
+  if (wakePending != 0) {
+    // TIMER0 only measures the time, the counts end the window
+    TIMER_IntDisable(TIMER0, TIMER_IEN_OF);
+    TIMER_TopSet(TIMER0, CAPSENSE_WAKE_TOP);
+  } else {
+    TIMER_TopSet(TIMER0, window);
+    // TIMER0 overflows one tick after reaching the top value
+    measureTicks += window + 1;
+  }
+
+#if defined(CAPSENSE_STATS)
+  // TIMER0 overflows one tick after reaching the top value
+  statsWindowEnd = CAPSENSE_GetCycles() + (window + 1) * statsTickCycles;
+#endif
+
+  // Start timers
+  TIMER_Enable(TIMER0, true);
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    TIMER_Enable(counters[a], true);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start measuring the channels of the current scan step.
+ *
+ * @details
+ *   Channels measured together share the longest of their windows.
+ *****************************************************************************/
+static inline void CAPSENSE_StartMeasure(const CAPSENSE_Context_t *ctx)
+{
+  CAPSENSE_StartWindow(ctx, &ctx->steps[scanStep]);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start the first window after CAPSENSE_EnableAcmps().
+ *
+ * @details
+ *   A window started while the ACMPs are still starting up would count too
+ *   few pulses. A window of CAPSENSE_WARMUP_WINDOW without any channel
+ *   runs first instead, and the TIMER0 interrupt starts the window of the
+ *   step when it expires.
+ *
+ * @param step
+ *   The step to measure, which must stay valid until it has been started.
+ *****************************************************************************/
+static void CAPSENSE_StartFirstWindow(const CAPSENSE_Context_t *ctx,
+                                      const CAPSENSE_ScanStep_t *step)
+{
+  CAPSENSE_ScanStep_t warmup;
+  uint8_t a;
+
+  if (!acmpsStarting) {
+    CAPSENSE_StartWindow(ctx, step);
+    return;
+  }
+  acmpsStarting = false;
+
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    warmup.channel[a] = CHANNEL_NONE;
+  }
+  warmup.window = CAPSENSE_WARMUP_WINDOW;
+  warmupStep = step;
+  CAPSENSE_StartWindow(ctx, &warmup);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   TIMER0 interrupt handler.
+ *
+ * @details
+ *   When TIMER0 expires the number of pulses counted for each ACMP is
+ *   stored as the sample of its current channel in the active context.
+ *   When oversampling is enabled the same channels are measured again until
+ *   the filters have enough samples.
+ *   When a scan is running the next ACMP channels are selected and the
+ *   timers are restarted from here, so the scan completes without any
+ *   help from the application.
+ *****************************************************************************/
+static void CAPSENSE_TimerIrq(void)
+{
+  CAPSENSE_Context_t *ctx = activeCtx;
+  uint32_t count;
+  uint8_t a;
+  uint8_t channel;
+  bool stored = true;
+  CAPSENSE_ScanCallback_t callback;
+
+  interruptCount++;
+
+  // Stop timers
+  TIMER_Enable(TIMER0, false);
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    TIMER_Enable(counters[a], false);
+  }
+
+  // Clear interrupt flag
+  TIMER_IntClear(TIMER0, TIMER_IF_OF);
+
+  if (ctx == NULL) {
+    return;
+  }
+
+  if (warmupStep != NULL) {
+    // The ACMPs have started up, measure the first step
+    CAPSENSE_StartWindow(ctx, warmupStep);
+    warmupStep = NULL;
+    return;
+  }
+
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    channel = currentChannels[a];
+    if (channel == CHANNEL_NONE) {
+      continue;
+    }
+
+    // Save the pulse count
+    count = TIMER_CounterGet(counters[a]);
+
+    if (rawMeasureActive) {
+      // Window tuning, the count bypasses filters and baselines
+      rawMeasureCount = count;
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+    } else if (!CAPSENSE_StoreFrequency(ctx, channel, count)) {
+#else
+    } else if (!CAPSENSE_StoreSample(ctx, channel, count)) {
+#endif
+      stored = false;
+    }
+  }
+
+  if (rawMeasureActive) {
+    rawMeasureActive = false;
+    return;
+  }
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  // Rotate to the next resistor setting
+  freqIndex = (freqIndex < (CAPSENSE_NUM_FREQUENCIES - 1)) ? freqIndex + 1 : 0;
+#endif
+
+  if (!stored) {
+    // Next resistor setting or oversampling, measure the same channels again
+    CAPSENSE_StartMeasure(ctx);
+    return;
+  }
+
+  if (!scanActive) {
+    return;
+  }
+
+  // Chain the measurement of the next channels
+  if (CAPSENSE_NextStep(ctx, false)) {
+    CAPSENSE_StartMeasure(ctx);
+    return;
+  }
+
+  CAPSENSE_DisableAcmps();
+
+  CAPSENSE_FrameComplete(ctx);
+
+#if defined(CAPSENSE_STATS)
+  CAPSENSE_StatsBegin();
+  timingStats.scans++;
+  timingStats.scanCycles = CAPSENSE_GetCycles() - statsScanStart;
+  if (timingStats.scanCycles > timingStats.scanCyclesMax) {
+    timingStats.scanCyclesMax = timingStats.scanCycles;
+  }
+  CAPSENSE_StatsEnd();
+#endif
+
+  callback = scanCallback;
+  scanActive = false;
+  if (callback != NULL) {
+    callback();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Counter timer interrupt handler of a wake on touch scan.
+ *
+ * @details
+ *   The CC0 interrupt of a counter fires when its count reaches the touch
+ *   threshold. A channel reaching it within its window is not touched, a
+ *   touched channel takes longer, which TIMER0 tells. So an idle wake scan
+ *   takes one interrupt per counter and step, and each window ends as soon
+ *   as its counts have reached their thresholds.
+ *
+ * @param a
+ *   The ACMP of the counter.
+ *****************************************************************************/
+static void CAPSENSE_CounterIrq(uint8_t a)
+{
+  CAPSENSE_Context_t *ctx = activeCtx;
+  uint32_t ticks = TIMER_CounterGet(TIMER0);
+  uint8_t channel = currentChannels[a];
+
+  interruptCount++;
+  TIMER_Enable(counters[a], false);
+  TIMER_IntDisable(counters[a], TIMER_IEN_CC0);
+  TIMER_IntClear(counters[a], TIMER_IF_CC0);
+
+  if ((ctx == NULL) || !(wakePending & (1U << a))) {
+    return;
+  }
+  wakePending &= ~(1U << a);
+
+  // A channel without a baseline needs a full scan anyway
+  if ((ctx->state[channel].maxValue == 0)
+      || (ticks > ctx->steps[scanStep].window)) {
+    wakeTouched = true;
+  }
+  if (!wakeTouched && (wakePending != 0)) {
+    // The other ACMP of the step is still counting
+    return;
+  }
+
+  // Stop timers
+  TIMER_Enable(TIMER0, false);
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    TIMER_Enable(counters[a], false);
+    TIMER_IntDisable(counters[a], TIMER_IEN_CC0);
+  }
+  wakePending = 0;
+  measureTicks += ticks;
+
+  // Stop at the first probable touch
+  if (!wakeTouched && CAPSENSE_NextStep(ctx, false)) {
+    CAPSENSE_StartMeasure(ctx);
+    return;
+  }
+  CAPSENSE_DisableAcmps();
+  TIMER_IntClear(TIMER0, TIMER_IF_OF);
+  TIMER_IntEnable(TIMER0, TIMER_IEN_OF);
+  wakeScan = false;
+  scanActive = false;
+  if (wakeCallback != NULL) {
+    wakeCallback(wakeTouched);
+  }
+}
+
+/**************************************************************************//**
+ * @brief TIMER1 interrupt handler, see CAPSENSE_CounterIrq()
+ *****************************************************************************/
+void TIMER1_IRQHandler(void)
+{
+  CAPSENSE_CounterIrq(0);
+}
+
+#if (CAPSENSE_ACMPS > 1)
+/**************************************************************************//**
+ * @brief TIMER2 interrupt handler, see CAPSENSE_CounterIrq()
+ *****************************************************************************/
+void TIMER2_IRQHandler(void)
+{
+  CAPSENSE_CounterIrq(1);
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   TIMER0 interrupt handler, see CAPSENSE_TimerIrq().
+ *
+ * @details
+ *   With CAPSENSE_STATS defined the handler latency, measured from the
+ *   expected end of the window, and the handler run time are recorded.
+ *****************************************************************************/
+void TIMER0_IRQHandler(void)
+{
+#if defined(CAPSENSE_STATS)
+  uint32_t entry = CAPSENSE_GetCycles();
+  int32_t latency = (int32_t) (entry - statsWindowEnd);
+  uint32_t cycles;
+
+  CAPSENSE_TimerIrq();
+
+  cycles = CAPSENSE_GetCycles() - entry;
+  if (latency < 0) {
+    // The window ended early by the timer start delay
+    latency = 0;
+  }
+  CAPSENSE_StatsBegin();
+  timingStats.interrupts++;
+  timingStats.latencyTotal += (uint32_t) latency;
+  if ((uint32_t) latency > timingStats.latencyMax) {
+    timingStats.latencyMax = (uint32_t) latency;
+  }
+  timingStats.handlerTotal += cycles;
+  if (cycles > timingStats.handlerMax) {
+    timingStats.handlerMax = cycles;
+  }
+  CAPSENSE_StatsEnd();
+#else
+  CAPSENSE_TimerIrq();
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Set up a context for a group of channels.
+ *
+ * @details
+ *   The channel states are reset and every channel gets the default
+ *   window. The arrays are owned by the caller and must stay valid while
+ *   the context is used, so they are usually static. Must not be called
+ *   while the context is being scanned.
+ *
+ * @param ctx
+ *   The context.
+ *
+ * @param channels
+ *   The ACMP input of each channel, or NULL to use the channel index as
+ *   the input.
+ *
+ * @param channelAcmp
+ *   The ACMP (0 or 1) measuring each channel, or NULL to measure all
+ *   channels on ACMP0. Only used when CAPSENSE_CHANNEL_ACMP is defined.
+ *
+ * @param state
+ *   Storage for the state of numChannels channels.
+ *
+ * @param numChannels
+ *   The number of channels, at most CAPSENSE_MAX_CHANNELS.
+ *****************************************************************************/
+void CAPSENSE_CtxInit(CAPSENSE_Context_t *ctx,
+                      const ACMP_Channel_TypeDef *channels,
+                      const uint8_t *channelAcmp,
+                      CAPSENSE_ChannelState_t *state,
+                      uint8_t numChannels)
+{
+  const CAPSENSE_ChannelState_t reset = { .window = CAPSENSE_WINDOW_DEFAULT };
+  uint8_t channel;
+
+  if (numChannels > CAPSENSE_MAX_CHANNELS) {
+    numChannels = CAPSENSE_MAX_CHANNELS;
+  }
+
+  ctx->channels = channels;
+  ctx->channelAcmp = channelAcmp;
+  ctx->inUse = NULL;
+  ctx->busAlloc = NULL;
+  ctx->state = state;
+  ctx->numChannels = numChannels;
+  ctx->frameSeq = 0;
+  ctx->frameTime[0] = 0;
+  ctx->frameTime[1] = 0;
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+  ctx->eventHead = 0;
+  ctx->eventTail = 0;
+  ctx->eventsDropped = 0;
+#endif
+
+  for (channel = 0; channel < numChannels; channel++) {
+    state[channel] = reset;
+  }
+  CAPSENSE_BuildScanTable(ctx);
+}
+
+/**************************************************************************//**
+ * @brief Select the channels of a context to measure
+ * @details Channels which are not measured keep their last values. The
+ *          scan table is built from the flags, so call again after
+ *          changing them. Must not be called while the context is being
+ *          scanned.
+ * @param ctx The context.
+ * @param inUse One flag for each channel, or NULL to measure all channels.
+ *        The array must stay valid while the context is used.
+ *****************************************************************************/
+void CAPSENSE_CtxSetChannelMask(CAPSENSE_Context_t *ctx, const bool *inUse)
+{
+  ctx->inUse = inUse;
+  CAPSENSE_BuildScanTable(ctx);
+}
+
+/**************************************************************************//**
+ * @brief Set the analog bus allocation of a context
+ * @details The allocation is written to the GPIO before each scan of the
+ *          context, so contexts can use different ports or bus halves.
+ * @param ctx The context.
+ * @param busAlloc The allocation, or NULL for the one set up by
+ *        CAPSENSE_Init(). It must stay valid while the context is used.
+ *****************************************************************************/
+void CAPSENSE_CtxSetBusAlloc(CAPSENSE_Context_t *ctx,
+                             const CAPSENSE_BusAlloc_t *busAlloc)
+{
+  ctx->busAlloc = busAlloc;
+}
+
+/**************************************************************************//**
+ * @brief Get the context used by the functions without a context parameter
+ * @return The default context, set up from capsenseconfig.h.
+ *****************************************************************************/
+CAPSENSE_Context_t *CAPSENSE_GetDefaultContext(void)
+{
+  return &defaultContext;
+}
+
+/**************************************************************************//**
+ * @brief Get the channelValue of the last complete frame for a channel
+ * @param ctx The context.
+ * @param channel The channel.
+ * @return The channelValue.
+ *****************************************************************************/
+uint32_t CAPSENSE_CtxGetVal(CAPSENSE_Context_t *ctx, uint8_t channel)
+{
+  uint32_t seq;
+
+  return ctx->state[channel].frames[CAPSENSE_ReadBegin(ctx, &seq)].value;
+}
+
+/**************************************************************************//**
+ * @brief Get a consistent copy of the last complete frame
+ * @details All channels of the copy come from the same frame. The reader
+ *          never blocks the interrupt handlers, it copies again if a newer
+ *          frame overwrote the one being copied. Only the first numChannels
+ *          entries of the arrays are written.
+ * @param ctx The context.
+ * @param frame Filled in with the frame.
+ *****************************************************************************/
+void CAPSENSE_CtxGetFrame(CAPSENSE_Context_t *ctx, CAPSENSE_Frame_t *frame)
+{
+  const CAPSENSE_ChannelFrame_t *src;
+  uint32_t seq;
+  uint32_t buffer;
+  uint8_t channel;
+
+  do {
+    buffer = CAPSENSE_ReadBegin(ctx, &seq);
+    frame->frame = seq;
+    frame->timestamp = ctx->frameTime[buffer];
+    for (channel = 0; channel < ctx->numChannels; channel++) {
+      src = &ctx->state[channel].frames[buffer];
+      frame->values[channel] = src->value;
+      frame->maxValues[channel] = src->maxValue;
+    }
+  } while (CAPSENSE_ReadRetry(ctx, seq));
+}
+
+/**************************************************************************//**
+ * @brief Get the current normalized channelValue for a channel
+ * @param ctx The context.
+ * @param channel The channel.
+ * @return The channel value relative to the baseline, 256 at the baseline.
+ *****************************************************************************/
+uint32_t CAPSENSE_CtxGetNormalizedVal(CAPSENSE_Context_t *ctx, uint8_t channel)
+{
+  const CAPSENSE_ChannelFrame_t *frame;
+  uint32_t seq;
+  uint32_t value;
+  uint32_t recip;
+
+  do {
+    frame = &ctx->state[channel].frames[CAPSENSE_ReadBegin(ctx, &seq)];
+    value = frame->value;
+    recip = frame->recip;
+  } while (CAPSENSE_ReadRetry(ctx, seq));
+
+  return CAPSENSE_Normalize(value, recip);
+}
+
+/**************************************************************************//**
+ * @brief Get the touch signals of a group of channels
+ * @details All signals come from the same frame. A channel without a
+ *          baseline, or which is not a channel of the context, has a
+ *          signal of 0.
+ * @param ctx The context.
+ * @param map The channels to read.
+ * @param count The number of channels in map.
+ * @param signals Filled in with the drop of each channel below its
+ *        baseline, 0 at the baseline and 256 at a count of 0.
+ *****************************************************************************/
+void CAPSENSE_CtxGetSignals(CAPSENSE_Context_t *ctx,
+                            const uint8_t *map,
+                            uint8_t count,
+                            uint16_t *signals)
+{
+  const CAPSENSE_ChannelFrame_t *frame;
+  uint32_t seq;
+  uint32_t buffer;
+  uint32_t value;
+  uint8_t i;
+
+  do {
+    buffer = CAPSENSE_ReadBegin(ctx, &seq);
+    for (i = 0; i < count; i++) {
+      if (map[i] >= ctx->numChannels) {
+        signals[i] = 0;
+        continue;
+      }
+      frame = &ctx->state[map[i]].frames[buffer];
+      value = (frame->recip == 0) ? 256
+              : CAPSENSE_Normalize(frame->value, frame->recip);
+      signals[i] = (value < 256) ? (uint16_t) (256 - value) : 0;
+    }
+  } while (CAPSENSE_ReadRetry(ctx, seq));
+}
+
+/**************************************************************************//**
+ * @brief Get the state of the Gecko Button
+ * @param ctx The context.
+ * @param channel The channel.
+ * @return true if the button is "pressed"
+ *         false otherwise.
+ *****************************************************************************/
+bool CAPSENSE_CtxGetPressed(CAPSENSE_Context_t *ctx, uint8_t channel)
+{
+  const CAPSENSE_ChannelFrame_t *frame;
+  uint32_t seq;
+  uint32_t value;
+  uint32_t treshold;
+
+  /* Treshold is set to 12.5% below the maximum value */
+  /* Value and maximum are read from the same frame. */
+  do {
+    frame = &ctx->state[channel].frames[CAPSENSE_ReadBegin(ctx, &seq)];
+    treshold = frame->maxValue;
+    value = frame->value;
+  } while (CAPSENSE_ReadRetry(ctx, seq));
+  treshold -= treshold >> 2;
+
+  if (value < treshold) {
+    return true;
+  }
+  return false;
+}
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+/**************************************************************************//**
+ * @brief Get the noise of a channel at one resistor setting
+ * @param ctx The context.
+ * @param channel The channel.
+ * @param setting The index in CAPSENSE_FREQUENCIES.
+ * @return The average change between samples in 1/256 counts, scaled to
+ *         the first setting.
+ *****************************************************************************/
+uint32_t CAPSENSE_CtxGetNoise(CAPSENSE_Context_t *ctx, uint8_t channel,
+                              uint8_t setting)
+{
+  return ctx->state[channel].freq[setting].noise;
+}
+#endif
+
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+/**************************************************************************//**
+ * @brief Get the oldest touch event from the event queue of a context
+ * @details Must only be called from one thread of execution.
+ * @param ctx The context.
+ * @param event Filled in with the event.
+ * @return true if an event was returned,
+ *         false if the queue is empty.
+ *****************************************************************************/
+bool CAPSENSE_CtxGetEvent(CAPSENSE_Context_t *ctx, CAPSENSE_Event_t *event)
+{
+  uint32_t tail = ctx->eventTail;
+
+  if (tail == ctx->eventHead) {
+    return false;
+  }
+
+  // Read the event before it can be overwritten
+  __DMB();
+  *event = ctx->events[tail & (CAPSENSE_EVENT_QUEUE_SIZE - 1)];
+  __DMB();
+  ctx->eventTail = tail + 1;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief Get the number of events lost because the event queue was full
+ * @param ctx The context.
+ * @return The number of events lost.
+ *****************************************************************************/
+uint32_t CAPSENSE_CtxGetDroppedEvents(CAPSENSE_Context_t *ctx)
+{
+  return ctx->eventsDropped;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Interpolate the slider position from the levels of the slider channels.
+ *
+ * @param interpol
+ *   The levels of the slider channels at indexes 1 to channels, between two
+ *   edge entries of 255. Levels above 256 are clamped.
+ *
+ * @param channels
+ *   The number of slider channels.
+ *
+ * @return
+ *   The position of the slider if it can be determined,
+ *   -1 otherwise.
+ *****************************************************************************/
+static int32_t CAPSENSE_SliderPosition(uint32_t *interpol, int channels)
+{
+  int      i;
+  int      minPos = -1;
+  uint32_t minVal = 224; /* 0.875 * 256 */
+  /* The calculated slider position. */
+  int position;
+  /* Reciprocal of the divisor used for interpolation. */
+  uint32_t recip;
+
+  for (i = 1; i < (channels + 1); i++) {
+    /* interpol[i] will be in the range 0-256 depending on channelMax */
+    if (interpol[i] > 256) {
+      interpol[i] = 256;
+    }
+    /* Find the minimum value and position */
+    if (interpol[i] < minVal) {
+      minVal = interpol[i];
+      minPos = i;
+    }
+  }
+  /* Check if the slider has not been touched */
+  if (minPos == -1) {
+    return -1;
+  }
+
+  /* Start position. Shift by 4 to get additional resolution. */
+  /* Because of the interpol trick earlier we have to substract one to offset that effect */
+  position = (minPos - 1) << 4;
+
+  /* minVal is below 224, so the divisor is in the range of sliderRecip */
+  recip = sliderRecip[(256 - interpol[minPos]) - SLIDER_RECIP_MIN];
+
+  /* Interpolate with pad to the left */
+  position -= (((256 - interpol[minPos - 1]) << 3) * recip) >> 20;
+
+  /* Interpolate with pad to the right */
+  position += (((256 - interpol[minPos + 1]) << 3) * recip) >> 20;
+
+  return position;
+}
+
+/**************************************************************************//**
+ * @brief Get the position of the slider
+ * @details The slider is made of the first NUM_SLIDER_CHANNELS channels of
+ *          the context.
+ * @param ctx The context.
+ * @return The position of the slider if it can be determined,
+ *         -1 otherwise.
+ *****************************************************************************/
+int32_t CAPSENSE_CtxGetSliderPosition(CAPSENSE_Context_t *ctx)
+{
+  int      i;
+  int      channels = NUM_SLIDER_CHANNELS;
+  /* Values used for interpolation. There is two more which represents the edges.
+   * This makes the interpolation code a bit cleaner as we do not have to make special
+   * cases for handling them */
+  uint32_t interpol[(NUM_SLIDER_CHANNELS + 2)];
+  for (i = 0; i < (NUM_SLIDER_CHANNELS + 2); i++) {
+    interpol[i] = 255;
+  }
+
+  const CAPSENSE_ChannelFrame_t *frame;
+  uint32_t buffer;
+  uint32_t seq;
+
+  if (channels > ctx->numChannels) {
+    channels = ctx->numChannels;
+  }
+
+  /* Iterate through the slider bars and calculate the current value divided by
+   * the maximum value multiplied by 256. All the bars come from one frame.
+   * Note that there is an offset of 1 between the channels and interpol.
+   * This is done to make interpolation easier.
+   */
+  do {
+    buffer = CAPSENSE_ReadBegin(ctx, &seq);
+    for (i = 1; i < (channels + 1); i++) {
+      frame = &ctx->state[i - 1].frames[buffer];
+      interpol[i] = CAPSENSE_Normalize(frame->value, frame->recip);
+    }
+  } while (CAPSENSE_ReadRetry(ctx, seq));
+
+  return CAPSENSE_SliderPosition(interpol, channels);
+}
+
+/**************************************************************************//**
+ * @brief Process a batch of buffered frames in one pass
+ * @details Every count runs through the filter pipeline and the baseline
+ *          tracking of its channel like a sample measured by a scan, so the
+ *          results match processing the frames one at a time. Only the
+ *          filter and baseline recurrences are run sample by sample; the
+ *          levels, press bitmasks and slider positions of all frames are
+ *          computed in loops without dependencies between frames, and
+ *          without the frame reads of the per channel functions. The last
+ *          frame of the batch is published for those functions.
+ *
+ *          Common mode rejection, frequency combining, events and the trace
+ *          are not applied to batches. A channel is pressed with the
+ *          threshold of CAPSENSE_CtxGetPressed(). A count that only feeds
+ *          the filter, such as the first of an oversampled pair, leaves the
+ *          previous value in place and is left out of the valid mask of its
+ *          frame. With CAPSENSE_STATS the duration of the batch is kept in
+ *          the batchCycles statistic.
+ *
+ *          No scan can be started while the batch is processed.
+ * @param ctx The context.
+ * @param batch The batch, with frames and counts filled in.
+ * @return true if the batch was processed,
+ *         false if the context is being scanned or another batch is being
+ *         processed.
+ *****************************************************************************/
+bool CAPSENSE_CtxProcessBatch(CAPSENSE_Context_t *ctx, CAPSENSE_Batch_t *batch)
+{
+  CAPSENSE_ChannelState_t *state;
+  const uint16_t *counts;
+  uint16_t *values;
+  uint16_t *levels;
+  uint32_t maxValues[CAPSENSE_BATCH_FRAMES];
+  uint32_t recips[CAPSENSE_BATCH_FRAMES];
+  uint32_t interpol[(NUM_SLIDER_CHANNELS + 2)];
+  uint32_t frames = batch->frames;
+  uint32_t level;
+  uint32_t bit;
+  uint32_t s;
+  uint8_t channel;
+  int channels = NUM_SLIDER_CHANNELS;
+  int i;
+#if defined(CAPSENSE_STATS)
+  uint32_t start = CAPSENSE_GetCycles();
+#endif
+  CORE_DECLARE_IRQ_STATE;
+
+  // Claim the context before a scan can be started from interrupt context
+  CORE_ENTER_ATOMIC();
+  if (batchActive || ((activeCtx == ctx) && (scanActive
+#if defined(CAPSENSE_LDMA_FRAMES)
+                                             || ldmaActive
+#endif
+                                             ))) {
+    CORE_EXIT_ATOMIC();
+    return false;
+  }
+  batchActive = true;
+  CORE_EXIT_ATOMIC();
+
+  if (frames > CAPSENSE_BATCH_FRAMES) {
+    frames = CAPSENSE_BATCH_FRAMES;
+  }
+  if (channels > ctx->numChannels) {
+    channels = ctx->numChannels;
+  }
+
+  for (s = 0; s < frames; s++) {
+    batch->pressed[s] = 0;
+    batch->valid[s] = 0;
+  }
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    state = &ctx->state[channel];
+    counts = batch->counts[channel];
+    values = batch->values[channel];
+    levels = batch->levels[channel];
+    bit = 1UL << channel;
+
+    // Each sample depends on the filter and baseline after the previous one
+    for (s = 0; s < frames; s++) {
+      if (CAPSENSE_StoreSample(ctx, channel, counts[s])) {
+#if defined(CAPSENSE_COMMON_MODE)
+        // Batches are processed without common mode rejection
+        CAPSENSE_TrackBaseline(state);
+#endif
+        batch->valid[s] |= bit;
+      }
+      values[s] = (uint16_t) state->value;
+      maxValues[s] = state->maxValue;
+      recips[s] = state->recip;
+    }
+
+    // Independent per frame
+    for (s = 0; s < frames; s++) {
+      level = (recips[s] == 0) ? 256 : CAPSENSE_Normalize(values[s], recips[s]);
+      levels[s] = (uint16_t) ((level > 0xFFFF) ? 0xFFFF : level);
+      batch->pressed[s] |= (values[s] < maxValues[s] - (maxValues[s] >> 2))
+                           ? bit : 0;
+    }
+  }
+
+  for (s = 0; s < frames; s++) {
+    interpol[0] = 255;
+    for (i = 1; i < (NUM_SLIDER_CHANNELS + 2); i++) {
+      interpol[i] = (i <= channels) ? batch->levels[i - 1][s] : 255;
+    }
+    batch->slider[s] = (int16_t) CAPSENSE_SliderPosition(interpol, channels);
+  }
+
+  if (frames > 0) {
+    CAPSENSE_PublishFrame(ctx);
+  }
+
+#if defined(CAPSENSE_STATS)
+  // See CAPSENSE_StatsBegin()
+  CORE_ENTER_ATOMIC();
+  CAPSENSE_StatsBegin();
+  timingStats.batchCycles = CAPSENSE_GetCycles() - start;
+  CAPSENSE_StatsEnd();
+  CORE_EXIT_ATOMIC();
+#endif
+  batchActive = false;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Sleep in EM1 while a flag cleared from interrupt context is set.
+ *****************************************************************************/
+static void CAPSENSE_WaitWhile(volatile bool *flag)
+{
+#if defined(CAPSENSE_STATS)
+  uint32_t start = CAPSENSE_GetCycles();
+#endif
+
+  /* Interrupts are masked between the check and the sleep so that the
+   * flag can not be cleared unnoticed. A pending interrupt still wakes the
+   * core up from EM1. */
+  __disable_irq();
+  while (*flag) {
+    EMU_EnterEM1();
+    __enable_irq();
+    __disable_irq();
+  }
+  __enable_irq();
+
+#if defined(CAPSENSE_STATS)
+  // Only updated from thread context, see CAPSENSE_GetStats()
+  timingStats.waitCycles += CAPSENSE_GetCycles() - start;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start a scan of all the channels of a context and return immediately.
+ *
+ * @details
+ *   The TIMER0 interrupt handler moves the ACMP to the next channel and
+ *   restarts the timers after each measurement. When the last channel has
+ *   been measured the scan is complete and the callback is called from
+ *   interrupt context. Contexts share the hardware, so only one of them
+ *   can be scanned at a time.
+ *
+ * @param ctx
+ *   The context.
+ *
+ * @param callback
+ *   Function to call when the scan is complete, or NULL to only poll with
+ *   CAPSENSE_CtxScanComplete().
+ *
+ * @return
+ *   true if the scan was started,
+ *   false if a scan of any context is already running.
+ *****************************************************************************/
+bool CAPSENSE_CtxStartScan(CAPSENSE_Context_t *ctx,
+                           CAPSENSE_ScanCallback_t callback)
+{
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  uint8_t channel;
+#endif
+
+  if (scanActive || rawMeasureActive || batchActive) {
+    return false;
+  }
+
+#if defined(CAPSENSE_LDMA_FRAMES)
+  if (ldmaActive) {
+    return false;
+  }
+#endif
+
+  if (!CAPSENSE_NextStep(ctx, true)) {
+    if (callback != NULL) {
+      callback();
+    }
+    return true;
+  }
+
+  // Use the default STK capacative sensing setup and enable it
+  CAPSENSE_EnableAcmps();
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    CAPSENSE_UpdateFrequencyWeights(&ctx->state[channel]);
+  }
+#endif
+
+  activeCtx = ctx;
+  scanCallback = callback;
+  scanActive = true;
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  freqIndex = 0;
+#endif
+#if defined(CAPSENSE_STATS)
+  statsScanStart = CAPSENSE_GetCycles();
+#endif
+  CAPSENSE_ApplyBusAlloc(ctx);
+  CAPSENSE_StartFirstWindow(ctx, &ctx->steps[scanStep]);
+
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start a wake on touch scan of a context and return immediately.
+ *
+ * @details
+ *   Each channel is measured once. Instead of the filter and baseline
+ *   pipeline, the CC0 interrupt of the counter timer ends the window when
+ *   the count reaches the touch threshold of the channel, taken from its
+ *   baseline, and TIMER0 only tells whether that took longer than the
+ *   window of the channel. The scan stops at the first channel which does
+ *   not reach its threshold in time. No frame is published and the ACMPs
+ *   are disabled at the end.
+ *
+ *   Typically started from an EM2 wakeup of a low frequency timer while
+ *   the electrodes are idle. The application only needs to wake up when
+ *   the callback reports a probable touch, and then scans at full rate
+ *   with CAPSENSE_CtxStartScan() until the touch is released.
+ *
+ * @param ctx
+ *   The context.
+ *
+ * @param callback
+ *   Function to call from interrupt context when the scan ends, with
+ *   true if a channel is probably touched.
+ *
+ * @return
+ *   true if the scan was started,
+ *   false if a scan of any context is already running.
+ *****************************************************************************/
+bool CAPSENSE_CtxStartWakeScan(CAPSENSE_Context_t *ctx,
+                               CAPSENSE_WakeCallback_t callback)
+{
+  if (scanActive || rawMeasureActive || batchActive) {
+    return false;
+  }
+
+#if defined(CAPSENSE_LDMA_FRAMES)
+  if (ldmaActive) {
+    return false;
+  }
+#endif
+
+  if (!CAPSENSE_NextStep(ctx, true)) {
+    if (callback != NULL) {
+      callback(false);
+    }
+    return true;
+  }
+
+  CAPSENSE_EnableAcmps();
+
+  activeCtx = ctx;
+  wakeCallback = callback;
+  wakeTouched = false;
+  wakeScan = true;
+  scanActive = true;
+  CAPSENSE_ApplyBusAlloc(ctx);
+  CAPSENSE_StartFirstWindow(ctx, &ctx->steps[scanStep]);
+
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief Check if the last scan of a context is done
+ * @param ctx The context.
+ * @return true if the context is not being scanned.
+ *****************************************************************************/
+bool CAPSENSE_CtxScanComplete(CAPSENSE_Context_t *ctx)
+{
+  return !scanActive || (activeCtx != ctx);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   This function iterates through all the channels of a context and
+ *   initiates a reading. Uses EM1 while waiting for the result from
+ *   each sensor.
+ *
+ * @param ctx
+ *   The context.
+ *
+ * @return
+ *   true if the channels were measured,
+ *   false if a scan is already running.
+ *****************************************************************************/
+bool CAPSENSE_CtxSense(CAPSENSE_Context_t *ctx)
+{
+  if (!CAPSENSE_CtxStartScan(ctx, NULL)) {
+    return false;
+  }
+
+  CAPSENSE_WaitWhile(&scanActive);
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Measure a channel with a given window and wait for the raw count.
+ *****************************************************************************/
+static uint32_t CAPSENSE_MeasureRaw(CAPSENSE_Context_t *ctx,
+                                    uint8_t channel,
+                                    uint32_t window)
+{
+  CAPSENSE_ScanStep_t step;
+  uint8_t a;
+
+  for (a = 0; a < CAPSENSE_ACMPS; a++) {
+    step.channel[a] = CHANNEL_NONE;
+  }
+  a = CAPSENSE_ChannelAcmp(ctx, channel);
+  step.channel[a] = channel;
+  step.input[a] = (uint32_t) CAPSENSE_ChannelInput(ctx, channel)
+                  << _ACMP_INPUTCTRL_POSSEL_SHIFT;
+  step.window = window;
+
+  activeCtx = ctx;
+  rawMeasureActive = true;
+  CAPSENSE_ApplyBusAlloc(ctx);
+  CAPSENSE_StartFirstWindow(ctx, &step);
+  CAPSENSE_WaitWhile(&rawMeasureActive);
+  return rawMeasureCount;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Reset the filters and the baseline of a channel.
+ *
+ * @details
+ *   Used when the window of a channel changes, since the counts measured
+ *   before are no longer comparable. The caller keeps the TIMER0 interrupt
+ *   from updating the channel meanwhile.
+ *****************************************************************************/
+static void CAPSENSE_ResetChannel(CAPSENSE_ChannelState_t *state)
+{
+#if defined(CAPSENSE_FILTER_ENABLED)
+  state->filter.primed = false;
+#if (CAPSENSE_FILTER_OVERSAMPLE_SHIFT > 0)
+  state->filter.sum = 0;
+  state->filter.samples = 0;
+#endif
+#endif
+  state->baseline = 0;
+  state->value = 0;
+  state->maxValue = 0;
+  state->recip = 0;
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  {
+    uint8_t i;
+
+    for (i = 0; i < CAPSENSE_NUM_FREQUENCIES; i++) {
+      state->freq[i].level = 0;
+      state->freq[i].noise = 0;
+    }
+    CAPSENSE_UpdateFrequencyWeights(state);
+  }
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Tune the measurement window of every channel of a context.
+ *
+ * @details
+ *   For each channel the shortest TIMER0 window is selected for which a
+ *   touch, expected to lower the count by CAPSENSE_TUNE_TOUCH_RATIO / 256,
+ *   changes the count by at least CAPSENSE_TUNE_MIN_DELTA. The count grows
+ *   linearly with the window, so the window is scaled from a measurement
+ *   at the current window and refined with up to CAPSENSE_TUNE_ITERATIONS
+ *   measurements. Small electrodes end up with short windows and large
+ *   ones keep their resolution.
+ *
+ *   The electrodes must not be touched while tuning. The filters and
+ *   baselines of the tuned channels are reset. When channels are measured
+ *   in parallel on two ACMPs, each pair shares the longer of its windows.
+ *
+ * @param ctx
+ *   The context.
+ *
+ * @return
+ *   true if every channel met the minimum delta,
+ *   false if a channel needed a window longer than CAPSENSE_WINDOW_MAX, or
+ *   a scan, a batch or another tuning is running.
+ *****************************************************************************/
+bool CAPSENSE_CtxTuneWindows(CAPSENSE_Context_t *ctx)
+{
+  const uint32_t required = (CAPSENSE_TUNE_MIN_DELTA * 256
+                             + CAPSENSE_TUNE_TOUCH_RATIO - 1)
+                            / CAPSENSE_TUNE_TOUCH_RATIO;
+  bool converged = true;
+  uint8_t channel;
+  uint32_t window;
+  uint32_t count;
+  int i;
+
+  if (scanActive || rawMeasureActive || batchActive) {
+    return false;
+  }
+#if defined(CAPSENSE_LDMA_FRAMES)
+  if (ldmaActive) {
+    return false;
+  }
+#endif
+
+  CAPSENSE_EnableAcmps();
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    if (!CAPSENSE_ChannelInUse(ctx, channel)) {
+      continue;
+    }
+
+    window = ctx->state[channel].window;
+    count = CAPSENSE_MeasureRaw(ctx, channel, window);
+
+    for (i = 0; i < CAPSENSE_TUNE_ITERATIONS; i++) {
+      uint32_t next;
+
+      // TIMER0 counts top + 1 ticks per window
+      if (count == 0) {
+        next = CAPSENSE_WINDOW_MAX;
+      } else {
+        next = ((required * (window + 1) + count - 1) / count) - 1;
+      }
+      if (next < 1) {
+        next = 1;
+      } else if (next > CAPSENSE_WINDOW_MAX) {
+        next = CAPSENSE_WINDOW_MAX;
+      }
+      if (count < required && next <= window && window < CAPSENSE_WINDOW_MAX) {
+        // Always make progress when the count is too low
+        next = window + 1;
+      }
+      if (next == window) {
+        break;
+      }
+      window = next;
+      count = CAPSENSE_MeasureRaw(ctx, channel, window);
+    }
+
+    if (count < required) {
+      converged = false;
+    }
+    CAPSENSE_CtxSetWindow(ctx, channel, window);
+  }
+
+  CAPSENSE_DisableAcmps();
+  return converged;
+}
+
+/**************************************************************************//**
+ * @brief Get the measurement window of a channel
+ * @param ctx The context.
+ * @param channel The channel.
+ * @return The TIMER0 top value used when measuring the channel.
+ *****************************************************************************/
+uint32_t CAPSENSE_CtxGetWindow(CAPSENSE_Context_t *ctx, uint8_t channel)
+{
+  return ctx->state[channel].window;
+}
+
+/**************************************************************************//**
+ * @brief Set the measurement window of a channel
+ * @details The filters and the baseline of the channel are reset if the
+ *          window changes. Must not be called while the context is being
+ *          scanned.
+ * @param ctx The context.
+ * @param channel The channel.
+ * @param window The TIMER0 top value to use when measuring the channel.
+ *****************************************************************************/
+void CAPSENSE_CtxSetWindow(CAPSENSE_Context_t *ctx, uint8_t channel,
+                           uint32_t window)
+{
+  CAPSENSE_ChannelState_t *state = &ctx->state[channel];
+
+  if (window == state->window) {
+    return;
+  }
+  NVIC_DisableIRQ(TIMER0_IRQn);
+  state->window = window;
+  CAPSENSE_ResetChannel(state);
+  CAPSENSE_BuildScanTable(ctx);
+  NVIC_EnableIRQ(TIMER0_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief Get the channelValue of the last complete frame for a channel
+ * @param channel The channel of the default context.
+ * @return The channelValue.
+ *****************************************************************************/
+uint32_t CAPSENSE_getVal(uint8_t channel)
+{
+  return CAPSENSE_CtxGetVal(&defaultContext, channel);
+}
+
+/**************************************************************************//**
+ * @brief Get a consistent copy of the last complete frame
+ * @param frame Filled in with the frame of the default context.
+ *****************************************************************************/
+void CAPSENSE_GetFrame(CAPSENSE_Frame_t *frame)
+{
+  CAPSENSE_CtxGetFrame(&defaultContext, frame);
+}
+
+/**************************************************************************//**
+ * @brief Get the current normalized channelValue for a channel
+ * @param channel The channel of the default context.
+ * @return The channel value relative to the baseline, 256 at the baseline.
+ *****************************************************************************/
+uint32_t CAPSENSE_getNormalizedVal(uint8_t channel)
+{
+  return CAPSENSE_CtxGetNormalizedVal(&defaultContext, channel);
+}
+
+/**************************************************************************//**
+ * @brief Get the state of the Gecko Button
+ * @param channel The channel of the default context.
+ * @return true if the button is "pressed"
+ *         false otherwise.
+ *****************************************************************************/
+bool CAPSENSE_getPressed(uint8_t channel)
+{
+  return CAPSENSE_CtxGetPressed(&defaultContext, channel);
+}
+
+#if defined(CAPSENSE_EVENT_QUEUE_SIZE)
+/**************************************************************************//**
+ * @brief Get the oldest touch event of the default context
+ * @param event Filled in with the event.
+ * @return true if an event was returned,
+ *         false if the queue is empty.
+ *****************************************************************************/
+bool CAPSENSE_GetEvent(CAPSENSE_Event_t *event)
+{
+  return CAPSENSE_CtxGetEvent(&defaultContext, event);
+}
+
+/**************************************************************************//**
+ * @brief Get the number of events of the default context lost because the
+ *        event queue was full
+ * @return The number of events lost.
+ *****************************************************************************/
+uint32_t CAPSENSE_GetDroppedEvents(void)
+{
+  return CAPSENSE_CtxGetDroppedEvents(&defaultContext);
+}
+#endif
+
+/**************************************************************************//**
+ * @brief Process a batch of buffered frames of the default context
+ * @param batch The batch, with frames and counts filled in.
+ * @return true if the batch was processed,
+ *         false if the default context is being scanned.
+ *****************************************************************************/
+bool CAPSENSE_ProcessBatch(CAPSENSE_Batch_t *batch)
+{
+  return CAPSENSE_CtxProcessBatch(&defaultContext, batch);
+}
+
+/**************************************************************************//**
+ * @brief Get the position of the slider of the default context
+ * @return The position of the slider if it can be determined,
+ *         -1 otherwise.
+ *****************************************************************************/
+int32_t CAPSENSE_getSliderPosition(void)
+{
+  return CAPSENSE_CtxGetSliderPosition(&defaultContext);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start a scan of all the channels of the default context and return
+ *   immediately.
+ *
+ * @param callback
+ *   Function to call when the scan is complete, or NULL to only poll with
+ *   CAPSENSE_ScanComplete().
+ *
+ * @return
+ *   true if the scan was started,
+ *   false if a scan is already running.
+ *****************************************************************************/
+bool CAPSENSE_StartScan(CAPSENSE_ScanCallback_t callback)
+{
+  return CAPSENSE_CtxStartScan(&defaultContext, callback);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Start a wake on touch scan of the default context.
+ *
+ * @param callback
+ *   Function to call from interrupt context when the scan ends, with
+ *   true if a channel is probably touched.
+ *
+ * @return
+ *   true if the scan was started,
+ *   false if a scan is already running.
+ *****************************************************************************/
+bool CAPSENSE_StartWakeScan(CAPSENSE_WakeCallback_t callback)
+{
+  return CAPSENSE_CtxStartWakeScan(&defaultContext, callback);
+}
+
+/**************************************************************************//**
+ * @brief Check if the last scan started with CAPSENSE_StartScan() is done
+ * @return true if no scan is running.
+ *****************************************************************************/
+bool CAPSENSE_ScanComplete(void)
+{
+  return CAPSENSE_CtxScanComplete(&defaultContext);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   This function iterates through all the capsense channels and
+ *   initiates a reading. Uses EM1 while waiting for the result from
+ *   each sensor.
+ *
+ * @return
+ *   true if the channels were measured,
+ *   false if a scan is already running.
+ *****************************************************************************/
+bool CAPSENSE_Sense(void)
+{
+  return CAPSENSE_CtxSense(&defaultContext);
+}
+
+/**************************************************************************//**
+ * @brief Tune the measurement window of every channel of the default context
+ * @return true if every channel met the minimum delta,
+ *         false otherwise or if the driver is busy.
+ *****************************************************************************/
+bool CAPSENSE_TuneWindows(void)
+{
+  return CAPSENSE_CtxTuneWindows(&defaultContext);
+}
+
+/**************************************************************************//**
+ * @brief Get the measurement window of a channel
+ * @param channel The channel of the default context.
+ * @return The TIMER0 top value used when measuring the channel.
+ *****************************************************************************/
+uint32_t CAPSENSE_getWindow(uint8_t channel)
+{
+  return CAPSENSE_CtxGetWindow(&defaultContext, channel);
+}
+
+/**************************************************************************//**
+ * @brief Set the measurement window of a channel
+ * @param channel The channel of the default context.
+ * @param window The TIMER0 top value to use when measuring the channel.
+ *****************************************************************************/
+void CAPSENSE_setWindow(uint8_t channel, uint32_t window)
+{
+  CAPSENSE_CtxSetWindow(&defaultContext, channel, window);
+}
+
+#if defined(CAPSENSE_CALIBRATION)
+#if !defined(CAPSENSE_CALIBRATION_STORAGE)
+/**************************************************************************//**
+ * @brief
+ *   Read the stored calibration record.
+ *
+ * @details
+ *   The default implementation reads the page at CAPSENSE_CALIBRATION_ADDR.
+ *   Applications keeping the record elsewhere, for example in NVM3 or in a
+ *   file on a host, define CAPSENSE_CALIBRATION_STORAGE and provide their
+ *   own implementation.
+ *
+ * @param data
+ *   Filled in with the record.
+ *
+ * @param size
+ *   The number of bytes to read.
+ *
+ * @return
+ *   true if the data was read.
+ *****************************************************************************/
+SL_WEAK bool CAPSENSE_CalibrationRead(void *data, size_t size)
+{
+  memcpy(data, (const void *) CAPSENSE_CALIBRATION_ADDR, size);
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Write the calibration record.
+ *
+ * @details
+ *   The default implementation erases and programs the page at
+ *   CAPSENSE_CALIBRATION_ADDR. The page is only erased when the record
+ *   changes, to save flash endurance.
+ *
+ * @param data
+ *   The record, word aligned.
+ *
+ * @param size
+ *   The number of bytes to write, a multiple of 4.
+ *
+ * @return
+ *   true if the data was written.
+ *****************************************************************************/
+SL_WEAK bool CAPSENSE_CalibrationWrite(const void *data, size_t size)
+{
+  uint32_t *page = (uint32_t *) CAPSENSE_CALIBRATION_ADDR;
+  bool ok;
+
+  if (memcmp(page, data, size) == 0) {
+    return true;
+  }
+
+  MSC_Init();
+  ok = (MSC_ErasePage(page) == mscReturnOk)
+       && (MSC_WriteWord(page, data, size) == mscReturnOk);
+  MSC_Deinit();
+  return ok;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *   Calculate the CRC-16-CCITT of a buffer.
+ *****************************************************************************/
+static uint16_t CAPSENSE_Crc16(const uint8_t *data, size_t size)
+{
+  uint16_t crc = 0xFFFF;
+  int bit;
+
+  while (size--) {
+    crc ^= (uint16_t) (*data++ << 8);
+    for (bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021)
+                           : (uint16_t) (crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Calculate the CRC of a calibration record.
+ *
+ * @details
+ *   The CRC covers everything after the crc field up to the last channel
+ *   in use.
+ *****************************************************************************/
+static uint16_t CAPSENSE_CalibrationCrc(const Calibration_TypeDef *record)
+{
+  const uint8_t *start = &record->version;
+  const uint8_t *end = (const uint8_t *) &record->channels[record->numChannels];
+
+  return CAPSENSE_Crc16(start, (size_t) (end - start));
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Save the baselines and windows of a context as the calibration record.
+ *
+ * @details
+ *   Should be called when the electrodes are not touched and the baselines
+ *   have settled, for example after CAPSENSE_CtxTuneWindows() and a few
+ *   scans. Must not be called while the context is being scanned.
+ *   The record is restored by CAPSENSE_CtxRestoreCalibration().
+ *
+ * @param ctx
+ *   The context.
+ *
+ * @return
+ *   true if the record was written.
+ *****************************************************************************/
+bool CAPSENSE_CtxSaveCalibration(CAPSENSE_Context_t *ctx)
+{
+  Calibration_TypeDef record;
+  CalibrationChannel_TypeDef *entry;
+  uint8_t channel;
+
+  memset(&record, 0, sizeof(record));
+  record.magic = CALIBRATION_MAGIC;
+  record.version = CALIBRATION_VERSION;
+  record.numChannels = ctx->numChannels;
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    entry = &record.channels[channel];
+    entry->baseline = ctx->state[channel].baseline;
+    entry->window = (uint16_t) ctx->state[channel].window;
+    entry->input = (uint8_t) CAPSENSE_ChannelInput(ctx, channel);
+    entry->acmp = CAPSENSE_ChannelAcmp(ctx, channel);
+  }
+  record.crc = CAPSENSE_CalibrationCrc(&record);
+
+  return CAPSENSE_CalibrationWrite(&record, sizeof(record));
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Load the calibration record into a context while the TIMER0 interrupt
+ *   can not update it.
+ *****************************************************************************/
+static bool CAPSENSE_LoadCalibration(CAPSENSE_Context_t *ctx)
+{
+  Calibration_TypeDef record;
+  const CalibrationChannel_TypeDef *entry;
+  CAPSENSE_ChannelState_t *state;
+  uint8_t channel;
+
+  if (!CAPSENSE_CalibrationRead(&record, sizeof(record))) {
+    return false;
+  }
+  if ((record.magic != CALIBRATION_MAGIC)
+      || (record.version != CALIBRATION_VERSION)
+      || (record.numChannels != ctx->numChannels)
+      || (record.crc != CAPSENSE_CalibrationCrc(&record))) {
+    return false;
+  }
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    entry = &record.channels[channel];
+    if ((entry->input != (uint8_t) CAPSENSE_ChannelInput(ctx, channel))
+        || (entry->acmp != CAPSENSE_ChannelAcmp(ctx, channel))
+        || (entry->window == 0)) {
+      return false;
+    }
+  }
+
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    entry = &record.channels[channel];
+    state = &ctx->state[channel];
+    CAPSENSE_ResetChannel(state);
+    state->window = entry->window;
+    state->baseline = entry->baseline;
+    state->maxValue = entry->baseline >> 8;
+    state->recip = CAPSENSE_Reciprocal(state->maxValue);
+    // Untouched until the first sample arrives
+    state->value = state->maxValue;
+  }
+  CAPSENSE_BuildScanTable(ctx);
+  CAPSENSE_PublishFrame(ctx);
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Restore the baselines and windows of a context from the calibration
+ *   record.
+ *
+ * @details
+ *   The record is only used if its CRC and version are valid and it was
+ *   saved for the same channels. The restored baselines are published as
+ *   the first frame, so touch detection and normalized values are valid
+ *   before the first scan completes. Must not be called while the context
+ *   is being scanned.
  *
- * @{
- ******************************************************************************/
+ * @param ctx
+ *   The context.
+ *
+ * @return
+ *   true if the calibration was restored,
+ *   false if there is no valid record for the context.
+ *****************************************************************************/
+bool CAPSENSE_CtxRestoreCalibration(CAPSENSE_Context_t *ctx)
+{
+  bool restored;
 
-/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+  NVIC_DisableIRQ(TIMER0_IRQn);
+  restored = CAPSENSE_LoadCalibration(ctx);
+  NVIC_EnableIRQ(TIMER0_IRQn);
+  return restored;
+}
 
-/** The current channel we are sensing. */
-static volatile uint8_t currentChannel;
-/** Flag for measurement completion. */
-static volatile bool measurementComplete;
+/**************************************************************************//**
+ * @brief Save the calibration of the default context
+ * @return true if the record was written.
+ *****************************************************************************/
+bool CAPSENSE_SaveCalibration(void)
+{
+  return CAPSENSE_CtxSaveCalibration(&defaultContext);
+}
+#endif
 
-#if defined(CAPSENSE_CH_IN_USE)
+#if defined(CAPSENSE_STATS)
 /**************************************************************************//**
  * @brief
- *   A bit vector which represents the channels to iterate through
+ *   Get a snapshot of the noise statistics of a channel.
  *
- * @note
- *   This API is deprecated and new application should define
- *   CAPSENSE_CHANNELS instead of CAPSENSE_CH_IN_USE.
+ * @details
+ *   The interrupt handlers never wait for the reader. The copy is retried
+ *   when they updated the statistics while it was taken.
  *
- * @param ACMP_CHANNELS
- *   Vector of channels.
+ * @param ctx
+ *   The context.
+ *
+ * @param channel
+ *   The channel index.
+ *
+ * @param stats
+ *   Filled in with the statistics of the raw samples since the last reset.
  *****************************************************************************/
-static const bool channelsInUse[ACMP_CHANNELS] = CAPSENSE_CH_IN_USE;
-#elif defined(CAPSENSE_CHANNELS)
+void CAPSENSE_CtxGetChannelStats(CAPSENSE_Context_t *ctx, uint8_t channel,
+                                 CAPSENSE_ChannelStats_t *stats)
+{
+  CAPSENSE_StatsAccum_t acc;
+  uint64_t mean;
+  uint64_t remainder;
+  uint64_t squares;
+  uint32_t seq;
+  uint8_t bin;
+
+  do {
+    seq = statsSeq;
+    __DMB();
+    acc = ctx->state[channel].stats;
+    __DMB();
+  } while ((seq & 1) || (seq != statsSeq));
+
+  stats->samples = acc.samples;
+  stats->min = acc.min;
+  stats->max = acc.max;
+  stats->mean = 0;
+  stats->variance = 0;
+  if (acc.samples != 0) {
+    mean = acc.sum / acc.samples;
+    remainder = acc.sum - mean * acc.samples;
+    stats->mean = (uint32_t) mean;
+    // The squared distances from the truncated mean, less the part due to
+    // the truncation, so the variance is not off by up to twice the mean
+    squares = acc.sumSquares + acc.samples * mean * mean - 2 * mean * acc.sum;
+    stats->variance = (uint32_t) ((squares - remainder * remainder / acc.samples)
+                                  / acc.samples);
+  }
+  for (bin = 0; bin < CAPSENSE_STATS_BINS; bin++) {
+    stats->histogram[bin] = acc.histogram[bin];
+  }
+}
+
 /**************************************************************************//**
  * @brief
- *   An array of channels that the capsense driver should iterate through.
+ *   Clear the noise statistics of a context and the timing statistics.
+ *****************************************************************************/
+void CAPSENSE_CtxResetStats(CAPSENSE_Context_t *ctx)
+{
+  const CAPSENSE_StatsAccum_t reset = { 0 };
+  const CAPSENSE_Stats_t resetStats = { 0 };
+  uint8_t channel;
+
+  NVIC_DisableIRQ(TIMER0_IRQn);
+  for (channel = 0; channel < ctx->numChannels; channel++) {
+    ctx->state[channel].stats = reset;
+  }
+  timingStats = resetStats;
+  NVIC_EnableIRQ(TIMER0_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Get a snapshot of the timing statistics.
  *
- * @param CAPSENSE_CHANNELS
- *   Initializer list that contains all the channels that the application
- *   would like to use for capsense.
+ * @details
+ *   Latencies are measured from the expected end of the measurement
+ *   window, so they include the time the TIMER0 interrupt was masked or
+ *   preempted. The wait time counts the cycles spent in CAPSENSE_Sense()
+ *   and CAPSENSE_TuneWindows() waiting for measurements.
  *
- * @param ACMP_CHANNELS
- *   The number of channels in the array
+ * @param snapshot
+ *   Filled in with the statistics since the last reset.
  *****************************************************************************/
-static const ACMP_Channel_TypeDef channelList[ACMP_CHANNELS] = CAPSENSE_CHANNELS;
-#endif
+void CAPSENSE_GetStats(CAPSENSE_Stats_t *snapshot)
+{
+  uint32_t seq;
+
+  do {
+    seq = statsSeq;
+    __DMB();
+    *snapshot = timingStats;
+    __DMB();
+  } while ((seq & 1) || (seq != statsSeq));
+}
 
 /**************************************************************************//**
- * @brief The NUM_SLIDER_CHANNELS specifies how many of the ACMP_CHANNELS
- *        are used for a touch slider
+ * @brief Get a snapshot of the noise statistics of a default context channel.
+ * @param channel The channel index.
+ * @param stats Filled in with the statistics.
  *****************************************************************************/
-#if !defined(NUM_SLIDER_CHANNELS)
-#define NUM_SLIDER_CHANNELS 4
+void CAPSENSE_GetChannelStats(uint8_t channel, CAPSENSE_ChannelStats_t *stats)
+{
+  CAPSENSE_CtxGetChannelStats(&defaultContext, channel, stats);
+}
 #endif
 
+#if defined(CAPSENSE_TRACE_SIZE)
 /**************************************************************************//**
- * @brief This vector stores the latest read values from the ACMP
- * @param ACMP_CHANNELS Vector of channels.
+ * @brief
+ *   Start recording the frames of a context in the trace.
+ *
+ * @details
+ *   The trace is a stream of records, one per frame, see
+ *   CAPSENSE_TraceFrame() for the format. The first record is a key frame.
+ *   Only one context is traced at a time, starting a trace of another
+ *   context stops the previous one.
+ *
+ * @param ctx
+ *   The context to trace.
  *****************************************************************************/
-static volatile uint32_t channelValues[ACMP_CHANNELS] = { 0 };
+void CAPSENSE_CtxTraceStart(CAPSENSE_Context_t *ctx)
+{
+  // The interrupt handlers do not touch the trace state while stopped
+  traceCtx = NULL;
+  __DMB();
+  traceKeyCountdown = 0;
+  __DMB();
+  traceCtx = ctx;
+}
 
 /**************************************************************************//**
- * @brief  This stores the maximum values seen by a channel
- * @param ACMP_CHANNELS Vector of channels.
+ * @brief
+ *   Stop recording frames. Records already in the ring can still be read.
  *****************************************************************************/
-static volatile uint32_t channelMaxValues[ACMP_CHANNELS] = { 0 };
-
-/** @endcond */
+void CAPSENSE_TraceStop(void)
+{
+  traceCtx = NULL;
+}
 
 /**************************************************************************//**
  * @brief
- *   TIMER0 interrupt handler.
+ *   Copy trace bytes out of the ring buffer.
  *
  * @details
- *   When TIMER0 expires the number of pulses on TIMER1 is inserted into
- *   channelValues. If this values is bigger than what is recorded in
- *   channelMaxValues, channelMaxValues is updated.
- *   Finally, the next ACMP channel is selected.
+ *   Only whole records are ever visible, so the bytes can be sent as they
+ *   are to a debug UART or RTT channel. Must only be called from one
+ *   thread of execution.
+ *
+ * @param buffer
+ *   Filled in with the trace bytes.
+ *
+ * @param size
+ *   The size of buffer.
+ *
+ * @return
+ *   The number of bytes copied, 0 if the ring is empty.
  *****************************************************************************/
-void TIMER0_IRQHandler(void)
+size_t CAPSENSE_TraceRead(uint8_t *buffer, size_t size)
 {
-  uint32_t count;
+  uint32_t tail = traceTail;
+  uint32_t available = traceHead - tail;
+  size_t i;
+
+  // Read the bytes only after the head which published them
+  __DMB();
+  if (size > available) {
+    size = available;
+  }
+  for (i = 0; i < size; i++) {
+    buffer[i] = traceBuffer[(tail + i) & (CAPSENSE_TRACE_SIZE - 1)];
+  }
 
-  // Stop timers
-  TIMER_Enable(TIMER0, false);
-  TIMER_Enable(TIMER1, false);
+  // Free the bytes only after they have been read
+  __DMB();
+  traceTail = tail + size;
+  return size;
+}
 
-  // Clear interrupt flag
-  TIMER_IntClear(TIMER0, TIMER_IF_OF);
+/**************************************************************************//**
+ * @brief Get the number of frames lost to a full trace ring
+ * @return The number of dropped frames since CAPSENSE_Init().
+ *****************************************************************************/
+uint32_t CAPSENSE_GetDroppedTraceFrames(void)
+{
+  return traceDropped;
+}
 
-  // Save TIMER1 count
-  count = TIMER_CounterGet(TIMER1);
+/**************************************************************************//**
+ * @brief Start recording the frames of the default context in the trace.
+ *****************************************************************************/
+void CAPSENSE_TraceStart(void)
+{
+  CAPSENSE_CtxTraceStart(&defaultContext);
+}
+#endif
 
-  // Store value in channelValues
-  channelValues[currentChannel] = count;
+/**************************************************************************//**
+ * @brief Get the time the ACMPs, TIMERs and PRS channels spent measuring
+ * @details
+ *   Counts the windows of interrupt chained, blocking, raw and wake on touch
+ *   scans, including the ACMP warm-up windows. Windows sequenced by the
+ *   LDMA are not counted. Every ACMP, its pulse counter and its PRS channel
+ *   run for the whole of each window. Divide by CAPSENSE_GetMeasureTickHz()
+ *   to get seconds.
+ * @param ticks Set to the TIMER0 ticks spent measuring by each kind of
+ *              peripheral since CAPSENSE_Init(), wrapping.
+ *****************************************************************************/
+void CAPSENSE_GetMeasureTicks(CAPSENSE_MeasureTicks_t *ticks)
+{
+  uint32_t windows = measureTicks;
 
-  // Update channelMaxValues
-  if (count > channelMaxValues[currentChannel])
-    channelMaxValues[currentChannel] = count;
+  ticks->acmp = windows * CAPSENSE_ACMPS;
+  ticks->timer0 = windows;
+  ticks->timer1 = windows * CAPSENSE_ACMPS;
+  ticks->prs = windows * CAPSENSE_ACMPS;
+}
 
-  measurementComplete = true;
+/**************************************************************************//**
+ * @brief Get the number of interrupts taken by the driver
+ * @details
+ *   Counts the TIMER0, pulse counter and LDMA interrupts, each of which
+ *   wakes the core from EM1 or EM2 while a scan runs.
+ * @return The interrupts since CAPSENSE_Init(), wrapping.
+ *****************************************************************************/
+uint32_t CAPSENSE_GetInterruptCount(void)
+{
+  return interruptCount;
 }
 
 /**************************************************************************//**
- * @brief Get the current channelValue for a channel
- * @param channel The channel.
- * @return The channelValue.
+ * @brief Get the rate of the measuring window ticks
+ * @return TIMER0 ticks per second.
  *****************************************************************************/
-uint32_t CAPSENSE_getVal(uint8_t channel)
+uint32_t CAPSENSE_GetMeasureTickHz(void)
 {
-  return channelValues[channel];
+  return CMU_ClockFreqGet(cmuClock_TIMER0) / TIMER0_PRESCALE;
 }
 
+#if defined(CAPSENSE_LDMA_FRAMES)
 /**************************************************************************//**
- * @brief Get the current normalized channelValue for a channel
- * @param channel The channel.
- * @return The channel value in range (0-256).
+ * @brief
+ *   Set up an LDMA descriptor for a single word transfer.
+ *
+ * @param structReq
+ *   Run the transfer as soon as the descriptor is loaded instead of waiting
+ *   for the next TIMER0 request.
+ *
+ * @param doneIfs
+ *   Set the channel interrupt flag when the transfer is done.
  *****************************************************************************/
-uint32_t CAPSENSE_getNormalizedVal(uint8_t channel)
+static void CAPSENSE_LdmaDescInit(LDMA_Descriptor_t *desc,
+                                  volatile const void *src,
+                                  volatile void *dst,
+                                  bool structReq,
+                                  bool doneIfs,
+                                  const LDMA_Descriptor_t *link)
 {
-  uint32_t max = channelMaxValues[channel];
-  return (channelValues[channel] << 8) / max;
+  desc->xfer.structType  = ldmaCtrlStructTypeXfer;
+  desc->xfer.structReq   = structReq;
+  desc->xfer.xferCnt     = 0;
+  desc->xfer.byteSwap    = 0;
+  desc->xfer.blockSize   = ldmaCtrlBlockSizeUnit1;
+  desc->xfer.doneIfs     = doneIfs;
+  desc->xfer.reqMode     = ldmaCtrlReqModeBlock;
+  desc->xfer.decLoopCnt  = 0;
+  desc->xfer.ignoreSrec  = 0;
+  desc->xfer.srcInc      = ldmaCtrlSrcIncNone;
+  desc->xfer.size        = ldmaCtrlSizeWord;
+  desc->xfer.dstInc      = ldmaCtrlDstIncNone;
+  desc->xfer.srcAddrMode = ldmaCtrlSrcAddrModeAbs;
+  desc->xfer.dstAddrMode = ldmaCtrlDstAddrModeAbs;
+  desc->xfer.srcAddr     = (uint32_t) src;
+  desc->xfer.dstAddr     = (uint32_t) dst;
+  desc->xfer.linkMode    = ldmaLinkModeAbs;
+  desc->xfer.link        = 1;
+  desc->xfer.linkAddr    = (int32_t) ((uint32_t) link >> 2);
 }
 
 /**************************************************************************//**
- * @brief Get the state of the Gecko Button
- * @param channel The channel.
- * @return true if the button is "pressed"
- *         false otherwise.
+ * @brief
+ *   Load an LDMA channel with a descriptor triggered by TIMER0 overflow.
  *****************************************************************************/
-bool CAPSENSE_getPressed(uint8_t channel)
+static void CAPSENSE_LdmaChannelStart(uint32_t ch, const LDMA_Descriptor_t *desc)
 {
-  uint32_t treshold;
-  /* Treshold is set to 12.5% below the maximum value */
-  /* This calculation is performed in two steps because channelMaxValues is
-   * volatile. */
-  treshold  = channelMaxValues[channel];
-  treshold -= channelMaxValues[channel] >> 2;
+  LDMAXBAR->CH[ch].REQSEL = LDMAXBAR_CH_REQSEL_SOURCESEL_TIMER0
+                            | LDMAXBAR_CH_REQSEL_SIGSEL_TIMER0UFOF;
+  LDMA->CH[ch].CFG = 0;
+  LDMA->CH[ch].LOOP = 0;
+  LDMA->CH[ch].LINK = (uint32_t) desc & _LDMA_CH_LINK_LINKADDR_MASK;
+  LDMA->LINKLOAD = 1UL << ch;
+}
 
-  if (channelValues[channel] < treshold) {
-    return true;
+/**************************************************************************//**
+ * @brief
+ *   LDMA interrupt handler.
+ *
+ * @details
+ *   Called once every CAPSENSE_LDMA_FRAMES frames when one half of the
+ *   sample ring buffer is full. The raw TIMER1 counts keep running between
+ *   samples, so the count of a window is the difference to the previous
+ *   sample.
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  CAPSENSE_Context_t *ctx = activeCtx;
+  uint32_t i;
+  uint32_t raw;
+  volatile uint32_t *samples;
+  uint32_t pending = LDMA->IF & (1UL << CAPSENSE_LDMA_CH);
+
+  interruptCount++;
+  LDMA->IF_CLR = pending;
+  if (!pending || !ldmaActive) {
+    return;
+  }
+
+  samples = ldmaSamples[ldmaHalf];
+  ldmaHalf ^= 1;
+
+  for (i = 0; i < ldmaBatchSamples; i++) {
+    raw = samples[i];
+    // TIMER1 is a 16 bit counter
+    CAPSENSE_StoreSample(ctx, ldmaChannel, (raw - ldmaLastCount) & 0xFFFF);
+    ldmaLastCount = raw;
+    if (++ldmaChannel >= ctx->numChannels) {
+      ldmaChannel = 0;
+      CAPSENSE_FrameComplete(ctx);
+    }
+  }
+
+  if (ldmaCallback != NULL) {
+    ldmaCallback();
   }
-  return false;
 }
 
 /**************************************************************************//**
- * @brief Get the position of the slider
- * @return The position of the slider if it can be determined,
- *         -1 otherwise.
+ * @brief
+ *   Start continuous scanning of a context with LDMA sample capture.
+ *
+ * @details
+ *   TIMER0 runs freely and each overflow requests a chain of three linked
+ *   LDMA transfers on one channel: the first copies the TIMER1 count into the
+ *   sample ring buffer, the second writes the ACMP input of the next channel
+ *   and the third buffers the window of the channel after that in TIMER0
+ *   TOPB. The CPU is only interrupted once every CAPSENSE_LDMA_FRAMES frames
+ *   to process a batch of samples.
+ *
+ *   The chain takes three descriptors for every sample of the ring buffer,
+ *   96 * CAPSENSE_LDMA_FRAMES * CAPSENSE_MAX_CHANNELS bytes of RAM.
+ *
+ *   All channels of the context are measured on ACMP0 with a list of
+ *   ACMP inputs.
+ *
+ * @param ctx
+ *   The context.
+ *
+ * @param callback
+ *   Function to call after each batch has been processed, or NULL.
+ *
+ * @return
+ *   true if capture was started,
+ *   false if a scan is already running or the context can not be captured.
  *****************************************************************************/
-int32_t CAPSENSE_getSliderPosition(void)
+bool CAPSENSE_CtxStartDmaScan(CAPSENSE_Context_t *ctx,
+                              CAPSENSE_ScanCallback_t callback)
 {
-  int      i;
-  int      minPos = -1;
-  uint32_t minVal = 224; /* 0.875 * 256 */
-  /* Values used for interpolation. There is two more which represents the edges.
-   * This makes the interpolation code a bit cleaner as we do not have to make special
-   * cases for handling them */
-  uint32_t interpol[(NUM_SLIDER_CHANNELS + 2)];
-  for (i = 0; i < (NUM_SLIDER_CHANNELS + 2); i++) {
-    interpol[i] = 255;
+  uint32_t n = ctx->numChannels;
+  uint32_t i;
+  uint32_t k;
+  uint32_t base;
+
+  if (scanActive || rawMeasureActive || ldmaActive || batchActive) {
+    return false;
+  }
+  if ((n == 0) || (ctx->channels == NULL) || (ctx->inUse != NULL)) {
+    return false;
   }
 
-  /* The calculated slider position. */
-  int position;
+  ACMP_Enable(ACMP0);
+  CAPSENSE_ApplyBusAlloc(ctx);
+  ACMP_CapsenseChannelSet(ACMP0, ctx->channels[0]);
+
+  // The input of channel i is selected when the sample of channel i-1 is done
+  base = ACMP0->INPUTCTRL & ~_ACMP_INPUTCTRL_POSSEL_MASK;
+  for (i = 0; i < n; i++) {
+    ldmaInputCtrl[i] = base
+                       | ((uint32_t) ctx->channels[(i + 1) % n]
+                          << _ACMP_INPUTCTRL_POSSEL_SHIFT);
+  }
 
-  /* Iterate through the slider bars and calculate the current value divided by
-   * the maximum value multiplied by 256.
-   * Note that there is an offset of 1 between channelValues and interpol.
-   * This is done to make interpolation easier.
-   */
-  for (i = 1; i < (NUM_SLIDER_CHANNELS + 1); i++) {
-    /* interpol[i] will be in the range 0-256 depending on channelMax */
-    interpol[i]  = channelValues[i - 1] << 8;
-    interpol[i] /= channelMaxValues[i - 1];
-    /* Find the minimum value and position */
-    if (interpol[i] < minVal) {
-      minVal = interpol[i];
-      minPos = i;
-    }
+  /* TOPB is loaded into TOP when a window starts, so the window of
+   * channel i is buffered when the sample of channel i-2 is done */
+  for (i = 0; i < n; i++) {
+    ldmaWindows[i] = ctx->state[(i + 2) % n].window;
   }
-  /* Check if the slider has not been touched */
-  if (minPos == -1) {
-    return -1;
+  ldmaBatchSamples = CAPSENSE_LDMA_FRAMES * n;
+
+  /* Only the count waits for the TIMER0 request, the input and window
+   * transfers follow right after it. The last sample of each half sets the
+   * interrupt flag and the chain wraps around to the first half. */
+  for (k = 0; k < 2 * ldmaBatchSamples; k++) {
+    i = k % n;
+    CAPSENSE_LdmaDescInit(&ldmaDesc[k][0], &TIMER1->CNT,
+                          &ldmaSamples[k / ldmaBatchSamples][k % ldmaBatchSamples],
+                          false, (k % ldmaBatchSamples) == ldmaBatchSamples - 1,
+                          &ldmaDesc[k][1]);
+    CAPSENSE_LdmaDescInit(&ldmaDesc[k][1], &ldmaInputCtrl[i], &ACMP0->INPUTCTRL,
+                          true, false, &ldmaDesc[k][2]);
+    CAPSENSE_LdmaDescInit(&ldmaDesc[k][2], &ldmaWindows[i], &TIMER0->TOPB,
+                          true, false,
+                          &ldmaDesc[(k + 1) % (2 * ldmaBatchSamples)][0]);
   }
 
-  /* Start position. Shift by 4 to get additional resolution. */
-  /* Because of the interpol trick earlier we have to substract one to offset that effect */
-  position = (minPos - 1) << 4;
+  activeCtx = ctx;
+  ldmaCallback = callback;
+  ldmaHalf = 0;
+  ldmaChannel = 0;
+  ldmaLastCount = 0;
+  ldmaActive = true;
 
-  /* Interpolate with pad to the left */
-  position -= ((256 - interpol[minPos - 1]) << 3)
-              / (256 - interpol[minPos]);
+  LDMA->IF_CLR = 1UL << CAPSENSE_LDMA_CH;
+  LDMA->IEN |= 1UL << CAPSENSE_LDMA_CH;
+  CAPSENSE_LdmaChannelStart(CAPSENSE_LDMA_CH, &ldmaDesc[0][0]);
 
-  /* Interpolate with pad to the right */
-  position += ((256 - interpol[minPos + 1]) << 3)
-              / (256 - interpol[minPos]);
+  // TIMER0 overflows are handled by the LDMA instead of the CPU
+  TIMER_IntDisable(TIMER0, TIMER_IEN_OF);
 
-  return position;
+  TIMER_TopSet(TIMER0, ctx->state[0].window);
+  TIMER_TopBufSet(TIMER0, ctx->state[1 % n].window);
+
+  // Reset and start timers
+  TIMER_CounterSet(TIMER0, 0);
+  TIMER_CounterSet(TIMER1, 0);
+  TIMER_Enable(TIMER0, true);
+  TIMER_Enable(TIMER1, true);
+
+  return true;
 }
 
 /**************************************************************************//**
  * @brief
- *   Start a capsense measurement of a specific channel and wait for
- *   it to complete.
+ *   Start continuous scanning of the default context with LDMA sample
+ *   capture.
+ *
+ * @param callback
+ *   Function to call after each batch has been processed, or NULL.
+ *
+ * @return
+ *   true if capture was started,
+ *   false if a scan is already running.
  *****************************************************************************/
-static void CAPSENSE_Measure(ACMP_Channel_TypeDef channel)
+bool CAPSENSE_StartDmaScan(CAPSENSE_ScanCallback_t callback)
 {
-  // Set up the specified channel
-  ACMP_CapsenseChannelSet(ACMP0, channel);
-
-  // Reset timers
-  TIMER_CounterSet(TIMER0, 0);
-  TIMER_CounterSet(TIMER1, 0);
-
-  measurementComplete = false;
+  return CAPSENSE_CtxStartDmaScan(&defaultContext, callback);
+}
 
-  TIMER_IntClear(TIMER0, TIMER_IEN_OF);
+/**************************************************************************//**
+ * @brief
+ *   Stop scanning with LDMA sample capture.
+ *
+ * @details
+ *   Samples of a batch which is not complete are discarded. The ACMPs are
+ *   disabled until the next scan.
+ *****************************************************************************/
+void CAPSENSE_StopDmaScan(void)
+{
+  if (!ldmaActive) {
+    return;
+  }
 
-  // Start timers
-  TIMER_Enable(TIMER0, true);
-  TIMER_Enable(TIMER1, true);
+  // Stop timers
+  TIMER_Enable(TIMER0, false);
+  TIMER_Enable(TIMER1, false);
+  CAPSENSE_DisableAcmps();
 
-  // Wait for measurement to complete
-  while ( measurementComplete == false );
-    {
-	  //EMU_EnterEM1();
-    }
+  LDMA->CHDIS = 1UL << CAPSENSE_LDMA_CH;
+  LDMA->IEN &= ~(1UL << CAPSENSE_LDMA_CH);
+  ldmaActive = false;
 
+  TIMER_IntClear(TIMER0, TIMER_IF_OF);
+  TIMER_IntEnable(TIMER0, TIMER_IEN_OF);
 }
+#endif
+
 
 /**************************************************************************//**
  * @brief
- *   This function iterates through all the capsense channels and
- *   initiates a reading. Uses EM1 while waiting for the result from
- *   each sensor.
+ *   Set up a timer to count the pulses of an ACMP.
+ *
+ * @param timer
+ *   The counter timer.
+ *
+ * @param prsCh
+ *   The synchronous PRS channel carrying the ACMP output.
  *****************************************************************************/
-void CAPSENSE_Sense(void)
+static void CAPSENSE_CounterInit(TIMER_TypeDef *timer, unsigned int prsCh)
 {
-  // Use the default STK capacative sensing setup and enable it
-  ACMP_Enable(ACMP0);
+	// Initialize the timer but do not run yet
+	TIMER_Init_TypeDef counter_init = TIMER_INIT_DEFAULT;
+	counter_init.prescale = timerPrescale1024;
+	counter_init.clkSel = timerClkSelCC1;
+	counter_init.enable = false;
+	TIMER_Init(timer, &counter_init);
 
-#if defined(CAPSENSE_CHANNELS)
-  /* Iterate through only the channels in the channelList */
-  for (currentChannel = 0; currentChannel < ACMP_CHANNELS; currentChannel++)
-    CAPSENSE_Measure(channelList[currentChannel]);
-#else
-  /* Iterate through all channels and check which channel is in use */
-  for (currentChannel = 0; currentChannel < ACMP_CHANNELS; currentChannel++) {
-    /* If this channel is not in use, skip to the next one */
-    if (!channelsInUse[currentChannel]) {
-      continue;
-    }
+	// Set the top value to 0xFFFF
+	TIMER_TopSet(timer, 0xFFFF);
 
-    CAPSENSE_Measure((ACMP_Channel_TypeDef) currentChannel);
-  }
-#endif
+	// Set up CC1 to capture on the PRS channel input
+	TIMER_InitCC_TypeDef cc1_init = TIMER_INITCC_DEFAULT;
+	cc1_init.edge         = timerEdgeBoth;
+	cc1_init.mode         = timerCCModeCapture;
+	cc1_init.eventCtrl    = timerEventRising;
+	cc1_init.prsInput     = true;
+	cc1_init.prsInputType = timerPrsInputSync;
+	cc1_init.prsSel       = prsCh;
+	TIMER_InitCC(timer, 1, &cc1_init);
 
-  /* Disable ACMP while not sensing to reduce power consumption */
-//  ACMP_Disable(ACMP0);
+	// Set up CC0 to compare the count with the touch threshold
+	TIMER_InitCC_TypeDef cc0_init = TIMER_INITCC_DEFAULT;
+	cc0_init.mode = timerCCModeCompare;
+	TIMER_InitCC(timer, 0, &cc0_init);
 }
 
 /**************************************************************************//**
@@ -313,14 +3756,17 @@ void CAPSENSE_Sense(void)
  *
  * @details
  *   ACMP is set up in capsense (oscillator mode).
- *   TIMER1 counts the number of pulses generated by ACMP0.
+ *   TIMER1 counts the number of pulses generated by ACMP0, and TIMER2 the
+ *   pulses of ACMP1 when CAPSENSE_CHANNEL_ACMP is defined.
  *   When TIMER0 expires an interruptis requested.
- *   The number of pulses counted by TIMER1 is stored in channelValues
+ *   The number of pulses counted by TIMER1 is stored in the channel state.
+ *   The default context is set up from the channels in capsenseconfig.h.
  *****************************************************************************/
 void CAPSENSE_Init(void)
 {
 	// Use the default STK capacative sensing setup
 	ACMP_CapsenseInit_TypeDef capsenseInit = ACMP_CAPSENSE_INIT_DEFAULT;
+	int i;
 
 
 	/* Enable GPIO, TIMER0, TIMER1, ACMP_CAPSENSE and PRS clock */
@@ -329,6 +3775,10 @@ void CAPSENSE_Init(void)
 	CMU_ClockEnable(cmuClock_ACMP0, true);
 	CMU_ClockEnable(cmuClock_TIMER0, true);
 	CMU_ClockEnable(cmuClock_TIMER1, true);
+#if (CAPSENSE_ACMPS > 1)
+	CMU_ClockEnable(cmuClock_ACMP1, true);
+	CMU_ClockEnable(cmuClock_TIMER2, true);
+#endif
 
 	CMU_ClockEnable(cmuClock_PRS, true);
 
@@ -341,41 +3791,51 @@ void CAPSENSE_Init(void)
 	timer0_init.enable = false;
 	TIMER_Init(TIMER0, &timer0_init);
 
-	// Set TIMER0 top value to 10 and in
-	TIMER_TopSet(TIMER0, 10);
+	// Set TIMER0 top value to the default window, each channel sets its own
+	TIMER_TopSet(TIMER0, CAPSENSE_WINDOW_DEFAULT);
+
+	// Set up the default context
+#if defined(CAPSENSE_CH_IN_USE)
+	CAPSENSE_CtxInit(&defaultContext, NULL, NULL, defaultState, ACMP_CHANNELS);
+	CAPSENSE_CtxSetChannelMask(&defaultContext, channelsInUse);
+#elif defined(CAPSENSE_CHANNEL_ACMP)
+	CAPSENSE_CtxInit(&defaultContext, channelList, channelAcmp, defaultState, ACMP_CHANNELS);
+#else
+	CAPSENSE_CtxInit(&defaultContext, channelList, NULL, defaultState, ACMP_CHANNELS);
+#endif
 
 	// Enable TIMER0 overflow interrupt
 	TIMER_IntEnable(TIMER0, TIMER_IEN_OF);
 
-	// Initialize TIMER1 but do not run yet
-	TIMER_Init_TypeDef timer1_init = TIMER_INIT_DEFAULT;
-	timer1_init.prescale = timerPrescale1024;
-	timer1_init.clkSel = timerClkSelCC1;
-	timer1_init.enable = false;
-	TIMER_Init(TIMER0, &timer1_init);
-
-	// Set TIMER1 top value to 0xFFFF
-	TIMER_TopSet(0, 0xFFFF);
-
-	// Set up TIMER1 CC1 to capture on PRS channel 0 input
-	TIMER_InitCC_TypeDef cc1_init = TIMER_INITCC_DEFAULT;
-	cc1_init.edge         = timerEdgeBoth;
-	cc1_init.mode         = timerCCModeCapture;
-	cc1_init.eventCtrl    = timerEventRising;
-	cc1_init.prsInput     = true;
-	cc1_init.prsInputType = timerPrsInputSync;
-	cc1_init.prsSel       = 0;
-	TIMER_InitCC(TIMER1, 1, &cc1_init);
-
+	// Initialize the counter timers, ACMP n is counted by counters[n]
+	for (i = 0; i < CAPSENSE_ACMPS; i++) {
+		CAPSENSE_CounterInit(counters[i], i);
+	}
 
 	//PRS_SourceSignalSet(0,PRS_ASYNC_CH_CTRL_SOURCESEL_ACMP0,PRS_ASYNC_CH_CTRL_SIGSEL_ACMP0OUT,prsEdgePos);
 
 	// Route the ACMP output using synchronous PRS channel 0
 	PRS_ConnectSignal(0, prsTypeSync, prsSignalACMP0_OUT);
+#if (CAPSENSE_ACMPS > 1)
+	PRS_ConnectSignal(1, prsTypeSync, prsSignalACMP1_OUT);
+#endif
 
-
-	// Set up ACMP1 in capsense mode
-	ACMP_CapsenseInit(ACMP0, &capsenseInit);
+	// Set up the ACMPs in capsense mode
+	for (i = 0; i < CAPSENSE_ACMPS; i++) {
+		ACMP_CapsenseInit(acmps[i], &capsenseInit);
+		currentChannels[i] = CHANNEL_NONE;
+	}
+
+	// Scan steps only write the input on top of this
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+	for (i = 0; i < CAPSENSE_NUM_FREQUENCIES; i++) {
+		inputCtrlBase[i] = (ACMP0->INPUTCTRL
+		                    & ~(_ACMP_INPUTCTRL_POSSEL_MASK | _ACMP_INPUTCTRL_CSRESSEL_MASK))
+		                   | ((uint32_t) frequencies[i] << _ACMP_INPUTCTRL_CSRESSEL_SHIFT);
+	}
+#else
+	inputCtrlBase[0] = ACMP0->INPUTCTRL & ~_ACMP_INPUTCTRL_POSSEL_MASK;
+#endif
 
 	// Route the ACMP out to a pin for debugging purposes
 
@@ -385,15 +3845,57 @@ void CAPSENSE_Init(void)
 	// Assign the port C/D even pin analog inputs to CD ABUS 0
 	GPIO->CDBUSALLOC |= GPIO_CDBUSALLOC_CDODD0_ACMP0;
 	//GPIO->CDBUSALLOC |= GPIO_CDBUSALLOC_CDEVEN0_ACMP0;
+#if (CAPSENSE_ACMPS > 1)
+	GPIO->CDBUSALLOC |= CAPSENSE_ACMP1_CDBUSALLOC;
+#endif
 	GPIO_PinModeSet(DEBUG_ACMP0OUT_PORT, DEBUG_ACMP0OUT_PIN, gpioModePushPull, 0);
 	GPIO->ACMPROUTE[0].ACMPOUTROUTE = (DEBUG_ACMP0OUT_PORT << _GPIO_ACMP_ACMPOUTROUTE_PORT_SHIFT) | (DEBUG_ACMP0OUT_PIN << _GPIO_ACMP_ACMPOUTROUTE_PIN_SHIFT);
 	GPIO->ACMPROUTE[0].ROUTEEN = 1;
 
+	// Contexts without their own bus allocation use this one
+	initBusAlloc.abus = GPIO->ABUSALLOC;
+	initBusAlloc.bbus = GPIO->BBUSALLOC;
+	initBusAlloc.cdbus = GPIO->CDBUSALLOC;
+
 	//TIMER_Enable(TIMER0, true);
 	//TIMER_Enable(TIMER1, true);
 
+	scanActive = false;
+	wakeScan = false;
+	wakePending = 0;
+	activeCtx = NULL;
+
+#if defined(CAPSENSE_STATS)
+	// Enable the DWT cycle counter for the timing statistics
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	statsTickCycles = TIMER0_PRESCALE
+	                  * (CMU_ClockFreqGet(cmuClock_CORE)
+	                     / CMU_ClockFreqGet(cmuClock_TIMER0));
+#endif
+
+#if defined(CAPSENSE_LDMA_FRAMES)
+	// Enable the LDMA for sample capture
+	CMU_ClockEnable(cmuClock_LDMA, true);
+	LDMA->EN = LDMA_EN_EN;
+	ldmaActive = false;
+	NVIC_ClearPendingIRQ(LDMA_IRQn);
+	NVIC_EnableIRQ(LDMA_IRQn);
+#endif
+
+#if defined(CAPSENSE_CALIBRATION)
+	// Start from the stored baselines and windows if there are any
+	CAPSENSE_LoadCalibration(&defaultContext);
+#endif
+
 	// Enable TIMER0 interrupt
 	NVIC_EnableIRQ(TIMER0_IRQn);
+
+	// Enable the counter interrupts ending wake on touch windows
+	for (i = 0; i < CAPSENSE_ACMPS; i++) {
+		NVIC_ClearPendingIRQ(counterIrqs[i]);
+		NVIC_EnableIRQ(counterIrqs[i]);
+	}
 }
 
 /** @} (end group CapSense) */
@@ -0,0 +1,212 @@
+/***************************************************************************//**
+ * @file
+ * @brief Energy and CPU time accounting per scan period
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+
+#include "capsense.h"
+#include "scheduler.h"
+#include "energy.h"
+
+/** Current of each state */
+static ENERGY_Currents_t stateCurrents;
+/** Core clock used to convert cycles to time */
+static uint32_t coreHz;
+/** Rate of the capsense measuring ticks */
+static uint32_t measureHz;
+
+/** Counters at the start of the current period */
+static uint32_t lastTime;
+static uint32_t lastCycles;
+static CAPSENSE_MeasureTicks_t lastMeasure;
+static uint32_t lastInterrupts;
+static SCHED_SleepStats_t lastSleep;
+
+/** The accounting so far */
+static ENERGY_Report_t accounting;
+/** The rolling averages, scaled up by 2^ENERGY_AVERAGE_SHIFT */
+static uint32_t cpuAverage;
+static uint32_t averageCurrent;
+static uint32_t sensingCurrent;
+
+/***************************************************************************//**
+ * @brief
+ *   Convert a count at the given rate to microseconds.
+ ******************************************************************************/
+static uint32_t ENERGY_ToUs(uint32_t count, uint32_t hz)
+{
+  return (uint32_t) (((uint64_t) count * 1000000) / hz);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert the measuring ticks of a kind of peripheral to microseconds,
+ *   at most the period for each of its instances.
+ ******************************************************************************/
+static uint32_t ENERGY_SensingUs(uint32_t ticks, uint32_t period,
+                                 uint32_t instances)
+{
+  uint32_t us = ENERGY_ToUs(ticks, measureHz);
+
+  return (us > period * instances) ? period * instances : us;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Move a rolling average towards a new value and get the average.
+ *
+ * @details
+ *   The average is kept scaled up by 2^ENERGY_AVERAGE_SHIFT, so steps
+ *   smaller than 2^ENERGY_AVERAGE_SHIFT are not lost.
+ ******************************************************************************/
+static uint32_t ENERGY_Average(uint32_t *average, uint32_t value)
+{
+  if (accounting.periods == 0) {
+    *average = value << ENERGY_AVERAGE_SHIFT;
+  } else {
+    *average += value - (*average >> ENERGY_AVERAGE_SHIFT);
+  }
+  return *average >> ENERGY_AVERAGE_SHIFT;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start the accounting. Call after SCHED_Init() and CAPSENSE_Init().
+ *
+ * @details
+ *   The time the core runs is taken from the DWT cycle counter, which stops
+ *   while the core sleeps. Time in EM2 comes from the scheduler and the rest
+ *   of each period is counted as EM1.
+ *
+ * @param[in] currents
+ *   Supply current of each state.
+ ******************************************************************************/
+void ENERGY_Init(const ENERGY_Currents_t *currents)
+{
+  stateCurrents = *currents;
+  coreHz = CMU_ClockFreqGet(cmuClock_CORE);
+  measureHz = CAPSENSE_GetMeasureTickHz();
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  lastTime = SCHED_Now();
+  lastCycles = DWT->CYCCNT;
+  CAPSENSE_GetMeasureTicks(&lastMeasure);
+  lastInterrupts = CAPSENSE_GetInterruptCount();
+  SCHED_GetSleepStats(&lastSleep);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Close the current period and start the next one. Call once per scan
+ *   period from a task.
+ ******************************************************************************/
+void ENERGY_Update(void)
+{
+  SCHED_SleepStats_t sleep;
+  CAPSENSE_MeasureTicks_t measure;
+  uint32_t interrupts = CAPSENSE_GetInterruptCount();
+  uint32_t now = SCHED_Now();
+  uint32_t cycles = DWT->CYCCNT;
+  uint32_t period;
+  uint32_t active;
+  uint64_t sensing;
+  uint64_t charge;
+
+  SCHED_GetSleepStats(&sleep);
+  CAPSENSE_GetMeasureTicks(&measure);
+
+  period = ENERGY_ToUs(now - lastTime, SCHED_TICKS_PER_SECOND);
+  if (period == 0) {
+    return;
+  }
+
+  accounting.periodUs = period;
+  accounting.em0Us = ENERGY_ToUs(cycles - lastCycles, coreHz);
+  accounting.em2Us = ENERGY_ToUs(sleep.em2Ticks - lastSleep.em2Ticks,
+                             SCHED_TICKS_PER_SECOND);
+  // Sleep is rounded to RTCC ticks, keep the parts within the period
+  if (accounting.em0Us > period) {
+    accounting.em0Us = period;
+  }
+  if (accounting.em2Us > period - accounting.em0Us) {
+    accounting.em2Us = period - accounting.em0Us;
+  }
+  accounting.em1Us = period - accounting.em0Us - accounting.em2Us;
+  accounting.acmpUs = ENERGY_SensingUs(measure.acmp - lastMeasure.acmp,
+                                      period, CAPSENSE_ACMPS);
+  accounting.timer0Us = ENERGY_SensingUs(measure.timer0 - lastMeasure.timer0,
+                                        period, 1);
+  accounting.timer1Us = ENERGY_SensingUs(measure.timer1 - lastMeasure.timer1,
+                                        period, CAPSENSE_ACMPS);
+  accounting.prsUs = ENERGY_SensingUs(measure.prs - lastMeasure.prs, period,
+                                      CAPSENSE_ACMPS);
+  accounting.schedWakeups = sleep.wakeups - lastSleep.wakeups;
+  accounting.capsenseWakeups = interrupts - lastInterrupts;
+
+  // uA * us = pC, divided by the period in us gives uA
+  active = (uint32_t) (((uint64_t) accounting.em0Us * 1000) / period);
+  sensing = (uint64_t) accounting.acmpUs * stateCurrents.acmp
+            + (uint64_t) accounting.timer0Us * stateCurrents.timer0
+            + (uint64_t) accounting.timer1Us * stateCurrents.timer1
+            + (uint64_t) accounting.prsUs * stateCurrents.prs;
+  charge = (uint64_t) accounting.em0Us * stateCurrents.em0
+           + (uint64_t) accounting.em1Us * stateCurrents.em1
+           + (uint64_t) accounting.em2Us * stateCurrents.em2
+           + sensing;
+  accounting.cpuPermille = ENERGY_Average(&cpuAverage, active);
+  accounting.sensingNa = ENERGY_Average(&sensingCurrent,
+                                        (uint32_t) ((sensing * 1000) / period));
+  accounting.averageNa = ENERGY_Average(&averageCurrent,
+                                        (uint32_t) ((charge * 1000) / period));
+  accounting.periods++;
+
+  lastTime = now;
+  lastCycles = cycles;
+  lastMeasure = measure;
+  lastInterrupts = interrupts;
+  lastSleep = sleep;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the accounting of the last period and the rolling averages.
+ ******************************************************************************/
+void ENERGY_GetReport(ENERGY_Report_t *report)
+{
+  *report = accounting;
+}
@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ * @file
+ * @brief Energy and CPU time accounting per scan period
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __ENERGY_H_
+#define __ENERGY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Averaging weight 1/2^n of the rolling averages */
+#ifndef ENERGY_AVERAGE_SHIFT
+#define ENERGY_AVERAGE_SHIFT    4
+#endif
+
+/** Supply current of each state in uA. Measure these on the target board.
+ *  The sensing peripherals add theirs per instance while measuring. */
+typedef struct {
+  uint32_t em0;                   /**< Core running */
+  uint32_t em1;                   /**< Core sleeping, HF clocks running */
+  uint32_t em2;                   /**< Deep sleep with the RTCC running */
+  uint32_t acmp;                  /**< An ACMP in capsense mode */
+  uint32_t timer0;                /**< TIMER0 timing a window */
+  uint32_t timer1;                /**< A TIMER counting ACMP pulses */
+  uint32_t prs;                   /**< A PRS channel routing an ACMP output */
+} ENERGY_Currents_t;
+
+/** Rough figures for the EFR32xG21 running from the 19 MHz HFRCO */
+#define ENERGY_CURRENTS_DEFAULT \
+  {                             \
+    1000,                       \
+    700,                        \
+    5,                          \
+    10,                         \
+    20,                         \
+    20,                         \
+    2,                          \
+  }
+
+/** Accounting of the last period and rolling averages over many periods */
+typedef struct {
+  uint32_t periods;               /**< Number of periods accounted */
+  uint32_t periodUs;              /**< Length of the last period */
+  uint32_t em0Us;                 /**< Time the core ran in the last period */
+  uint32_t em1Us;                 /**< Time spent in EM1 in the last period */
+  uint32_t em2Us;                 /**< Time spent in EM2 in the last period */
+  uint32_t acmpUs;                /**< ACMP time in the last period */
+  uint32_t timer0Us;              /**< TIMER0 time in the last period */
+  uint32_t timer1Us;              /**< Pulse counter time in the last period */
+  uint32_t prsUs;                 /**< PRS channel time in the last period */
+  uint32_t schedWakeups;          /**< Scheduler returns from sleep in the
+                                       last period */
+  uint32_t capsenseWakeups;       /**< Capsense interrupts in the last period,
+                                       each one waking the core */
+  uint32_t cpuPermille;           /**< Average share of time the core ran */
+  uint32_t averageNa;             /**< Average supply current in nA (nAh/h) */
+  uint32_t sensingNa;             /**< Share of averageNa spent measuring */
+} ENERGY_Report_t;
+
+void ENERGY_Init(const ENERGY_Currents_t *currents);
+void ENERGY_Update(void);
+void ENERGY_GetReport(ENERGY_Report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ENERGY_H_ */
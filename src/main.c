@@ -40,34 +40,216 @@
 #include "em_gpio.h"
 
 #include "capsense.h"
+#if defined(CAPSENSE_SLIDER_MAP)
+#include "capsense_centroid.h"
+#include "capsense_gesture.h"
+#endif
+#include "capsense_proximity.h"
+#include "energy.h"
+#include "scheduler.h"
 
 #include "bsp.h"
 
-// Count 1 ms ticks
-static volatile uint32_t msTicks;
+// Time between the starts of two capsense scans
+#define APP_SCAN_PERIOD_MS      20
+// Time after its release by which a scan should have started
+#define APP_SCAN_DEADLINE_MS    2
+// Time after a completed scan by which the LEDs should be updated
+#define APP_TOUCH_DEADLINE_MS   5
+// Time between the starts of two proximity and wake on touch scans while idle
+#define APP_IDLE_PERIOD_MS      100
+// Time without a touch after which the buttons are considered idle
+#define APP_IDLE_AFTER_MS       2000
+
+static SCHED_Task_t scanTask;
+static SCHED_Task_t touchTask;
+static SCHED_Task_t wakeTask;
+
+static const ENERGY_Currents_t energyCurrents = ENERGY_CURRENTS_DEFAULT;
+
+// The buttons combined into one proximity sensor while idle
+static const ACMP_Channel_TypeDef proximityElectrodes[] = CAPSENSE_CHANNELS;
+// The ACMP_CHANNELS in use, at most the electrodes listed
+#define APP_PROXIMITY_LISTED \
+  (sizeof(proximityElectrodes) / sizeof(proximityElectrodes[0]))
+#define APP_PROXIMITY_ELECTRODES \
+  ((ACMP_CHANNELS < APP_PROXIMITY_LISTED) ? ACMP_CHANNELS : APP_PROXIMITY_LISTED)
+static CAPSENSE_Proximity_t proximity;
+static bool proximityEnabled;
+
+#if defined(CAPSENSE_SLIDER_MAP)
+// Gestures on the slider of CAPSENSE_SLIDER_MAP
+static CAPSENSE_Gesture_t gesture;
+#endif
+
+// Full scans run while active, starting with the baseline calibration
+static bool appActive = true;
+// Time of the last touch in ticks
+static uint32_t lastTouch;
 
 /***************************************************************************//**
  * @brief
- *   SysTick_Handler. Interrupt Service Routine for system tick counter
+ *   Called from interrupt context when a capsense scan is complete.
  ******************************************************************************/
-void SysTick_Handler(void)
+static void scanComplete(void)
 {
-  msTicks++;
+  SCHED_BlockEM2(false);
+  SCHED_Post(&touchTask);
 }
 
 /***************************************************************************//**
  * @brief
- *   Delays number of msTick Systicks (typically 1 ms)
- *
- * @param dlyTicks
- *   Number of ticks (ms) to delay
+ *   Called from interrupt context when a wake on touch scan ends. Only a
+ *   probable touch wakes up the application.
+ ******************************************************************************/
+static void wakeComplete(bool touched)
+{
+  SCHED_BlockEM2(false);
+  if (touched) {
+    SCHED_Post(&wakeTask);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Called from interrupt context when a proximity scan is done. A hand
+ *   near the buttons wakes up the application, otherwise a wake on touch
+ *   scan follows to catch a touch the proximity sensor missed.
+ ******************************************************************************/
+static void proximityComplete(void)
+{
+  if (CAPSENSE_ProximityIsNear(&proximity)) {
+    SCHED_BlockEM2(false);
+    SCHED_Post(&wakeTask);
+  } else if (!CAPSENSE_StartWakeScan(wakeComplete)) {
+    SCHED_BlockEM2(false);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Periodic task starting a capsense scan. The core sleeps in EM1 while
+ *   the scan runs since the ACMP and TIMERs need the HF clocks. While idle
+ *   only the proximity sensor and a wake on touch scan run, at a low rate.
  ******************************************************************************/
-static void Delay(uint32_t dlyTicks)
+static void scanTaskRun(void)
 {
-  uint32_t curTicks;
+  bool started;
+
+  // Account the energy and CPU time of the previous period
+  ENERGY_Update();
+
+  SCHED_BlockEM2(true);
+  if (appActive) {
+    started = CAPSENSE_StartScan(scanComplete);
+  } else if (proximityEnabled) {
+    started = CAPSENSE_ProximityStartScan(&proximity, proximityComplete);
+  } else {
+    started = CAPSENSE_StartWakeScan(wakeComplete);
+  }
+  if (!started) {
+    // The previous scan is still running
+    SCHED_BlockEM2(false);
+  }
+}
 
-  curTicks = msTicks;
-  while ((msTicks - curTicks) < dlyTicks);
+/***************************************************************************//**
+ * @brief
+ *   Task posted when a hand approaches the buttons or a wake on touch scan
+ *   found a probable touch, going back to full rate scanning.
+ ******************************************************************************/
+static void wakeTaskRun(void)
+{
+  appActive = true;
+  lastTouch = SCHED_Now();
+  SCHED_TaskSetPeriod(&scanTask, APP_SCAN_PERIOD_MS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Timestamp source for capsense events, in milliseconds.
+ ******************************************************************************/
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return SCHED_TICKS_TO_MS(SCHED_Now());
+}
+
+#if defined(CAPSENSE_SLIDER_MAP)
+/***************************************************************************//**
+ * @brief
+ *   Feed the slider position of the last scan to the gesture recognizer.
+ *   A swipe towards the end of the slider turns on LED1 and a swipe towards
+ *   its start turns it off, a double tap toggles LED0.
+ ******************************************************************************/
+static void sliderUpdate(void)
+{
+  int32_t positions[CAPSENSE_CENTROID_MAX_TOUCHES];
+  CAPSENSE_GestureEvent_t event;
+
+  if (CAPSENSE_GetSliderTouches(positions) == 0) {
+    positions[0] = -1;
+  }
+  CAPSENSE_GestureUpdate(&gesture, positions[0], CAPSENSE_GetTimestamp());
+
+  while (CAPSENSE_GestureGetEvent(&gesture, &event)) {
+    if (event.type == CAPSENSE_GESTURE_SWIPE) {
+      if (event.speed > 0)
+        BSP_LedSet(1);
+      else
+        BSP_LedClear(1);
+    } else if (event.type == CAPSENSE_GESTURE_DOUBLE_TAP) {
+      BSP_LedToggle(0);
+    }
+  }
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Task run after each scan, updating the LEDs from the button events, or
+ *   from the slider gestures if the buttons are part of a slider.
+ ******************************************************************************/
+static void touchTaskRun(void)
+{
+  CAPSENSE_Event_t event;
+  bool pressed;
+#if defined(CAPSENSE_SLIDER_MAP)
+  sliderUpdate();
+  while (CAPSENSE_GetEvent(&event)) {
+  }
+#else
+  int led;
+
+  while (CAPSENSE_GetEvent(&event)) {
+    if (event.channel == BUTTON0_CHANNEL)
+      led = 0;
+    else if (event.channel == BUTTON1_CHANNEL)
+      led = 1;
+    else
+      continue;
+
+    // Turn on the LED while its capsense button is pressed
+    if (event.type == CAPSENSE_EVENT_PRESS)
+      BSP_LedSet(led);
+    else if (event.type == CAPSENSE_EVENT_RELEASE)
+      BSP_LedClear(led);
+  }
+#endif
+
+  // Drop to idle scans once the buttons are left alone
+  pressed = CAPSENSE_getPressed(BUTTON0_CHANNEL);
+#if (BUTTON1_CHANNEL < ACMP_CHANNELS)
+  // The kit configuration only scans the first button
+  pressed = pressed || CAPSENSE_getPressed(BUTTON1_CHANNEL);
+#endif
+  if (pressed) {
+    lastTouch = SCHED_Now();
+  } else if (appActive
+             && (SCHED_Now() - lastTouch)
+                >= SCHED_MS_TO_TICKS(APP_IDLE_AFTER_MS)) {
+    appActive = false;
+    SCHED_TaskSetPeriod(&scanTask, APP_IDLE_PERIOD_MS);
+  }
 }
 
 /***************************************************************************//**
@@ -78,34 +260,32 @@ int main(void)
 {
   CHIP_Init();
 
-  // Setup SysTick 1 ms interrupts
-  if (SysTick_Config(SystemCoreClockGet() / 1000))
-    while (1) ;
+  // Start the tickless scheduler
+  SCHED_Init();
 
   // Initialize STK LEDs
   BSP_LedsInit();
 
   // Start capacitive sense buttons
   CAPSENSE_Init();
+  // Without the proximity sensor the idle scans only wake on touch
+  proximityEnabled = CAPSENSE_ProximityInit(&proximity, proximityElectrodes,
+                                            APP_PROXIMITY_ELECTRODES, NULL);
 
-  //BSP_LedSet(0);
+#if defined(CAPSENSE_SLIDER_MAP)
+  CAPSENSE_GestureInit(&gesture);
+#endif
 
-  while (1)
-  {
-    Delay(100);
+  // Track the average supply current from here on
+  ENERGY_Init(&energyCurrents);
 
-    CAPSENSE_Sense();
+  //BSP_LedSet(0);
 
-    // Turn on LED0 if capsense button 0 pressed; otherwise turn it off
-    if (CAPSENSE_getPressed(BUTTON0_CHANNEL))
-      BSP_LedSet(0);
-    else
-      BSP_LedClear(0);
+  SCHED_TaskAdd(&scanTask, scanTaskRun, APP_SCAN_PERIOD_MS, APP_SCAN_DEADLINE_MS);
+  SCHED_TaskAdd(&touchTask, touchTaskRun, 0, APP_TOUCH_DEADLINE_MS);
+  SCHED_TaskAdd(&wakeTask, wakeTaskRun, 0, APP_TOUCH_DEADLINE_MS);
+  lastTouch = SCHED_Now();
 
-    // Turn on LED1 if capsense button 1 pressed; otherwise turn it off
-    if (CAPSENSE_getPressed(BUTTON1_CHANNEL))
-      BSP_LedSet(1);
-    else
-      BSP_LedClear(1);
-  }
+  // Sleep between frames and react to each completed scan
+  SCHED_Run();
 }
@@ -0,0 +1,325 @@
+/***************************************************************************//**
+ * @file
+ * @brief Tickless cooperative scheduler
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "em_rtcc.h"
+
+#include "scheduler.h"
+
+/** RTCC channel used for wakeups */
+#define SCHED_RTCC_CH           1
+
+/** List of all tasks */
+static SCHED_Task_t *taskList;
+
+/** Number of users which need the HF peripherals, EM2 is only entered at 0 */
+static volatile uint32_t em2Blocks;
+
+/** Time spent in each sleep mode */
+static SCHED_SleepStats_t sleepStats;
+
+/***************************************************************************//**
+ * @brief
+ *   RTCC interrupt handler. Only used to wake the core up.
+ ******************************************************************************/
+void RTCC_IRQHandler(void)
+{
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Mark a task ready. Must be called with interrupts disabled.
+ ******************************************************************************/
+static void SCHED_Release(SCHED_Task_t *task, uint32_t now)
+{
+  if (!task->pending) {
+    task->due = now + task->deadline;
+    task->pending = true;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the scheduler and the RTCC running from LFRCO.
+ *
+ * @details
+ *   The RTCC keeps running in EM2, so there is no periodic tick and the
+ *   core only wakes up when a task is released or an interrupt posts one.
+ ******************************************************************************/
+void SCHED_Init(void)
+{
+  RTCC_Init_TypeDef rtccInit = RTCC_INIT_DEFAULT;
+  RTCC_CCChConf_TypeDef compare = RTCC_CH_INIT_COMPARE_DEFAULT;
+
+  taskList = NULL;
+  em2Blocks = 0;
+
+  CMU_ClockSelectSet(cmuClock_RTCC, cmuSelect_LFRCO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
+
+  // 32768 Hz / 32 gives SCHED_TICKS_PER_SECOND
+  rtccInit.presc = rtccCntPresc_32;
+  rtccInit.enable = true;
+  RTCC_Init(&rtccInit);
+
+  RTCC_ChannelInit(SCHED_RTCC_CH, &compare);
+  RTCC_IntClear(RTCC_IF_CC1);
+  RTCC_IntEnable(RTCC_IEN_CC1);
+  NVIC_ClearPendingIRQ(RTCC_IRQn);
+  NVIC_EnableIRQ(RTCC_IRQn);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add a task to the scheduler.
+ *
+ * @param task
+ *   Task storage, must stay valid while the scheduler runs.
+ *
+ * @param function
+ *   Function to run.
+ *
+ * @param periodMs
+ *   Release period, or 0 for a task which only runs when posted.
+ *
+ * @param deadlineMs
+ *   Time after a release by which the task should have run. Ready tasks
+ *   run earliest deadline first.
+ ******************************************************************************/
+void SCHED_TaskAdd(SCHED_Task_t *task,
+                   SCHED_TaskFunction_t function,
+                   uint32_t periodMs,
+                   uint32_t deadlineMs)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  task->function = function;
+  task->period = SCHED_MS_TO_TICKS(periodMs);
+  task->deadline = SCHED_MS_TO_TICKS(deadlineMs);
+  task->pending = false;
+  task->misses = 0;
+
+  CORE_ENTER_ATOMIC();
+  task->release = SCHED_Now();
+  task->next = taskList;
+  taskList = task;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Mark a task ready to run. Can be called from interrupt context.
+ ******************************************************************************/
+void SCHED_Post(SCHED_Task_t *task)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  SCHED_Release(task, SCHED_Now());
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Change the release period of a periodic task.
+ *
+ * @details
+ *   The next release is at the current time plus the new period, so a
+ *   task slowed down for idle does not wait out its long period when
+ *   switched back to a fast one.
+ *
+ * @param periodMs
+ *   New release period, must not be 0.
+ ******************************************************************************/
+void SCHED_TaskSetPeriod(SCHED_Task_t *task, uint32_t periodMs)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  task->period = SCHED_MS_TO_TICKS(periodMs);
+  task->release = SCHED_Now() + task->period;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the current time in ticks.
+ ******************************************************************************/
+uint32_t SCHED_Now(void)
+{
+  return RTCC_CounterGet();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of times a task ran after its deadline.
+ ******************************************************************************/
+uint32_t SCHED_Misses(const SCHED_Task_t *task)
+{
+  return task->misses;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the time spent sleeping since SCHED_Init().
+ *
+ * @details
+ *   Sleep is timed with the RTCC, so every sleep is rounded to whole ticks.
+ *   The counters are only written by SCHED_Run(), tasks can read them
+ *   without locking.
+ ******************************************************************************/
+void SCHED_GetSleepStats(SCHED_SleepStats_t *stats)
+{
+  *stats = sleepStats;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Prevent or allow EM2 while sleeping.
+ *
+ * @details
+ *   Calls nest. Used while HF peripherals such as the capsense TIMERs are
+ *   running, the core then sleeps in EM1 instead. Can be called from
+ *   interrupt context.
+ ******************************************************************************/
+void SCHED_BlockEM2(bool block)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (block) {
+    em2Blocks++;
+  } else if (em2Blocks > 0) {
+    em2Blocks--;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Release periodic tasks and find the ready task with the earliest
+ *   deadline. Must be called with interrupts disabled.
+ *
+ * @param[out] wakeup
+ *   The time of the next periodic release.
+ *
+ * @return
+ *   The task to run, or NULL if no task is ready.
+ ******************************************************************************/
+static SCHED_Task_t *SCHED_Next(uint32_t now, uint32_t *wakeup)
+{
+  SCHED_Task_t *task;
+  SCHED_Task_t *best = NULL;
+
+  // Without periodic tasks, sleep as long as the counter allows
+  *wakeup = now + 0x7FFFFFFF;
+
+  for (task = taskList; task != NULL; task = task->next) {
+    if (task->period != 0) {
+      if ((int32_t) (now - task->release) >= 0) {
+        SCHED_Release(task, task->release);
+        task->release += task->period;
+        if ((int32_t) (now - task->release) >= 0) {
+          // Fell behind, skip the missed releases
+          task->release = now + task->period;
+        }
+      }
+      if ((int32_t) (task->release - *wakeup) < 0) {
+        *wakeup = task->release;
+      }
+    }
+
+    if (task->pending
+        && ((best == NULL) || ((int32_t) (task->due - best->due) < 0))) {
+      best = task;
+    }
+  }
+
+  return best;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the scheduler. Does not return.
+ *
+ * @details
+ *   Ready tasks are run to completion. When no task is ready the RTCC is
+ *   set to wake the core up at the next periodic release and the core
+ *   sleeps in EM2, or in EM1 while EM2 is blocked. Interrupts are masked
+ *   from the last check to the sleep so a task posted from an interrupt
+ *   handler is never left waiting.
+ ******************************************************************************/
+void SCHED_Run(void)
+{
+  SCHED_Task_t *task;
+  uint32_t now;
+  uint32_t wakeup;
+  uint32_t sleepStart;
+  CORE_DECLARE_IRQ_STATE;
+
+  while (1) {
+    CORE_ENTER_ATOMIC();
+    now = SCHED_Now();
+    task = SCHED_Next(now, &wakeup);
+    if (task != NULL) {
+      task->pending = false;
+      if ((int32_t) (now - task->due) > 0) {
+        task->misses++;
+      }
+      CORE_EXIT_ATOMIC();
+      task->function();
+      continue;
+    }
+
+    RTCC_ChannelCCVSet(SCHED_RTCC_CH, wakeup);
+    sleepStart = SCHED_Now();
+    if ((int32_t) (wakeup - sleepStart) > 0) {
+      if (em2Blocks > 0) {
+        EMU_EnterEM1();
+        sleepStats.em1Ticks += SCHED_Now() - sleepStart;
+      } else {
+        EMU_EnterEM2(true);
+        sleepStats.em2Ticks += SCHED_Now() - sleepStart;
+      }
+      sleepStats.wakeups++;
+    }
+    CORE_EXIT_ATOMIC();
+  }
+}
@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file
+ * @brief Tickless cooperative scheduler
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SCHEDULER_H_
+#define __SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "em_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Scheduler time base, the RTCC counts at 1024 Hz */
+#define SCHED_TICKS_PER_SECOND  1024
+
+/** Convert milliseconds to scheduler ticks, rounding up */
+#define SCHED_MS_TO_TICKS(ms) \
+  ((((uint32_t) (ms)) * SCHED_TICKS_PER_SECOND + 999) / 1000)
+
+/** Convert scheduler ticks to milliseconds, rounding down */
+#define SCHED_TICKS_TO_MS(ticks) \
+  ((uint32_t) (((uint64_t) (ticks) * 1000) / SCHED_TICKS_PER_SECOND))
+
+/** Function run by a task */
+typedef void (*SCHED_TaskFunction_t)(void);
+
+/** A task. All fields are private to the scheduler. */
+typedef struct SCHED_Task {
+  SCHED_TaskFunction_t function;  /**< Function to run */
+  uint32_t period;                /**< Release period in ticks, 0 if none */
+  uint32_t deadline;              /**< Deadline in ticks after a release */
+  uint32_t release;               /**< Time of the next periodic release */
+  uint32_t due;                   /**< Absolute deadline of the pending run */
+  volatile bool pending;          /**< Set when the task is ready to run */
+  uint32_t misses;                /**< Number of runs after their deadline */
+  struct SCHED_Task *next;        /**< Next task in the task list */
+} SCHED_Task_t;
+
+/** Time spent sleeping, kept by SCHED_Run(). All counters wrap. */
+typedef struct {
+  uint32_t em1Ticks;              /**< Ticks spent in EM1 */
+  uint32_t em2Ticks;              /**< Ticks spent in EM2 */
+  uint32_t wakeups;               /**< Number of wakeups from sleep */
+} SCHED_SleepStats_t;
+
+void SCHED_Init(void);
+void SCHED_TaskAdd(SCHED_Task_t *task,
+                   SCHED_TaskFunction_t function,
+                   uint32_t periodMs,
+                   uint32_t deadlineMs);
+void SCHED_Post(SCHED_Task_t *task);
+void SCHED_TaskSetPeriod(SCHED_Task_t *task, uint32_t periodMs);
+uint32_t SCHED_Now(void);
+uint32_t SCHED_Misses(const SCHED_Task_t *task);
+void SCHED_BlockEM2(bool block);
+void SCHED_GetSleepStats(SCHED_SleepStats_t *stats);
+SL_NORETURN void SCHED_Run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCHEDULER_H_ */
@@ -0,0 +1,82 @@
+/***************************************************************************//**
+ * @file
+ * @brief Sections of the capsense benchmark
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __BENCH_H_
+#define __BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/* capsense_bench runs a list of sections, see capsense_bench.c. Each
+ * section prints its figures as aligned "label  value" lines and returns
+ * false if one of its acceptance checks failed, so ctest sees a regression
+ * as a nonzero exit code. Virtual times come from the simulator, host times
+ * from BENCH_HostNs() and only compare code paths with each other. */
+
+/** Nanoseconds per virtual millisecond */
+#define BENCH_MS                1000000ULL
+
+/** Run a section for a number of virtual seconds, where that applies */
+typedef bool (*BENCH_Run_t)(uint64_t seconds);
+
+/** A section of the benchmark */
+typedef struct {
+  const char *name;               /**< Name selecting it on the command line */
+  BENCH_Run_t run;                /**< The section */
+} BENCH_Section_t;
+
+/***************************************************************************//**
+ * @brief
+ *   Host time in ns, for the cost of driver calls.
+ ******************************************************************************/
+static inline uint64_t BENCH_HostNs(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+bool BENCH_Example(uint64_t seconds);
+bool BENCH_DelayLoop(uint64_t seconds);
+bool BENCH_Normalize(uint64_t seconds);
+bool BENCH_Centroid(uint64_t seconds);
+bool BENCH_Wake(uint64_t seconds);
+bool BENCH_Scan(uint64_t seconds);
+bool BENCH_Batch(uint64_t seconds);
+
+#endif /* __BENCH_H_ */
@@ -0,0 +1,180 @@
+/***************************************************************************//**
+ * @file
+ * @brief Benchmark section of the batch frame processing
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capsense.h"
+#include "bench.h"
+
+/* Contexts of 8, 16 and 32 channels get the same counts either a batch of
+ * CAPSENSE_BATCH_FRAMES frames at a time through CAPSENSE_CtxProcessBatch(),
+ * or one frame at a time followed by the per-channel calls a consumer of
+ * CAPSENSE_CtxSense() makes: the value, the normalized value and the
+ * pressed state of each channel and the slider position. The one frame
+ * batches stand in for the samples the interrupt handlers store. Both must
+ * give the same values, levels, pressed states and slider positions. */
+
+#define BENCH_BATCH_FRAMES      200000UL
+
+static CAPSENSE_Context_t batchCtx;
+static CAPSENSE_Context_t callCtx;
+static CAPSENSE_ChannelState_t batchState[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_ChannelState_t callState[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+static CAPSENSE_Batch_t single;
+static volatile uint32_t sink;
+
+/***************************************************************************//**
+ * @brief
+ *   Fill a batch with counts, with one touched channel in eight pressed
+ *   in the second half of the batch.
+ ******************************************************************************/
+static void fill(uint8_t channels)
+{
+  uint32_t s;
+  uint8_t channel;
+
+  memset(&batch, 0, sizeof(batch));
+  batch.frames = CAPSENSE_BATCH_FRAMES;
+  for (channel = 0; channel < channels; channel++) {
+    for (s = 0; s < batch.frames; s++) {
+      batch.counts[channel][s] = (uint16_t) (250 + 13 * channel + (s * 7) % 5);
+      if (((channel % 8) == 3) && (s >= batch.frames / 2)) {
+        batch.counts[channel][s] /= 2;
+      }
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Process one frame of the batch and read it back with the per-channel
+ *   calls.
+ *
+ * @return
+ *   The number of results which differ from the batch.
+ ******************************************************************************/
+static uint32_t callFrame(uint8_t channels, uint32_t s, bool compare)
+{
+  uint32_t mismatches = 0;
+  uint32_t sum = 0;
+  uint32_t value;
+  uint32_t level;
+  bool pressed;
+  int32_t slider;
+  uint8_t channel;
+
+  single.frames = 1;
+  for (channel = 0; channel < channels; channel++) {
+    single.counts[channel][0] = batch.counts[channel][s];
+  }
+  CAPSENSE_CtxProcessBatch(&callCtx, &single);
+
+  for (channel = 0; channel < channels; channel++) {
+    value = CAPSENSE_CtxGetVal(&callCtx, channel);
+    level = CAPSENSE_CtxGetNormalizedVal(&callCtx, channel);
+    pressed = CAPSENSE_CtxGetPressed(&callCtx, channel);
+    sum += value + level + pressed;
+    if (compare
+        && ((value != batch.values[channel][s])
+            || (level != batch.levels[channel][s])
+            || (pressed != ((batch.pressed[s] >> channel) & 1)))) {
+      mismatches++;
+    }
+  }
+  slider = CAPSENSE_CtxGetSliderPosition(&callCtx);
+  if (compare && (slider != batch.slider[s])) {
+    mismatches++;
+  }
+  sink = sum + (uint32_t) slider;
+  return mismatches;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the comparison for 8, 16 and 32 channels.
+ ******************************************************************************/
+bool BENCH_Batch(uint64_t seconds)
+{
+  static const uint8_t counts[] = { 8, 16, 32 };
+  uint32_t mismatches = 0;
+  uint64_t start;
+  double batchNs;
+  double callNs;
+  uint32_t n;
+  uint32_t i;
+  uint32_t s;
+  uint8_t channels;
+
+  (void) seconds;
+  printf("channels   batch frames/s   per-call frames/s\n");
+  for (n = 0; n < sizeof(counts) / sizeof(counts[0]); n++) {
+    channels = counts[n];
+    if (channels > CAPSENSE_MAX_CHANNELS) {
+      break;
+    }
+    fill(channels);
+    CAPSENSE_CtxInit(&batchCtx, NULL, NULL, batchState, channels);
+    CAPSENSE_CtxInit(&callCtx, NULL, NULL, callState, channels);
+
+    // The first batch sets the baselines of both contexts the same way
+    CAPSENSE_CtxProcessBatch(&batchCtx, &batch);
+    for (s = 0; s < batch.frames; s++) {
+      mismatches += callFrame(channels, s, true);
+    }
+
+    start = BENCH_HostNs();
+    for (i = 0; i < BENCH_BATCH_FRAMES / CAPSENSE_BATCH_FRAMES; i++) {
+      CAPSENSE_CtxProcessBatch(&batchCtx, &batch);
+    }
+    batchNs = (double) (BENCH_HostNs() - start);
+
+    start = BENCH_HostNs();
+    for (i = 0; i < BENCH_BATCH_FRAMES / CAPSENSE_BATCH_FRAMES; i++) {
+      for (s = 0; s < batch.frames; s++) {
+        callFrame(channels, s, false);
+      }
+    }
+    callNs = (double) (BENCH_HostNs() - start);
+
+    printf("%8u   %14.0f   %17.0f\n", channels,
+           BENCH_BATCH_FRAMES * 1e9 / batchNs,
+           BENCH_BATCH_FRAMES * 1e9 / callNs);
+  }
+  printf("mismatches          %lu\n", (unsigned long) mismatches);
+  return mismatches == 0;
+}
@@ -0,0 +1,136 @@
+/***************************************************************************//**
+ * @file
+ * @brief Benchmark section of the centroid engine
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capsense_centroid.h"
+#include "bench.h"
+
+/* Contexts of 8, 16 and 32 channels publish a frame with two touches. The
+ * channels form one slider, and as a pad the first half are the rows and
+ * the second half the columns. Each call is timed over the published
+ * frame, and the slider must find both touches. */
+
+#define BENCH_CALLS             200000UL
+
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+static uint8_t map[CAPSENSE_MAX_CHANNELS];
+static volatile int32_t sink;
+
+/***************************************************************************//**
+ * @brief
+ *   Publish a frame at the baseline of 1000 counts followed by a frame with
+ *   touches centered on two channels.
+ ******************************************************************************/
+static void publish(uint8_t channels, uint8_t first, uint8_t second)
+{
+  uint8_t channel;
+
+  CAPSENSE_CtxInit(&ctx, NULL, NULL, state, channels);
+  memset(&batch, 0, sizeof(batch));
+  batch.frames = 2;
+  for (channel = 0; channel < channels; channel++) {
+    map[channel] = channel;
+    batch.counts[channel][0] = 1000;
+    batch.counts[channel][1] = 1000;
+  }
+  batch.counts[first][1] = 500;
+  batch.counts[first + 1][1] = 800;
+  batch.counts[second][1] = 500;
+  batch.counts[second - 1][1] = 800;
+  CAPSENSE_CtxProcessBatch(&ctx, &batch);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the centroid engine for 8, 16 and 32 electrodes.
+ ******************************************************************************/
+bool BENCH_Centroid(uint64_t seconds)
+{
+  static const uint8_t counts[] = { 8, 16, 32 };
+  int32_t positions[CAPSENSE_CENTROID_MAX_TOUCHES];
+  int32_t x;
+  int32_t y;
+  uint64_t start;
+  uint64_t sliderNs;
+  uint64_t padNs;
+  uint32_t missed = 0;
+  uint32_t n;
+  uint32_t i;
+  uint8_t channels;
+  uint8_t half;
+
+  (void) seconds;
+  printf("electrodes   slider ns/frame   pad ns/frame\n");
+  for (n = 0; n < sizeof(counts) / sizeof(counts[0]); n++) {
+    channels = counts[n];
+    if (channels > CAPSENSE_MAX_CHANNELS) {
+      break;
+    }
+    half = channels / 2;
+    // One touch on a row and one on a column
+    publish(channels, 1, half + 2);
+
+    if (CAPSENSE_CtxGetSliderTouches(&ctx, map, channels, positions) != 2) {
+      missed++;
+    }
+    if (!CAPSENSE_CtxGetPadPosition(&ctx, map, half, map + half, half,
+                                    &x, &y)) {
+      missed++;
+    }
+
+    start = BENCH_HostNs();
+    for (i = 0; i < BENCH_CALLS; i++) {
+      sink = CAPSENSE_CtxGetSliderTouches(&ctx, map, channels, positions);
+    }
+    sliderNs = BENCH_HostNs() - start;
+
+    start = BENCH_HostNs();
+    for (i = 0; i < BENCH_CALLS; i++) {
+      sink = CAPSENSE_CtxGetPadPosition(&ctx, map, half, map + half, half,
+                                        &x, &y);
+    }
+    padNs = BENCH_HostNs() - start;
+
+    printf("%10u   %15.1f   %12.1f\n", channels,
+           (double) sliderNs / BENCH_CALLS, (double) padNs / BENCH_CALLS);
+  }
+  printf("missed touches      %lu\n", (unsigned long) missed);
+  return missed == 0;
+}
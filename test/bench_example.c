@@ -0,0 +1,282 @@
+/***************************************************************************//**
+ * @file
+ * @brief Benchmark sections running the example application and the
+ *        original main loop
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bsp.h"
+#include "capsense.h"
+#include "energy.h"
+#include "scheduler.h"
+#include "sim.h"
+#include "bench.h"
+
+/* The example application of src/main.c, renamed by the build, runs with
+ * the kit configuration on scripted button touches. BUTTON0 is measured on
+ * a 10 pF electrode with a slow drift and some noise. The touches are
+ * spaced so that both the full rate scans and the proximity scans of the
+ * idle application detect them. Only LED0 is checked, it follows the
+ * debounced state of BUTTON0. The original main loop, which polled the
+ * driver every 100 ms after a busy wait, runs on the same touches for
+ * comparison. */
+
+#define MS                      BENCH_MS
+#define BENCH_TOUCHES           64
+/** Longest detection latency accepted as a detection */
+#define BENCH_DETECT_NS         (250 * MS)
+
+int app_main(void);
+
+/** A touch and what the application made of it */
+typedef struct {
+  uint64_t start;
+  uint64_t end;
+  uint64_t pressed;               /**< LED0 on, 0 if never */
+  uint64_t released;              /**< LED0 off, 0 if never */
+} BENCH_Touch_t;
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static BENCH_Touch_t touches[BENCH_TOUCHES];
+static uint32_t numTouches;
+static uint32_t falsePresses;
+static uint32_t falseReleases;
+static jmp_buf benchEnd;
+
+/***************************************************************************//**
+ * @brief
+ *   Attribute each LED0 change to a touch, or count it as false.
+ ******************************************************************************/
+static void ledChanged(int led, bool on, uint64_t ns)
+{
+  uint32_t i;
+
+  if (led != 0) {
+    return;
+  }
+  for (i = 0; i < numTouches; i++) {
+    if ((ns >= touches[i].start) && (ns < touches[i].end + BENCH_DETECT_NS)) {
+      break;
+    }
+  }
+  if (on) {
+    if ((i < numTouches) && (ns < touches[i].end) && !touches[i].pressed) {
+      touches[i].pressed = ns;
+    } else {
+      falsePresses++;
+    }
+  } else {
+    if ((i < numTouches) && (ns >= touches[i].end) && touches[i].pressed
+        && !touches[i].released) {
+      touches[i].released = ns;
+    } else {
+      falseReleases++;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Script a touch of BUTTON0.
+ ******************************************************************************/
+static void addTouch(uint64_t start, uint64_t duration)
+{
+  if (numTouches == BENCH_TOUCHES) {
+    return;
+  }
+  touches[numTouches].start = start;
+  touches[numTouches].end = start + duration;
+  SIM_AddTouch(inputs[BUTTON0_CHANNEL], start, start + duration, 5.0);
+  numTouches++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set up BUTTON0 and script its touches for a number of virtual seconds:
+ *   quick taps while active, then a long press after the idle timeout.
+ ******************************************************************************/
+static void script(uint64_t seconds)
+{
+  uint64_t t;
+
+  numTouches = 0;
+  falsePresses = 0;
+  falseReleases = 0;
+  memset(touches, 0, sizeof(touches));
+
+  SIM_Reset();
+  SIM_Seed(1);
+  SIM_SetElectrode(inputs[BUTTON0_CHANNEL], 10.0, 0.005, 0.02);
+  SIM_SetLedHook(ledChanged);
+
+  for (t = 1000 * MS; t + 9000 * MS <= seconds * 1000 * MS; t += 10000 * MS) {
+    addTouch(t, 150 * MS);
+    addTouch(t + 600 * MS, 300 * MS);
+    addTouch(t + 1500 * MS, 1200 * MS);
+    addTouch(t + 6000 * MS, 400 * MS);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Report the detection latency, the false events and the share of the
+ *   time the core was awake in EM0.
+ *
+ * @return
+ *   true if every touch was detected and released without false events.
+ ******************************************************************************/
+static bool report(uint64_t seconds, uint64_t awakeNs)
+{
+  uint64_t t;
+  uint64_t pressTotal = 0;
+  uint64_t pressMax = 0;
+  uint64_t releaseTotal = 0;
+  uint64_t releaseMax = 0;
+  uint32_t detected = 0;
+  uint32_t released = 0;
+  uint32_t i;
+
+  for (i = 0; i < numTouches; i++) {
+    if (touches[i].pressed) {
+      detected++;
+      t = touches[i].pressed - touches[i].start;
+      pressTotal += t;
+      pressMax = (t > pressMax) ? t : pressMax;
+    }
+    if (touches[i].released) {
+      released++;
+      t = touches[i].released - touches[i].end;
+      releaseTotal += t;
+      releaseMax = (t > releaseMax) ? t : releaseMax;
+    }
+  }
+
+  printf("virtual time        %llu s\n", (unsigned long long) seconds);
+  printf("touches             %lu, %lu detected, %lu released\n",
+         (unsigned long) numTouches, (unsigned long) detected,
+         (unsigned long) released);
+  printf("press latency       avg %.1f ms, max %.1f ms\n",
+         detected ? (double) pressTotal / detected / MS : 0.0,
+         (double) pressMax / MS);
+  printf("release latency     avg %.1f ms, max %.1f ms\n",
+         released ? (double) releaseTotal / released / MS : 0.0,
+         (double) releaseMax / MS);
+  printf("false presses       %lu\n", (unsigned long) falsePresses);
+  printf("false releases      %lu\n", (unsigned long) falseReleases);
+  printf("awake in EM0        %.1f %%\n",
+         100.0 * (double) awakeNs / (double) (seconds * 1000 * MS));
+
+  return (detected == numTouches) && (released == numTouches)
+         && (falsePresses == 0) && (falseReleases == 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the example application for a number of virtual seconds and report
+ *   the detection latency, the false events, the driver cost and the
+ *   energy accounting.
+ ******************************************************************************/
+bool BENCH_Example(uint64_t seconds)
+{
+  uint64_t hostNs;
+  uint64_t sleepNs;
+  uint32_t isrs;
+  bool passed;
+  CAPSENSE_Frame_t frame;
+  ENERGY_Report_t energy;
+  SCHED_SleepStats_t sleep;
+
+  script(seconds);
+  SIM_SetEnd(seconds * 1000 * MS, &benchEnd);
+  if (setjmp(benchEnd) == 0) {
+    app_main();
+  }
+
+  CAPSENSE_GetFrame(&frame);
+  ENERGY_GetReport(&energy);
+  SCHED_GetSleepStats(&sleep);
+  SIM_GetIsrStats(TIMER0_IRQn, &isrs, &hostNs);
+
+  sleepNs = SCHED_TICKS_TO_MS((uint64_t) sleep.em1Ticks + sleep.em2Ticks) * MS;
+  passed = report(seconds, seconds * 1000 * MS - sleepNs);
+  printf("frames              %lu\n", (unsigned long) frame.frame);
+  printf("TIMER0 interrupts   %lu, %.0f host ns each, %.0f host ns per frame\n",
+         (unsigned long) isrs, isrs ? (double) hostNs / isrs : 0.0,
+         frame.frame ? (double) hostNs / frame.frame : 0.0);
+  printf("sleep               %lu ms in EM1, %lu ms in EM2\n",
+         (unsigned long) SCHED_TICKS_TO_MS(sleep.em1Ticks),
+         (unsigned long) SCHED_TICKS_TO_MS(sleep.em2Ticks));
+  printf("wakeups             %lu scheduler, %lu capsense in the last period\n",
+         (unsigned long) energy.schedWakeups,
+         (unsigned long) energy.capsenseWakeups);
+  printf("cpu                 %lu permille\n", (unsigned long) energy.cpuPermille);
+  printf("average current     %lu nA, %lu nA sensing\n",
+         (unsigned long) energy.averageNa, (unsigned long) energy.sensingNa);
+  return passed;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the main loop of the original example on the same touches: a busy
+ *   wait of 100 ms on the SysTick, a scan, and the LEDs set from the raw
+ *   pressed states. The busy wait keeps the core awake in EM0, only the
+ *   scans sleep in EM1.
+ ******************************************************************************/
+bool BENCH_DelayLoop(uint64_t seconds)
+{
+  uint64_t awakeNs = 0;
+
+  script(seconds);
+  BSP_LedsInit();
+  CAPSENSE_Init();
+
+  while (SIM_Now() < seconds * 1000 * MS) {
+    // Delay(100)
+    SIM_Run(100 * MS);
+    awakeNs += 100 * MS;
+
+    CAPSENSE_Sense();
+
+    if (CAPSENSE_getPressed(BUTTON0_CHANNEL)) {
+      BSP_LedSet(0);
+    } else {
+      BSP_LedClear(0);
+    }
+  }
+  return report(seconds, awakeNs);
+}
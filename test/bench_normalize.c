@@ -0,0 +1,134 @@
+/***************************************************************************//**
+ * @file
+ * @brief Benchmark section comparing reciprocal normalization with division
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capsense.h"
+#include "bench.h"
+
+/* Contexts of 8, 16 and 32 channels get a batch of counts with one touched
+ * channel in eight. CAPSENSE_CtxGetNormalizedVal(), which multiplies by the
+ * packed reciprocal of the baseline, is timed against the same frame read
+ * through CAPSENSE_CtxGetVal() followed by the division of the original
+ * driver. Both read the frame the same way, so the difference is the cost
+ * of the normalization. The results must be bit exact. */
+
+#define BENCH_CALLS             2000000UL
+
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+static CAPSENSE_Frame_t frame;
+static volatile uint32_t sink;
+
+/***************************************************************************//**
+ * @brief
+ *   The normalization of the original driver.
+ ******************************************************************************/
+__attribute__((noinline)) static uint32_t divideNormalized(uint8_t channel)
+{
+  return (CAPSENSE_CtxGetVal(&ctx, channel) << 8) / frame.maxValues[channel];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Time one way of normalizing all channels, in ns per call.
+ ******************************************************************************/
+static double timeCalls(bool reciprocal, uint8_t channels)
+{
+  uint64_t start;
+  uint32_t sum = 0;
+  uint32_t i;
+  uint8_t channel;
+
+  start = BENCH_HostNs();
+  for (i = 0; i < BENCH_CALLS / channels; i++) {
+    for (channel = 0; channel < channels; channel++) {
+      sum += reciprocal ? CAPSENSE_CtxGetNormalizedVal(&ctx, channel)
+             : divideNormalized(channel);
+    }
+  }
+  sink = sum;
+  return (double) (BENCH_HostNs() - start) / (double) BENCH_CALLS;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the comparison for 8, 16 and 32 channels.
+ ******************************************************************************/
+bool BENCH_Normalize(uint64_t seconds)
+{
+  static const uint8_t counts[] = { 8, 16, 32 };
+  uint32_t mismatches = 0;
+  uint32_t n;
+  uint32_t s;
+  uint8_t channels;
+  uint8_t channel;
+
+  (void) seconds;
+  printf("channels   reciprocal ns/call   division ns/call\n");
+  for (n = 0; n < sizeof(counts) / sizeof(counts[0]); n++) {
+    channels = counts[n];
+    if (channels > CAPSENSE_MAX_CHANNELS) {
+      break;
+    }
+    CAPSENSE_CtxInit(&ctx, NULL, NULL, state, channels);
+    memset(&batch, 0, sizeof(batch));
+    batch.frames = CAPSENSE_BATCH_FRAMES;
+    for (channel = 0; channel < channels; channel++) {
+      for (s = 0; s < batch.frames; s++) {
+        batch.counts[channel][s] = (uint16_t) (250 + 13 * channel);
+      }
+      if ((channel % 8) == 3) {
+        batch.counts[channel][batch.frames - 1] /= 2;
+      }
+    }
+    CAPSENSE_CtxProcessBatch(&ctx, &batch);
+    CAPSENSE_CtxGetFrame(&ctx, &frame);
+
+    for (channel = 0; channel < channels; channel++) {
+      if (CAPSENSE_CtxGetNormalizedVal(&ctx, channel)
+          != divideNormalized(channel)) {
+        mismatches++;
+      }
+    }
+    printf("%8u   %18.2f   %16.2f\n", channels, timeCalls(true, channels),
+           timeCalls(false, channels));
+  }
+  printf("mismatches          %lu\n", (unsigned long) mismatches);
+  return mismatches == 0;
+}
@@ -0,0 +1,133 @@
+/***************************************************************************//**
+ * @file
+ * @brief Benchmark section of the scan tables
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "bench.h"
+
+/* A context of 20 channels on ACMP0 is scanned with all channels in use,
+ * then masked down to 2 of them. The scan table only holds the channels in
+ * use, so the masked scan must take one TIMER0 interrupt per channel plus
+ * the one starting the scan, and the interrupt must cost the same whatever
+ * the number of unused channels. Host ns per interrupt stand in for the
+ * handler cycles, which the simulator does not count; they only compare the
+ * two contexts. */
+
+#define BENCH_SCAN_CHANNELS     20
+#define BENCH_SCAN_SCANS        2000
+
+static const ACMP_Channel_TypeDef channels[BENCH_SCAN_CHANNELS] = {
+  acmpInputPA0, acmpInputPA1, acmpInputPA2, acmpInputPA3, acmpInputPA4,
+  acmpInputPA5, acmpInputPA6, acmpInputPB0, acmpInputPB1, acmpInputPB2,
+  acmpInputPB3, acmpInputPB4, acmpInputPC0, acmpInputPC1, acmpInputPC2,
+  acmpInputPC3, acmpInputPC4, acmpInputPC5, acmpInputPC6, acmpInputPC7
+};
+static const CAPSENSE_BusAlloc_t busAlloc = {
+  .abus = GPIO_ABUSALLOC_AEVEN0_ACMP0 | GPIO_ABUSALLOC_AODD0_ACMP0,
+  .bbus = GPIO_BBUSALLOC_BEVEN0_ACMP0 | GPIO_BBUSALLOC_BODD0_ACMP0,
+  .cdbus = GPIO_CDBUSALLOC_CDEVEN0_ACMP0 | GPIO_CDBUSALLOC_CDODD0_ACMP0,
+};
+static bool sparse[BENCH_SCAN_CHANNELS];
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[BENCH_SCAN_CHANNELS];
+
+/***************************************************************************//**
+ * @brief
+ *   Scan the context and report the interrupts and their cost.
+ *
+ * @return
+ *   The number of TIMER0 interrupts per scan, or 0 if a scan failed.
+ ******************************************************************************/
+static uint32_t scans(const char *name, uint8_t inUse)
+{
+  uint32_t countBefore;
+  uint32_t countAfter;
+  uint64_t hostBefore;
+  uint64_t hostAfter;
+  uint64_t start;
+  uint32_t interrupts;
+  uint32_t i;
+
+  SIM_GetIsrStats(TIMER0_IRQn, &countBefore, &hostBefore);
+  start = SIM_Now();
+  for (i = 0; i < BENCH_SCAN_SCANS; i++) {
+    if (!CAPSENSE_CtxSense(&ctx)) {
+      return 0;
+    }
+  }
+  SIM_GetIsrStats(TIMER0_IRQn, &countAfter, &hostAfter);
+  interrupts = countAfter - countBefore;
+
+  printf("%-19s %u channels, %.1f interrupts per scan, "
+         "%.1f host ns per interrupt, %.1f us per channel\n", name,
+         (unsigned int) inUse, (double) interrupts / BENCH_SCAN_SCANS,
+         (double) (hostAfter - hostBefore) / interrupts,
+         (double) (SIM_Now() - start) / 1000.0
+         / ((double) BENCH_SCAN_SCANS * inUse));
+  return interrupts / BENCH_SCAN_SCANS;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Compare the dense and the masked scans of the same context.
+ ******************************************************************************/
+bool BENCH_Scan(uint64_t seconds)
+{
+  uint32_t dense;
+  uint32_t masked;
+  uint8_t channel;
+
+  (void) seconds;
+  SIM_Reset();
+  for (channel = 0; channel < BENCH_SCAN_CHANNELS; channel++) {
+    SIM_SetElectrode(channels[channel], 10.0 + channel, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  CAPSENSE_CtxInit(&ctx, channels, NULL, state, BENCH_SCAN_CHANNELS);
+  CAPSENSE_CtxSetBusAlloc(&ctx, &busAlloc);
+
+  dense = scans("all channels", BENCH_SCAN_CHANNELS);
+  memset(sparse, 0, sizeof(sparse));
+  sparse[3] = true;
+  sparse[17] = true;
+  CAPSENSE_CtxSetChannelMask(&ctx, sparse);
+  masked = scans("masked channels", 2);
+
+  return (dense == BENCH_SCAN_CHANNELS + 1) && (masked == 2 + 1);
+}
@@ -0,0 +1,181 @@
+/***************************************************************************//**
+ * @file
+ * @brief Benchmark section of the wake on touch scans
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capsense.h"
+#include "capsenseconfig.h"
+#include "energy.h"
+#include "sim.h"
+#include "bench.h"
+
+/* The idle application scans every BENCH_WAKE_PERIOD_MS while nothing is
+ * touched, either with full scans or with wake on touch scans. The core
+ * sleeps in EM2 between scans and in EM1 during them, and runs in EM0 for
+ * the interrupts. The duty cycle is the share of the time a scan runs, the
+ * current adds up the ENERGY_CURRENTS_DEFAULT figures of each state and
+ * each sensing peripheral the way energy.c does. */
+
+#define BENCH_WAKE_PERIOD_MS    100
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+static volatile bool done;
+static volatile bool touched;
+
+static void scanComplete(void)
+{
+  done = true;
+}
+
+static void wakeComplete(bool wakeTouched)
+{
+  touched = wakeTouched;
+  done = true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of interrupts taken by the driver so far.
+ ******************************************************************************/
+static uint32_t interrupts(void)
+{
+  static const IRQn_Type irqs[] = { TIMER0_IRQn, TIMER1_IRQn, TIMER2_IRQn };
+  uint32_t total = 0;
+  uint32_t count;
+  uint64_t hostNs;
+  unsigned int i;
+
+  for (i = 0; i < sizeof(irqs) / sizeof(irqs[0]); i++) {
+    SIM_GetIsrStats(irqs[i], &count, &hostNs);
+    total += count;
+  }
+  return total;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan idle channels for a number of virtual seconds and report the duty
+ *   cycle, the interrupts and the average current.
+ *
+ * @return
+ *   The average current in nA, or 0 if a scan failed.
+ ******************************************************************************/
+static uint32_t idle(const char *name, uint64_t seconds, bool wake)
+{
+  static const ENERGY_Currents_t currents = ENERGY_CURRENTS_DEFAULT;
+  CAPSENSE_MeasureTicks_t before;
+  CAPSENSE_MeasureTicks_t after;
+  uint64_t activeNs = 0;
+  uint64_t start;
+  uint64_t end = SIM_Now() + seconds * 1000 * BENCH_MS;
+  uint32_t scans = 0;
+  uint32_t isrs = interrupts();
+  double hz = CAPSENSE_GetMeasureTickHz();
+  double totalUs;
+  double em0Us;
+  double em1Us;
+  double sensing;
+  double charge;
+
+  CAPSENSE_GetMeasureTicks(&before);
+  while (SIM_Now() < end) {
+    start = SIM_Now();
+    done = false;
+    if (wake) {
+      if (!CAPSENSE_StartWakeScan(wakeComplete)) {
+        return 0;
+      }
+    } else {
+      if (!CAPSENSE_StartScan(scanComplete)) {
+        return 0;
+      }
+    }
+    if (!SIM_RunUntil(&done, 10 * BENCH_MS) || (wake && touched)) {
+      return 0;
+    }
+    activeNs += SIM_Now() - start;
+    scans++;
+    SIM_Run(start + BENCH_WAKE_PERIOD_MS * BENCH_MS - SIM_Now());
+  }
+  CAPSENSE_GetMeasureTicks(&after);
+  isrs = interrupts() - isrs;
+
+  totalUs = (double) seconds * 1e6;
+  em0Us = (double) isrs * SIM_ISR_CYCLES * 1e6 / SIM_HFCLK_HZ;
+  em1Us = (double) activeNs / 1000.0 - em0Us;
+  sensing = ((after.acmp - before.acmp) * (double) currents.acmp
+             + (after.timer0 - before.timer0) * (double) currents.timer0
+             + (after.timer1 - before.timer1) * (double) currents.timer1
+             + (after.prs - before.prs) * (double) currents.prs) * 1e6 / hz;
+  charge = em0Us * currents.em0 + em1Us * currents.em1
+           + (totalUs - em0Us - em1Us) * currents.em2 + sensing;
+
+  printf("%-19s %.3f %% duty, %.1f us per scan, %.1f interrupts per scan, "
+         "%.0f nA\n", name, 100.0 * (double) activeNs / (totalUs * 1000.0),
+         (double) activeNs / scans / 1000.0, (double) isrs / scans,
+         charge * 1000.0 / totalUs);
+  return (uint32_t) (charge * 1000.0 / totalUs);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Compare the idle scans and check that a touch still wakes up.
+ ******************************************************************************/
+bool BENCH_Wake(uint64_t seconds)
+{
+  uint32_t full;
+  uint32_t wake;
+
+  SIM_Reset();
+  SIM_SetElectrode(inputs[0], 10.0, 0.0, 0.0);
+  CAPSENSE_Init();
+  CAPSENSE_Sense();
+
+  full = idle("idle full scans", seconds, false);
+  wake = idle("idle wake scans", seconds, true);
+
+  SIM_AddTouch(inputs[0], SIM_Now(), SIM_Now() + 100 * BENCH_MS, 5.0);
+  done = false;
+  touched = false;
+  if (!CAPSENSE_StartWakeScan(wakeComplete)
+      || !SIM_RunUntil(&done, 10 * BENCH_MS)) {
+    return false;
+  }
+  printf("touch wakes up      %s\n", touched ? "yes" : "no");
+
+  return (full != 0) && (wake != 0) && (wake < full) && touched;
+}
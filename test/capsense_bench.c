@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ * @file
+ * @brief Benchmark of the capsense drivers on the simulated peripherals
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+/* Usage: capsense_bench [seconds] [section...]
+ *
+ * Runs the named sections, or all of them, for the given number of virtual
+ * seconds where that applies. */
+
+static const BENCH_Section_t sections[] = {
+  { "example", BENCH_Example },
+  { "delay", BENCH_DelayLoop },
+  { "normalize", BENCH_Normalize },
+  { "centroid", BENCH_Centroid },
+  { "wake", BENCH_Wake },
+  { "scan", BENCH_Scan },
+  { "batch", BENCH_Batch },
+};
+
+#define BENCH_SECTIONS          (sizeof(sections) / sizeof(sections[0]))
+
+/***************************************************************************//**
+ * @brief
+ *   Check whether a section was selected on the command line.
+ ******************************************************************************/
+static bool selected(const char *name, int argc, char **argv)
+{
+  int i;
+
+  if (argc <= 2) {
+    return true;
+  }
+  for (i = 2; i < argc; i++) {
+    if (strcmp(argv[i], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t seconds = (argc > 1) ? strtoull(argv[1], NULL, 10) : 60;
+  bool passed = true;
+  uint32_t run = 0;
+  uint32_t i;
+
+  for (i = 0; i < BENCH_SECTIONS; i++) {
+    if (!selected(sections[i].name, argc, argv)) {
+      continue;
+    }
+    run++;
+    printf("[%s]\n", sections[i].name);
+    if (!sections[i].run(seconds)) {
+      printf("%s FAILED\n", sections[i].name);
+      passed = false;
+    }
+    printf("\n");
+  }
+  if (run == 0) {
+    printf("no such section\n");
+    return EXIT_FAILURE;
+  }
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
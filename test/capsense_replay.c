@@ -0,0 +1,167 @@
+/***************************************************************************//**
+ * @file
+ * @brief Replay a capsense trace through the filter and baseline pipeline
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+/* Usage: capsense_replay <trace file>
+ *
+ * Decodes the bytes read with CAPSENSE_TraceRead() on the target and runs
+ * their raw samples through the filter and baseline pipeline of the host
+ * build of the drivers. Build it with the capsenseconfig.h of the target
+ * to reproduce its values, or with another configuration to see how it
+ * would have behaved. Prints a CSV line per channel and frame with the
+ * traced and the replayed value and baseline, and a summary on stderr. */
+
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+
+/***************************************************************************//**
+ * @brief
+ *   Read a whole file.
+ ******************************************************************************/
+static uint8_t *readFile(const char *path, size_t *size)
+{
+  FILE *file = fopen(path, "rb");
+  uint8_t *data = NULL;
+  size_t capacity = 0;
+  size_t n;
+
+  *size = 0;
+  if (file == NULL) {
+    return NULL;
+  }
+  do {
+    if (*size == capacity) {
+      capacity = capacity ? 2 * capacity : 65536;
+      data = realloc(data, capacity);
+      if (data == NULL) {
+        break;
+      }
+    }
+    n = fread(data + *size, 1, capacity - *size, file);
+    *size += n;
+  } while (n > 0);
+  fclose(file);
+  return data;
+}
+
+int main(int argc, char **argv)
+{
+  TRACE_Decoder_t decoder;
+  TRACE_Mismatches_t mismatches;
+  TRACE_Record_t *traced = NULL;
+  TRACE_Record_t *replayed;
+  uint8_t *data;
+  size_t size;
+  size_t pos = 0;
+  uint32_t count = 0;
+  uint32_t capacity = 0;
+  uint32_t i;
+  uint8_t channel;
+  int length;
+
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+    return 2;
+  }
+  data = readFile(argv[1], &size);
+  if (data == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  TRACE_DecoderInit(&decoder);
+  for (;;) {
+    if (count == capacity) {
+      capacity = capacity ? 2 * capacity : 1024;
+      traced = realloc(traced, capacity * sizeof(*traced));
+      if (traced == NULL) {
+        return 1;
+      }
+    }
+    length = TRACE_Decode(&decoder, data + pos, size - pos, &traced[count]);
+    if (length < 0) {
+      fprintf(stderr, "invalid record at byte %lu\n", (unsigned long) pos);
+      return 1;
+    }
+    if (length == 0) {
+      break;
+    }
+    pos += (size_t) length;
+    count++;
+  }
+  if (count == 0) {
+    fprintf(stderr, "no key frame in %lu bytes\n", (unsigned long) size);
+    return 1;
+  }
+
+  replayed = malloc(count * sizeof(*replayed));
+  if (replayed == NULL) {
+    return 1;
+  }
+  memcpy(replayed, traced, count * sizeof(*replayed));
+  CAPSENSE_CtxInit(&ctx, NULL, NULL, state, traced[0].channels);
+  TRACE_Replay(&ctx, &batch, replayed, count, &mismatches);
+
+  printf("timestamp,channel,raw,value,baseline,replayed value,replayed baseline\n");
+  for (i = 0; i < mismatches.records; i++) {
+    for (channel = 0; channel < traced[i].channels; channel++) {
+      printf("%lu,%u,%lu,%lu,%lu,%lu,%lu\n",
+             (unsigned long) traced[i].timestamp, channel,
+             (unsigned long) traced[i].raw[channel],
+             (unsigned long) traced[i].values[channel],
+             (unsigned long) traced[i].maxValues[channel],
+             (unsigned long) replayed[i].values[channel],
+             (unsigned long) replayed[i].maxValues[channel]);
+    }
+  }
+
+  fprintf(stderr, "%lu records, %lu skipped before the first key frame, "
+          "%lu trailing bytes\n", (unsigned long) count,
+          (unsigned long) decoder.skipped, (unsigned long) (size - pos));
+  fprintf(stderr, "%lu values and %lu baselines differ from the trace\n",
+          (unsigned long) mismatches.values,
+          (unsigned long) mismatches.maxValues);
+  free(replayed);
+  free(traced);
+  free(data);
+  return 0;
+}
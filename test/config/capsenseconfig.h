@@ -0,0 +1,112 @@
+/***************************************************************************//**
+ * @file
+ * @brief Capsense configuration of the host tests
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SILICON_LABS_CAPSENSCONFIG_H__
+#define __SILICON_LABS_CAPSENSCONFIG_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Four odd pins on the port C/D bus, which CAPSENSE_Init() allocates to
+ * ACMP0. Each test can override any setting with a compile definition. */
+#ifndef CAPSENSE_CHANNELS
+#define CAPSENSE_CHANNELS       { acmpInputPC1, acmpInputPC5, acmpInputPD1, acmpInputPD3 }
+#endif
+#define BUTTON0_CHANNEL         0
+#define BUTTON1_CHANNEL         1
+#define ACMP_CHANNELS           4
+#define NUM_SLIDER_CHANNELS     4
+
+#ifndef CAPSENSE_WINDOW_DEFAULT
+#define CAPSENSE_WINDOW_DEFAULT     10
+#endif
+#define CAPSENSE_WINDOW_MAX         100
+#define CAPSENSE_TUNE_MIN_DELTA     16
+#define CAPSENSE_TUNE_TOUCH_RATIO   32
+
+#define CAPSENSE_FREQ_LEVEL_SHIFT   6
+#define CAPSENSE_FREQ_NOISE_SHIFT   4
+
+#ifndef CAPSENSE_FILTER_OVERSAMPLE_SHIFT
+#define CAPSENSE_FILTER_OVERSAMPLE_SHIFT 0
+#endif
+
+#define CAPSENSE_BASELINE_SHIFT     6
+#define CAPSENSE_BASELINE_MAX_RISE  64
+#define CAPSENSE_BASELINE_MAX_FALL  16
+
+#define CAPSENSE_COMMON_MODE_TRIM_SHIFT 2
+#define CAPSENSE_COMMON_MODE_MIN_CHANNELS 3
+
+#define CAPSENSE_EVENT_QUEUE_SIZE   16
+#define CAPSENSE_DEBOUNCE_ATTACK    2
+#define CAPSENSE_DEBOUNCE_RELEASE   2
+#define CAPSENSE_LONG_PRESS_MS      1000
+
+#ifndef CAPSENSE_NO_SLIDER_MAP
+#define CAPSENSE_SLIDER_MAP          { 0, 1, 2, 3 }
+#endif
+#define CAPSENSE_CENTROID_THRESHOLD   32
+#define CAPSENSE_CENTROID_VALLEY      192
+
+#ifndef CAPSENSE_KEYPAD_MAX_ROWS
+#define CAPSENSE_KEYPAD_MAX_ROWS      4
+#define CAPSENSE_KEYPAD_MAX_COLUMNS   4
+#endif
+#define CAPSENSE_KEYPAD_FULL_SCAN_FRAMES 16
+
+#define CAPSENSE_PROXIMITY_WINDOW         200
+#define CAPSENSE_PROXIMITY_FRAMES         2
+#define CAPSENSE_PROXIMITY_BASELINE_SHIFT 8
+#define CAPSENSE_PROXIMITY_RANGE          64
+#define CAPSENSE_PROXIMITY_NEAR_LEVEL     64
+#define CAPSENSE_PROXIMITY_MAX_NEAR       256
+
+#define CAPSENSE_GESTURE_TAP_MS        200
+#define CAPSENSE_GESTURE_DOUBLE_TAP_MS 250
+#define CAPSENSE_GESTURE_HOLD_MS       500
+#define CAPSENSE_GESTURE_SWIPE_MS      600
+#define CAPSENSE_GESTURE_SWIPE_MIN     24
+
+#define CAPSENSE_BATCH_FRAMES     16
+
+#define DEBUG_ACMP0OUT_PORT     gpioPortC
+#define DEBUG_ACMP0OUT_PIN      3
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __SILICON_LABS_CAPSENSCONFIG_H__ */
@@ -0,0 +1,137 @@
+/***************************************************************************//**
+ * @file
+ * @brief Report of the SNR against the frame time of a filter configuration
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "capsense.h"
+#include "sim.h"
+
+/* Built once per filter configuration, see CMakeLists.txt. Channel 0 is a
+ * 10 pF electrode with 0.3 pF of noise, touched by 1 pF in the second half
+ * of each run. For each measurement window the report gives the frame
+ * time, which includes 2^CAPSENSE_FILTER_OVERSAMPLE_SHIFT windows of each
+ * channel, and the touch signal over the standard deviation of the idle
+ * values. */
+
+#define MS                      1000000ULL
+/** Values collected in each half of a run */
+#define SNR_VALUES              400
+/** Values left for the filter to settle at the start of each half */
+#define SNR_SETTLE              16
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return (uint32_t) (SIM_Now() / MS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Collect values of channel 0 and their mean and standard deviation.
+ *
+ * @return
+ *   The virtual time per frame in ns.
+ ******************************************************************************/
+static uint64_t collect(double *mean, double *deviation)
+{
+  double sum = 0.0;
+  double squares = 0.0;
+  double value;
+  uint64_t start = 0;
+  uint32_t i;
+
+  for (i = 0; i < SNR_SETTLE + SNR_VALUES; i++) {
+    if (i == SNR_SETTLE) {
+      start = SIM_Now();
+    }
+    CAPSENSE_Sense();
+    if (i >= SNR_SETTLE) {
+      value = CAPSENSE_getVal(0);
+      sum += value;
+      squares += value * value;
+    }
+  }
+  *mean = sum / SNR_VALUES;
+  *deviation = sqrt(squares / SNR_VALUES - *mean * *mean);
+  return (SIM_Now() - start) / SNR_VALUES;
+}
+
+int main(void)
+{
+  static const uint32_t windows[] = { 2, 5, 10, 20, 40 };
+  double idle;
+  double touched;
+  double noise;
+  double touchNoise;
+  double snr[sizeof(windows) / sizeof(windows[0])];
+  uint64_t frameNs;
+  uint32_t w;
+  int i;
+
+  printf("filter: oversample %u", 1U << CAPSENSE_FILTER_OVERSAMPLE_SHIFT);
+#if defined(CAPSENSE_FILTER_MEDIAN)
+  printf(", median of 3");
+#endif
+#if defined(CAPSENSE_FILTER_IIR_SHIFT)
+  printf(", IIR 1/%u", 1U << CAPSENSE_FILTER_IIR_SHIFT);
+#endif
+  printf("\nwindow   frame time   SNR\n");
+
+  for (w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+    SIM_Reset();
+    SIM_SetElectrode(inputs[0], 10.0, 0.0, 0.3);
+    for (i = 1; i < ACMP_CHANNELS; i++) {
+      SIM_SetElectrode(inputs[i], 10.0, 0.0, 0.0);
+    }
+    CAPSENSE_Init();
+    for (i = 0; i < ACMP_CHANNELS; i++) {
+      CAPSENSE_setWindow(i, windows[w]);
+    }
+
+    frameNs = collect(&idle, &noise);
+    SIM_AddTouch(inputs[0], SIM_Now(), UINT64_MAX, 1.0);
+    collect(&touched, &touchNoise);
+    snr[w] = (idle - touched) / noise;
+    printf("%6lu   %7.2f ms   %5.1f\n", (unsigned long) windows[w],
+           frameNs / 1e6, snr[w]);
+  }
+
+  // Longer windows average more of the noise
+  return (snr[w - 1] > snr[0]) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
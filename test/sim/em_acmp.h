@@ -0,0 +1,91 @@
+/***************************************************************************//**
+ * @file
+ * @brief Simulated emlib ACMP API for host builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SIM_EM_ACMP_H_
+#define __SIM_EM_ACMP_H_
+
+#include "em_device.h"
+#include "em_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** ACMP inputs, the port in bits 7:4 (A = 8) and the pin in bits 3:0 */
+typedef enum {
+  acmpInputPA0 = 0x80, acmpInputPA1, acmpInputPA2, acmpInputPA3,
+  acmpInputPA4, acmpInputPA5, acmpInputPA6,
+  acmpInputPB0 = 0x90, acmpInputPB1, acmpInputPB2, acmpInputPB3,
+  acmpInputPB4,
+  acmpInputPC0 = 0xA0, acmpInputPC1, acmpInputPC2, acmpInputPC3,
+  acmpInputPC4, acmpInputPC5, acmpInputPC6, acmpInputPC7,
+  acmpInputPD0 = 0xB0, acmpInputPD1, acmpInputPD2, acmpInputPD3,
+  acmpInputPD4
+} ACMP_Channel_TypeDef;
+
+typedef enum {
+  acmpResistor0, acmpResistor1, acmpResistor2, acmpResistor3,
+  acmpResistor4, acmpResistor5, acmpResistor6, acmpResistor7
+} ACMP_CapsenseResistor_TypeDef;
+
+typedef enum {
+  acmpHysteresisDisabled,
+  acmpHysteresis10Sym
+} ACMP_HysteresisLevel_TypeDef;
+
+typedef struct {
+  bool fullBias;
+  uint32_t biasProg;
+  ACMP_HysteresisLevel_TypeDef hysteresisLevel;
+  ACMP_CapsenseResistor_TypeDef resistor;
+  uint32_t vrefDiv;
+  bool enable;
+} ACMP_CapsenseInit_TypeDef;
+
+#define ACMP_CAPSENSE_INIT_DEFAULT \
+  { false, 0x07, acmpHysteresisDisabled, acmpResistor5, 0x3F, true }
+
+void ACMP_CapsenseInit(ACMP_TypeDef *acmp,
+                       const ACMP_CapsenseInit_TypeDef *init);
+void ACMP_CapsenseChannelSet(ACMP_TypeDef *acmp, ACMP_Channel_TypeDef input);
+void ACMP_Enable(ACMP_TypeDef *acmp);
+void ACMP_Disable(ACMP_TypeDef *acmp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_EM_ACMP_H_ */
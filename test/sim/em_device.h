@@ -0,0 +1,183 @@
+/***************************************************************************//**
+ * @file
+ * @brief Simulated EFR32xG21 device header for host builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SIM_EM_DEVICE_H_
+#define __SIM_EM_DEVICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The registers used by the drivers, backed by sim.c. Only the fields the
+ * drivers touch are modeled, the peripheral behaviour lives in the
+ * emlib functions and the event loop of the simulator. */
+
+/** Interrupts of the simulated peripherals */
+typedef enum {
+  TIMER0_IRQn,
+  LDMA_IRQn,
+  RTCC_IRQn,
+  TIMER1_IRQn,
+  TIMER2_IRQn,
+  SIM_IRQ_COUNT
+} IRQn_Type;
+
+typedef struct {
+  volatile uint32_t EN;
+  volatile uint32_t CFG;
+  volatile uint32_t INPUTCTRL;
+  volatile uint32_t STATUS;
+} ACMP_TypeDef;
+
+typedef struct {
+  volatile uint32_t EN;
+  volatile uint32_t CFG;
+  volatile uint32_t IF;
+  volatile uint32_t IEN;
+  volatile uint32_t TOP;
+  volatile uint32_t TOPB;
+  volatile uint32_t CNT;
+} TIMER_TypeDef;
+
+typedef struct {
+  volatile uint32_t ROUTEEN;
+  volatile uint32_t ACMPOUTROUTE;
+} GPIO_ACMPROUTE_TypeDef;
+
+typedef struct {
+  volatile uint32_t ABUSALLOC;
+  volatile uint32_t BBUSALLOC;
+  volatile uint32_t CDBUSALLOC;
+  GPIO_ACMPROUTE_TypeDef ACMPROUTE[2];
+} GPIO_TypeDef;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern ACMP_TypeDef SIM_ACMP[2];
+extern TIMER_TypeDef SIM_TIMER[3];
+extern GPIO_TypeDef SIM_GPIO;
+extern DWT_Type SIM_DWT;
+extern CoreDebug_Type SIM_CoreDebug;
+
+#define ACMP0                   (&SIM_ACMP[0])
+#define ACMP1                   (&SIM_ACMP[1])
+#define TIMER0                  (&SIM_TIMER[0])
+#define TIMER1                  (&SIM_TIMER[1])
+#define TIMER2                  (&SIM_TIMER[2])
+#define GPIO                    (&SIM_GPIO)
+#define DWT                     (&SIM_DWT)
+#define CoreDebug               (&SIM_CoreDebug)
+
+#define DWT_CTRL_CYCCNTENA_Msk          0x1UL
+#define CoreDebug_DEMCR_TRCENA_Msk      0x1000000UL
+
+#define _ACMP_INPUTCTRL_POSSEL_SHIFT    0
+#define _ACMP_INPUTCTRL_POSSEL_MASK     0xFFUL
+#define _ACMP_INPUTCTRL_NEGSEL_SHIFT    8
+#define _ACMP_INPUTCTRL_NEGSEL_MASK     0xFF00UL
+#define ACMP_INPUTCTRL_NEGSEL_CAPSENSE  (0xF0UL << 8)
+#define _ACMP_INPUTCTRL_CSRESSEL_SHIFT  28
+#define _ACMP_INPUTCTRL_CSRESSEL_MASK   0x70000000UL
+
+#define TIMER_IF_OF                     0x1UL
+#define TIMER_IF_CC0                    0x10UL
+#define TIMER_IEN_OF                    0x1UL
+#define TIMER_IEN_CC0                   0x10UL
+
+/* Each analog bus half has a field per even/odd pin group, 1 connects it
+ * to ACMP0 and 2 to ACMP1 */
+#define _GPIO_BUSALLOC_EVEN0_SHIFT      0
+#define _GPIO_BUSALLOC_EVEN1_SHIFT      8
+#define _GPIO_BUSALLOC_ODD0_SHIFT       16
+#define _GPIO_BUSALLOC_ODD1_SHIFT       24
+#define GPIO_ABUSALLOC_AEVEN0_ACMP0     (0x1UL << _GPIO_BUSALLOC_EVEN0_SHIFT)
+#define GPIO_ABUSALLOC_AODD0_ACMP0      (0x1UL << _GPIO_BUSALLOC_ODD0_SHIFT)
+#define GPIO_ABUSALLOC_AEVEN0_ACMP1     (0x2UL << _GPIO_BUSALLOC_EVEN0_SHIFT)
+#define GPIO_ABUSALLOC_AODD0_ACMP1      (0x2UL << _GPIO_BUSALLOC_ODD0_SHIFT)
+#define GPIO_BBUSALLOC_BEVEN0_ACMP0     (0x1UL << _GPIO_BUSALLOC_EVEN0_SHIFT)
+#define GPIO_BBUSALLOC_BODD0_ACMP0      (0x1UL << _GPIO_BUSALLOC_ODD0_SHIFT)
+#define GPIO_BBUSALLOC_BEVEN0_ACMP1     (0x2UL << _GPIO_BUSALLOC_EVEN0_SHIFT)
+#define GPIO_BBUSALLOC_BODD0_ACMP1      (0x2UL << _GPIO_BUSALLOC_ODD0_SHIFT)
+#define GPIO_CDBUSALLOC_CDEVEN0_ACMP0   (0x1UL << _GPIO_BUSALLOC_EVEN0_SHIFT)
+#define GPIO_CDBUSALLOC_CDODD0_ACMP0    (0x1UL << _GPIO_BUSALLOC_ODD0_SHIFT)
+#define GPIO_CDBUSALLOC_CDEVEN0_ACMP1   (0x2UL << _GPIO_BUSALLOC_EVEN0_SHIFT)
+#define GPIO_CDBUSALLOC_CDODD0_ACMP1    (0x2UL << _GPIO_BUSALLOC_ODD0_SHIFT)
+#define GPIO_CDBUSALLOC_CDEVEN1_ACMP1   (0x2UL << _GPIO_BUSALLOC_EVEN1_SHIFT)
+#define GPIO_CDBUSALLOC_CDODD1_ACMP1    (0x2UL << _GPIO_BUSALLOC_ODD1_SHIFT)
+#define _GPIO_ACMP_ACMPOUTROUTE_PORT_SHIFT  0
+#define _GPIO_ACMP_ACMPOUTROUTE_PIN_SHIFT   16
+
+/** Simulated flash, the calibration page lives at its end */
+extern uint32_t SIM_Flash[];
+#define FLASH_PAGE_SIZE         0x2000UL
+#define FLASH_SIZE              (4 * FLASH_PAGE_SIZE)
+#define FLASH_BASE              ((uintptr_t) SIM_Flash)
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+
+/* The simulated interrupts run on the thread they interrupt, so a barrier
+ * only has to keep the compiler from moving accesses across it. */
+static inline void __DMB(void)
+{
+  __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t __CLZ(uint32_t x)
+{
+  return (x == 0) ? 32 : (uint32_t) __builtin_clz(x);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_EM_DEVICE_H_ */
@@ -0,0 +1,132 @@
+/***************************************************************************//**
+ * @file
+ * @brief Simulated emlib LDMA definitions for host builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SIM_EM_LDMA_H_
+#define __SIM_EM_LDMA_H_
+
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** LDMA descriptor, the layout of the hardware */
+typedef union {
+  struct {
+    uint32_t structType   : 2;
+    uint32_t reserved0    : 1;
+    uint32_t structReq    : 1;
+    uint32_t xferCnt      : 11;
+    uint32_t byteSwap     : 1;
+    uint32_t blockSize    : 4;
+    uint32_t doneIfs      : 1;
+    uint32_t reqMode      : 1;
+    uint32_t decLoopCnt   : 1;
+    uint32_t ignoreSrec   : 1;
+    uint32_t srcInc       : 2;
+    uint32_t size         : 2;
+    uint32_t dstInc       : 2;
+    uint32_t srcAddrMode  : 1;
+    uint32_t dstAddrMode  : 1;
+    uint32_t srcAddr;
+    uint32_t dstAddr;
+    uint32_t linkMode     : 1;
+    uint32_t link         : 1;
+    int32_t  linkAddr     : 30;
+  } xfer;
+  uint32_t w[4];
+} LDMA_Descriptor_t;
+
+enum { ldmaCtrlStructTypeXfer, ldmaCtrlStructTypeSync, ldmaCtrlStructTypeWrite };
+enum { ldmaCtrlBlockSizeUnit1 };
+enum { ldmaCtrlReqModeBlock, ldmaCtrlReqModeAll };
+enum { ldmaCtrlSrcIncOne, ldmaCtrlSrcIncTwo, ldmaCtrlSrcIncFour, ldmaCtrlSrcIncNone };
+enum { ldmaCtrlDstIncOne, ldmaCtrlDstIncTwo, ldmaCtrlDstIncFour, ldmaCtrlDstIncNone };
+enum { ldmaCtrlSizeByte, ldmaCtrlSizeHalf, ldmaCtrlSizeWord };
+enum { ldmaCtrlSrcAddrModeAbs, ldmaCtrlSrcAddrModeRel };
+enum { ldmaCtrlDstAddrModeAbs, ldmaCtrlDstAddrModeRel };
+enum { ldmaLinkModeAbs, ldmaLinkModeRel };
+
+#define SIM_LDMA_CHANNELS       8
+
+typedef struct {
+  volatile uint32_t REQSEL;
+} LDMAXBAR_CH_TypeDef;
+
+typedef struct {
+  LDMAXBAR_CH_TypeDef CH[SIM_LDMA_CHANNELS];
+} LDMAXBAR_TypeDef;
+
+typedef struct {
+  volatile uint32_t CFG;
+  volatile uint32_t LOOP;
+  volatile uint32_t CTRL;
+  volatile uint32_t SRC;
+  volatile uint32_t DST;
+  volatile uint32_t LINK;
+} LDMA_CH_TypeDef;
+
+typedef struct {
+  volatile uint32_t EN;
+  volatile uint32_t CTRL;
+  volatile uint32_t CHEN;
+  volatile uint32_t CHDIS;
+  volatile uint32_t CHDONE;
+  volatile uint32_t LINKLOAD;
+  volatile uint32_t REQCLEAR;
+  volatile uint32_t IF;
+  volatile uint32_t IEN;
+  volatile uint32_t IF_CLR;
+  volatile uint32_t IF_SET;
+  LDMA_CH_TypeDef CH[SIM_LDMA_CHANNELS];
+} LDMA_TypeDef;
+
+extern LDMA_TypeDef SIM_LDMA;
+extern LDMAXBAR_TypeDef SIM_LDMAXBAR;
+
+#define LDMA                    (&SIM_LDMA)
+#define LDMAXBAR                (&SIM_LDMAXBAR)
+
+#define LDMA_EN_EN                              0x1UL
+#define _LDMA_CH_LINK_LINKADDR_MASK             0xFFFFFFFCUL
+#define LDMAXBAR_CH_REQSEL_SIGSEL_TIMER0UFOF    0x0UL
+#define LDMAXBAR_CH_REQSEL_SOURCESEL_TIMER0     0x10000UL
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_EM_LDMA_H_ */
@@ -0,0 +1,64 @@
+/***************************************************************************//**
+ * @file
+ * @brief Simulated emlib PRS API for host builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SIM_EM_PRS_H_
+#define __SIM_EM_PRS_H_
+
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  prsTypeAsync,
+  prsTypeSync
+} PRS_ChType_t;
+
+typedef enum {
+  prsSignalNone,
+  prsSignalACMP0_OUT,
+  prsSignalACMP1_OUT
+} PRS_Signal_t;
+
+void PRS_ConnectSignal(unsigned int ch, PRS_ChType_t type,
+                       PRS_Signal_t signal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_EM_PRS_H_ */
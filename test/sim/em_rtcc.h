@@ -0,0 +1,79 @@
+/***************************************************************************//**
+ * @file
+ * @brief Simulated emlib RTCC API for host builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SIM_EM_RTCC_H_
+#define __SIM_EM_RTCC_H_
+
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  rtccCntPresc_1, rtccCntPresc_2, rtccCntPresc_4, rtccCntPresc_8,
+  rtccCntPresc_16, rtccCntPresc_32
+} RTCC_CntPresc_TypeDef;
+
+typedef struct {
+  bool enable;
+  bool debugRun;
+  RTCC_CntPresc_TypeDef presc;
+} RTCC_Init_TypeDef;
+
+#define RTCC_INIT_DEFAULT { true, false, rtccCntPresc_32 }
+
+typedef struct {
+  int chMode;
+} RTCC_CCChConf_TypeDef;
+
+#define RTCC_CH_INIT_COMPARE_DEFAULT { 1 }
+
+#define RTCC_IF_CC1             0x4UL
+#define RTCC_IEN_CC1            0x4UL
+
+void RTCC_Init(const RTCC_Init_TypeDef *init);
+void RTCC_ChannelInit(int ch, const RTCC_CCChConf_TypeDef *conf);
+void RTCC_ChannelCCVSet(int ch, uint32_t value);
+uint32_t RTCC_CounterGet(void);
+void RTCC_IntClear(uint32_t flags);
+void RTCC_IntEnable(uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_EM_RTCC_H_ */
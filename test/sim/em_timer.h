@@ -0,0 +1,122 @@
+/***************************************************************************//**
+ * @file
+ * @brief Simulated emlib TIMER API for host builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SIM_EM_TIMER_H_
+#define __SIM_EM_TIMER_H_
+
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  timerPrescale1, timerPrescale2, timerPrescale4, timerPrescale8,
+  timerPrescale16, timerPrescale32, timerPrescale64, timerPrescale128,
+  timerPrescale256, timerPrescale512, timerPrescale1024
+} TIMER_Prescale_TypeDef;
+
+typedef enum {
+  timerClkSelHFPerClk,
+  timerClkSelCC1,
+  timerClkSelCascade
+} TIMER_ClkSel_TypeDef;
+
+typedef enum {
+  timerEdgeRising, timerEdgeFalling, timerEdgeBoth, timerEdgeNone
+} TIMER_Edge_TypeDef;
+
+typedef enum {
+  timerEventEveryEdge, timerEventEvery2ndEdge, timerEventRising,
+  timerEventFalling
+} TIMER_Event_TypeDef;
+
+typedef enum {
+  timerCCModeOff, timerCCModeCapture, timerCCModeCompare, timerCCModePWM
+} TIMER_CCMode_TypeDef;
+
+typedef enum {
+  timerPrsInputNone, timerPrsInputSync, timerPrsInputAsyncLevel,
+  timerPrsInputAsyncPulse
+} TIMER_PrsInput_TypeDef;
+
+typedef struct {
+  bool enable;
+  bool debugRun;
+  TIMER_Prescale_TypeDef prescale;
+  TIMER_ClkSel_TypeDef clkSel;
+  bool count2x;
+  bool ati;
+  bool oneShot;
+  bool sync;
+} TIMER_Init_TypeDef;
+
+#define TIMER_INIT_DEFAULT \
+  { true, false, timerPrescale1, timerClkSelHFPerClk, false, false, false, false }
+
+typedef struct {
+  TIMER_Event_TypeDef eventCtrl;
+  TIMER_Edge_TypeDef edge;
+  unsigned int prsSel;
+  TIMER_CCMode_TypeDef mode;
+  bool filter;
+  bool prsInput;
+  TIMER_PrsInput_TypeDef prsInputType;
+} TIMER_InitCC_TypeDef;
+
+#define TIMER_INITCC_DEFAULT \
+  { timerEventEveryEdge, timerEdgeRising, 0, timerCCModeOff, false, false, timerPrsInputNone }
+
+void TIMER_Init(TIMER_TypeDef *timer, const TIMER_Init_TypeDef *init);
+void TIMER_InitCC(TIMER_TypeDef *timer, unsigned int ch,
+                  const TIMER_InitCC_TypeDef *init);
+void TIMER_Enable(TIMER_TypeDef *timer, bool enable);
+void TIMER_TopSet(TIMER_TypeDef *timer, uint32_t val);
+void TIMER_TopBufSet(TIMER_TypeDef *timer, uint32_t val);
+uint32_t TIMER_TopGet(TIMER_TypeDef *timer);
+void TIMER_CounterSet(TIMER_TypeDef *timer, uint32_t val);
+uint32_t TIMER_CounterGet(TIMER_TypeDef *timer);
+void TIMER_CompareSet(TIMER_TypeDef *timer, unsigned int ch, uint32_t val);
+void TIMER_IntClear(TIMER_TypeDef *timer, uint32_t flags);
+void TIMER_IntEnable(TIMER_TypeDef *timer, uint32_t flags);
+void TIMER_IntDisable(TIMER_TypeDef *timer, uint32_t flags);
+uint32_t TIMER_IntGet(TIMER_TypeDef *timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_EM_TIMER_H_ */
@@ -0,0 +1,1270 @@
+/***************************************************************************//**
+ * @file
+ * @brief Peripheral simulator for host builds of the capsense drivers
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "em_device.h"
+#include "em_acmp.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_ldma.h"
+#include "em_msc.h"
+#include "em_prs.h"
+#include "em_rtcc.h"
+#include "em_timer.h"
+#include "bsp.h"
+#include "sim.h"
+
+/***************************************************************************//**
+ * @addtogroup Simulator
+ * @{
+ ******************************************************************************/
+
+#define SIM_TIMERS              3
+#define SIM_ACMPS               2
+#define SIM_PRS_CHANNELS        8
+#define SIM_ELECTRODES          32
+#define SIM_TOUCHES             256
+#define SIM_LEDS                2
+#define SIM_NO_EVENT            UINT64_MAX
+
+/** A scripted electrode */
+typedef struct {
+  uint32_t input;
+  double basePf;
+  double driftPfPerS;
+  double noisePf;
+} SIM_Electrode_t;
+
+/** A scripted touch adding capacitance to an electrode */
+typedef struct {
+  uint32_t input;
+  uint64_t startNs;
+  uint64_t endNs;
+  double pf;
+} SIM_Touch_t;
+
+/** The state of a timer not held in its registers */
+typedef struct {
+  TIMER_Prescale_TypeDef prescale;
+  TIMER_ClkSel_TypeDef clkSel;
+  bool running;
+  bool topBuffered;               /**< TOPB is loaded at the next overflow */
+  uint32_t cc0;                   /**< CC0 compare value */
+  unsigned int prsSel;            /**< PRS channel of the CC1 input */
+  uint64_t refNs;                 /**< Time of the last counter update */
+  double phase;                   /**< Fraction of the next pulse */
+} SIM_Timer_t;
+
+/** The state of an LDMA channel not held in its registers */
+typedef struct {
+  bool active;
+  const LDMA_Descriptor_t *desc;  /**< The loaded descriptor */
+  uint32_t remaining;             /**< Units left in the descriptor */
+} SIM_LdmaChannel_t;
+
+ACMP_TypeDef SIM_ACMP[SIM_ACMPS];
+TIMER_TypeDef SIM_TIMER[SIM_TIMERS];
+GPIO_TypeDef SIM_GPIO;
+DWT_Type SIM_DWT;
+CoreDebug_Type SIM_CoreDebug;
+LDMA_TypeDef SIM_LDMA;
+LDMAXBAR_TypeDef SIM_LDMAXBAR;
+uint32_t SIM_Flash[FLASH_SIZE / sizeof(uint32_t)];
+
+static uint64_t simNow;
+static uint32_t primask;
+static bool inIsr;
+static bool nvicEnabled[SIM_IRQ_COUNT];
+static uint32_t isrCount[SIM_IRQ_COUNT];
+static uint64_t isrHostNs[SIM_IRQ_COUNT];
+static uint32_t isrCycles;
+
+static SIM_Timer_t timers[SIM_TIMERS];
+static uint64_t acmpEnableNs[SIM_ACMPS];
+static bool acmpCapsense[SIM_ACMPS];
+static int prsSource[SIM_PRS_CHANNELS];
+static SIM_LdmaChannel_t ldmaChannels[SIM_LDMA_CHANNELS];
+
+static struct {
+  uint32_t presc;
+  uint32_t ccv;
+  uint32_t flags;
+  uint32_t ien;
+  uint64_t offsetNs;              /**< Time lost to a stopped counter */
+} rtcc;
+
+static SIM_Waveform_t waveform;
+static SIM_Electrode_t electrodes[SIM_ELECTRODES];
+static uint32_t numElectrodes;
+static SIM_Touch_t touches[SIM_TOUCHES];
+static uint32_t numTouches;
+static uint32_t noiseSeed;
+
+static bool leds[SIM_LEDS];
+static SIM_LedHook_t ledHook;
+
+static uint64_t endNs = SIM_NO_EVENT;
+static jmp_buf *endJump;
+
+void TIMER0_IRQHandler(void);
+void LDMA_IRQHandler(void);
+void RTCC_IRQHandler(void);
+void TIMER1_IRQHandler(void);
+void TIMER2_IRQHandler(void);
+
+/***************************************************************************//**
+ * @brief
+ *   Default handlers of the interrupts the program under test does not use.
+ ******************************************************************************/
+__attribute__((weak)) void LDMA_IRQHandler(void)
+{
+  LDMA->IF = 0;
+}
+
+__attribute__((weak)) void RTCC_IRQHandler(void)
+{
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+__attribute__((weak)) void TIMER1_IRQHandler(void)
+{
+  TIMER1->IF = 0;
+}
+
+__attribute__((weak)) void TIMER2_IRQHandler(void)
+{
+  TIMER2->IF = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Virtual core cycles, so the capsense statistics match the target.
+ ******************************************************************************/
+uint32_t CAPSENSE_GetCycles(void)
+{
+  return (uint32_t) ((simNow * (SIM_HFCLK_HZ / 1000000)) / 1000)
+         + isrCycles;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Abort the program on a use of the peripherals the target would not
+ *   survive either.
+ ******************************************************************************/
+static void SIM_Fail(const char *message)
+{
+  fprintf(stderr, "sim: %s at %llu ns\n", message,
+          (unsigned long long) simNow);
+  abort();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert timer ticks to ns, rounded up.
+ ******************************************************************************/
+static uint64_t SIM_TicksToNs(uint64_t ticks, TIMER_Prescale_TypeDef prescale)
+{
+  uint64_t cycles = ticks << prescale;
+
+  return (cycles * 1000000000ULL + SIM_HFCLK_HZ - 1) / SIM_HFCLK_HZ;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Uniform hash of three words, used for repeatable noise.
+ ******************************************************************************/
+static uint32_t SIM_Hash(uint32_t a, uint32_t b, uint32_t c)
+{
+  uint32_t h = 2166136261UL ^ noiseSeed;
+  uint32_t words[3] = { a, b, c };
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    h ^= words[i];
+    h *= 16777619UL;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6DUL;
+    h ^= h >> 12;
+  }
+  return h;
+}
+
+double SIM_Gaussian(uint32_t input, uint64_t index)
+{
+  double u1 = (SIM_Hash(input, (uint32_t) index, 1) + 1.0) / 4294967297.0;
+  double u2 = SIM_Hash(input, (uint32_t) (index >> 32) ^ (uint32_t) index, 2)
+              / 4294967296.0;
+
+  return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+double SIM_Electrode(uint32_t input, uint64_t ns)
+{
+  double pf = 0.0;
+  uint32_t i;
+
+  for (i = 0; i < numElectrodes; i++) {
+    if (electrodes[i].input == input) {
+      pf = electrodes[i].basePf
+           + electrodes[i].driftPfPerS * ((double) ns / 1e9)
+           + electrodes[i].noisePf * SIM_Gaussian(input, ns / SIM_NOISE_HOLD_NS);
+      break;
+    }
+  }
+  if (i == numElectrodes) {
+    return 0.0;
+  }
+  for (i = 0; i < numTouches; i++) {
+    if ((touches[i].input == input)
+        && (ns >= touches[i].startNs) && (ns < touches[i].endNs)) {
+      pf += touches[i].pf;
+    }
+  }
+  return pf;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check that the analog bus of an input is allocated to an ACMP.
+ ******************************************************************************/
+static bool SIM_BusConnected(uint32_t input, int acmp)
+{
+  uint32_t port = (input >> 4) & 0xF;
+  uint32_t pin = input & 0xF;
+  uint32_t alloc;
+  uint32_t shift0 = (pin & 1) ? _GPIO_BUSALLOC_ODD0_SHIFT : _GPIO_BUSALLOC_EVEN0_SHIFT;
+  uint32_t shift1 = (pin & 1) ? _GPIO_BUSALLOC_ODD1_SHIFT : _GPIO_BUSALLOC_EVEN1_SHIFT;
+  uint32_t value = (uint32_t) acmp + 1;
+
+  switch (port) {
+    case 0x8:
+      alloc = GPIO->ABUSALLOC;
+      break;
+    case 0x9:
+      alloc = GPIO->BBUSALLOC;
+      break;
+    case 0xA:
+    case 0xB:
+      alloc = GPIO->CDBUSALLOC;
+      break;
+    default:
+      return false;
+  }
+  return (((alloc >> shift0) & 0xF) == value)
+         || (((alloc >> shift1) & 0xF) == value);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the pulse rate of an ACMP in Hz at a time.
+ ******************************************************************************/
+static double SIM_AcmpRate(int acmp, uint64_t ns)
+{
+  ACMP_TypeDef *regs = &SIM_ACMP[acmp];
+  uint32_t ctrl = regs->INPUTCTRL;
+  uint32_t input = (ctrl & _ACMP_INPUTCTRL_POSSEL_MASK) >> _ACMP_INPUTCTRL_POSSEL_SHIFT;
+  uint32_t resistor = (ctrl & _ACMP_INPUTCTRL_CSRESSEL_MASK) >> _ACMP_INPUTCTRL_CSRESSEL_SHIFT;
+  double pf;
+
+  if (!regs->EN || !acmpCapsense[acmp]
+      || ((ctrl & _ACMP_INPUTCTRL_NEGSEL_MASK) != ACMP_INPUTCTRL_NEGSEL_CAPSENSE)
+      || (ns < acmpEnableNs[acmp] + SIM_ACMP_STARTUP_NS)
+      || !SIM_BusConnected(input, acmp)) {
+    return 0.0;
+  }
+  pf = waveform(input, ns);
+  if (pf <= 0.0) {
+    return 0.0;
+  }
+  return SIM_OSC_HZ_PF / (pf * ((resistor + 3) / 8.0));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the ACMP feeding a counter timer, or -1 if it counts nothing.
+ ******************************************************************************/
+static int SIM_CounterSource(int t)
+{
+  if ((t == 0) || (timers[t].clkSel != timerClkSelCC1)
+      || (timers[t].prsSel >= SIM_PRS_CHANNELS)) {
+    return -1;
+  }
+  return prsSource[timers[t].prsSel];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Count the ACMP pulses of a counter timer up to the current time.
+ ******************************************************************************/
+static void SIM_SyncCounter(int t)
+{
+  SIM_Timer_t *timer = &timers[t];
+  TIMER_TypeDef *regs = &SIM_TIMER[t];
+  int acmp = SIM_CounterSource(t);
+  uint64_t ns = timer->refNs;
+  uint64_t step;
+  uint32_t pulses;
+  uint32_t count;
+
+  if (!timer->running || (acmp < 0)) {
+    timer->refNs = simNow;
+    return;
+  }
+  while (ns < simNow) {
+    step = simNow - ns;
+    if (step > SIM_STEP_NS) {
+      step = SIM_STEP_NS;
+    }
+    timer->phase += SIM_AcmpRate(acmp, ns + step / 2) * (double) step / 1e9;
+    ns += step;
+    if (timer->phase < 1.0) {
+      continue;
+    }
+    pulses = (uint32_t) timer->phase;
+    timer->phase -= pulses;
+    count = regs->CNT + pulses;
+    if ((regs->CNT < timer->cc0) && (count >= timer->cc0)) {
+      regs->IF |= TIMER_IF_CC0;
+    }
+    if (count > regs->TOP) {
+      regs->IF |= TIMER_IF_OF;
+      count = (count - regs->TOP - 1) & 0xFFFF;
+    }
+    regs->CNT = count;
+  }
+  timer->refNs = simNow;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Bring TIMER0 CNT and all counters up to the current time.
+ ******************************************************************************/
+static void SIM_SyncTimers(void)
+{
+  SIM_Timer_t *timer = &timers[0];
+  int t;
+
+  for (t = 1; t < SIM_TIMERS; t++) {
+    SIM_SyncCounter(t);
+  }
+  if (timer->running) {
+    uint64_t cycles = ((simNow - timer->refNs) * SIM_HFCLK_HZ) / 1000000000ULL;
+    uint64_t ticks = cycles >> timer->prescale;
+
+    if (ticks > 0) {
+      TIMER0->CNT += (uint32_t) ticks;
+      timer->refNs += SIM_TicksToNs(ticks, timer->prescale);
+      if (timer->refNs > simNow) {
+        timer->refNs = simNow;
+      }
+    }
+  } else {
+    timer->refNs = simNow;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the time of the next TIMER0 overflow.
+ ******************************************************************************/
+static uint64_t SIM_Timer0Event(void)
+{
+  SIM_Timer_t *timer = &timers[0];
+  uint32_t cnt = TIMER0->CNT;
+
+  if (!timer->running) {
+    return SIM_NO_EVENT;
+  }
+  if (cnt > TIMER0->TOP) {
+    cnt = TIMER0->TOP;
+  }
+  return timer->refNs + SIM_TicksToNs(TIMER0->TOP - cnt + 1, timer->prescale);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the RTCC counter at a time.
+ ******************************************************************************/
+static uint32_t SIM_RtccCount(uint64_t ns)
+{
+  return (uint32_t) (((ns - rtcc.offsetNs) * (32768 >> rtcc.presc)) / 1000000000ULL);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the time a counter is expected to reach its CC0 value, if the CC0
+ *   interrupt is enabled. The pulse rate may change before then, in which
+ *   case the counter is simply checked again.
+ ******************************************************************************/
+static uint64_t SIM_CounterEvent(int t)
+{
+  SIM_Timer_t *timer = &timers[t];
+  TIMER_TypeDef *regs = &SIM_TIMER[t];
+  int acmp = SIM_CounterSource(t);
+  double rate;
+  double ns;
+
+  if (!timer->running || (acmp < 0) || !(regs->IEN & TIMER_IEN_CC0)
+      || (regs->CNT >= timer->cc0)) {
+    return SIM_NO_EVENT;
+  }
+  rate = SIM_AcmpRate(acmp, timer->refNs);
+  if (rate <= 0.0) {
+    return timer->refNs + SIM_STEP_NS;
+  }
+  ns = ceil(((double) (timer->cc0 - regs->CNT) - timer->phase) * 1e9 / rate);
+  return timer->refNs + ((ns < 1.0) ? 1 : (uint64_t) ns);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the time of the next RTCC compare match.
+ ******************************************************************************/
+static uint64_t SIM_RtccEvent(void)
+{
+  uint64_t hz = 32768 >> rtcc.presc;
+  uint64_t now = ((simNow - rtcc.offsetNs) * hz) / 1000000000ULL;
+  uint64_t delta = (uint32_t) (rtcc.ccv - (uint32_t) now);
+
+  if (!(rtcc.ien & RTCC_IEN_CC1)) {
+    return SIM_NO_EVENT;
+  }
+  if (delta == 0) {
+    delta = 1ULL << 32;
+  }
+  return rtcc.offsetNs + ((now + delta) * 1000000000ULL + hz - 1) / hz;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the host address of a 32 bit LDMA address. The test program must be
+ *   linked below 4 GB for the drivers to store addresses in descriptors.
+ ******************************************************************************/
+static volatile uint32_t *SIM_LdmaAddr(uint32_t addr)
+{
+  return (volatile uint32_t *) (uintptr_t) addr;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Load the descriptor at the link address of an LDMA channel.
+ ******************************************************************************/
+static void SIM_LdmaLoad(int ch, uint32_t link)
+{
+  SIM_LdmaChannel_t *channel = &ldmaChannels[ch];
+
+  channel->desc = (const LDMA_Descriptor_t *) SIM_LdmaAddr(link);
+  if ((channel->desc->xfer.structType != ldmaCtrlStructTypeXfer)
+      || (channel->desc->xfer.size != ldmaCtrlSizeWord)
+      || (channel->desc->xfer.srcAddrMode != ldmaCtrlSrcAddrModeAbs)
+      || (channel->desc->xfer.dstAddrMode != ldmaCtrlDstAddrModeAbs)) {
+    SIM_Fail("unsupported LDMA descriptor");
+  }
+  LDMA->CH[ch].SRC = channel->desc->xfer.srcAddr;
+  LDMA->CH[ch].DST = channel->desc->xfer.dstAddr;
+  channel->remaining = channel->desc->xfer.xferCnt + 1;
+  channel->active = true;
+  LDMA->CHEN |= 1UL << ch;
+  LDMA->CHDONE &= ~(1UL << ch);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the transfers of an LDMA channel for one request. Linked
+ *   descriptors with structReq set run right after the current one.
+ ******************************************************************************/
+static void SIM_LdmaRequest(int ch)
+{
+  SIM_LdmaChannel_t *channel = &ldmaChannels[ch];
+  const LDMA_Descriptor_t *desc;
+  volatile uint32_t *dst;
+  bool request = true;
+
+  while (channel->active && request) {
+    desc = channel->desc;
+    dst = SIM_LdmaAddr(LDMA->CH[ch].DST);
+    *dst = *SIM_LdmaAddr(LDMA->CH[ch].SRC);
+    if (dst == &TIMER0->TOPB) {
+      timers[0].topBuffered = true;
+    }
+    if (desc->xfer.srcInc != ldmaCtrlSrcIncNone) {
+      LDMA->CH[ch].SRC += 4;
+    }
+    if (desc->xfer.dstInc != ldmaCtrlDstIncNone) {
+      LDMA->CH[ch].DST += 4;
+    }
+    if (--channel->remaining > 0) {
+      return;
+    }
+    if (desc->xfer.doneIfs) {
+      LDMA->IF |= 1UL << ch;
+    }
+    if (!desc->xfer.link) {
+      channel->active = false;
+      LDMA->CHEN &= ~(1UL << ch);
+      LDMA->CHDONE |= 1UL << ch;
+      return;
+    }
+    if (desc->xfer.linkMode != ldmaLinkModeAbs) {
+      SIM_Fail("unsupported LDMA link mode");
+    }
+    SIM_LdmaLoad(ch, (uint32_t) desc->xfer.linkAddr << 2);
+    request = channel->desc->xfer.structReq;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Apply the LDMA command registers written by the drivers.
+ ******************************************************************************/
+static void SIM_LdmaSync(void)
+{
+  int ch;
+
+  LDMA->IF = (LDMA->IF | LDMA->IF_SET) & ~LDMA->IF_CLR;
+  LDMA->IF_SET = 0;
+  LDMA->IF_CLR = 0;
+  for (ch = 0; ch < SIM_LDMA_CHANNELS; ch++) {
+    if (LDMA->CHDIS & (1UL << ch)) {
+      ldmaChannels[ch].active = false;
+      LDMA->CHEN &= ~(1UL << ch);
+    }
+    if (LDMA->LINKLOAD & (1UL << ch)) {
+      SIM_LdmaLoad(ch, LDMA->CH[ch].LINK & _LDMA_CH_LINK_LINKADDR_MASK);
+      if (ldmaChannels[ch].desc->xfer.structReq) {
+        SIM_LdmaRequest(ch);
+      }
+    }
+  }
+  LDMA->CHDIS = 0;
+  LDMA->LINKLOAD = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check for an interrupt which is enabled in its peripheral and the NVIC.
+ ******************************************************************************/
+static int SIM_PendingIrq(void)
+{
+  SIM_LdmaSync();
+  if (nvicEnabled[TIMER0_IRQn] && (TIMER0->IF & TIMER0->IEN)) {
+    return TIMER0_IRQn;
+  }
+  if (nvicEnabled[LDMA_IRQn] && (LDMA->IF & LDMA->IEN)) {
+    return LDMA_IRQn;
+  }
+  if (nvicEnabled[RTCC_IRQn] && (rtcc.flags & rtcc.ien)) {
+    return RTCC_IRQn;
+  }
+  if (nvicEnabled[TIMER1_IRQn] && (TIMER1->IF & TIMER1->IEN)) {
+    return TIMER1_IRQn;
+  }
+  if (nvicEnabled[TIMER2_IRQn] && (TIMER2->IF & TIMER2->IEN)) {
+    return TIMER2_IRQn;
+  }
+  return -1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the handlers of the pending interrupts unless they are masked.
+ ******************************************************************************/
+static void SIM_Dispatch(void)
+{
+  struct timespec start;
+  struct timespec end;
+  int irq;
+
+  while (!inIsr && !primask && ((irq = SIM_PendingIrq()) >= 0)) {
+    inIsr = true;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    switch (irq) {
+      case TIMER0_IRQn:
+        TIMER0_IRQHandler();
+        break;
+      case LDMA_IRQn:
+        LDMA_IRQHandler();
+        break;
+      case TIMER1_IRQn:
+        TIMER1_IRQHandler();
+        break;
+      case TIMER2_IRQn:
+        TIMER2_IRQHandler();
+        break;
+      default:
+        RTCC_IRQHandler();
+        break;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    isrHostNs[irq] += (uint64_t) (end.tv_sec - start.tv_sec) * 1000000000ULL
+                      + (uint64_t) end.tv_nsec - (uint64_t) start.tv_nsec;
+    isrCount[irq]++;
+    DWT->CYCCNT += SIM_ISR_CYCLES;
+    isrCycles += SIM_ISR_CYCLES;
+    inIsr = false;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Handle a TIMER0 overflow at the current time.
+ ******************************************************************************/
+static void SIM_Timer0Overflow(void)
+{
+  SIM_Timer_t *timer = &timers[0];
+  int ch;
+
+  SIM_SyncTimers();
+  TIMER0->CNT = 0;
+  timer->refNs = simNow;
+  if (timer->topBuffered) {
+    TIMER0->TOP = TIMER0->TOPB;
+    timer->topBuffered = false;
+  }
+  TIMER0->IF |= TIMER_IF_OF;
+
+  // The overflow requests the LDMA channels selecting it
+  SIM_LdmaSync();
+  for (ch = 0; ch < SIM_LDMA_CHANNELS; ch++) {
+    if (ldmaChannels[ch].active
+        && (LDMAXBAR->CH[ch].REQSEL == (LDMAXBAR_CH_REQSEL_SOURCESEL_TIMER0
+                                        | LDMAXBAR_CH_REQSEL_SIGSEL_TIMER0UFOF))) {
+      SIM_LdmaRequest(ch);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Move the virtual clock to the next event, but not beyond a limit.
+ *
+ * @param limit
+ *   The latest time to move to.
+ *
+ * @param hfRunning
+ *   False in EM2, where the HF timers are frozen.
+ *
+ * @return
+ *   False if there was no event before the limit.
+ ******************************************************************************/
+static bool SIM_Step(uint64_t limit, bool hfRunning)
+{
+  uint64_t timer0 = hfRunning ? SIM_Timer0Event() : SIM_NO_EVENT;
+  uint64_t rtccAt = SIM_RtccEvent();
+  uint64_t next = (timer0 < rtccAt) ? timer0 : rtccAt;
+  uint64_t target;
+  uint64_t at;
+  int t;
+
+  for (t = 1; hfRunning && (t < SIM_TIMERS); t++) {
+    at = SIM_CounterEvent(t);
+    next = (at < next) ? at : next;
+  }
+  target = (next < limit) ? next : limit;
+  if (target == SIM_NO_EVENT) {
+    return false;
+  }
+  if (hfRunning) {
+    simNow = target;
+    SIM_SyncTimers();
+  } else {
+    // The HF clocks are off, the timers continue where they stopped
+    for (t = 0; t < SIM_TIMERS; t++) {
+      timers[t].refNs += target - simNow;
+    }
+    simNow = target;
+  }
+  if (target == timer0) {
+    SIM_Timer0Overflow();
+  }
+  if (target == rtccAt) {
+    rtcc.flags |= RTCC_IF_CC1;
+  }
+  return target == next;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Sleep until an interrupt is pending.
+ ******************************************************************************/
+static void SIM_Sleep(bool hfRunning)
+{
+  while (SIM_PendingIrq() < 0) {
+    if (simNow >= endNs) {
+      longjmp(*endJump, 1);
+    }
+    if (!SIM_Step(endNs, hfRunning) && (endNs == SIM_NO_EVENT)) {
+      SIM_Fail("sleeping without a wakeup source");
+    }
+  }
+  SIM_Dispatch();
+}
+
+void SIM_Reset(void)
+{
+  int i;
+
+  memset(SIM_ACMP, 0, sizeof(SIM_ACMP));
+  memset(SIM_TIMER, 0, sizeof(SIM_TIMER));
+  memset(&SIM_GPIO, 0, sizeof(SIM_GPIO));
+  memset(&SIM_DWT, 0, sizeof(SIM_DWT));
+  memset(&SIM_CoreDebug, 0, sizeof(SIM_CoreDebug));
+  memset(&SIM_LDMA, 0, sizeof(SIM_LDMA));
+  memset(&SIM_LDMAXBAR, 0, sizeof(SIM_LDMAXBAR));
+  memset(ldmaChannels, 0, sizeof(ldmaChannels));
+  memset(SIM_Flash, 0xFF, sizeof(SIM_Flash));
+  memset(timers, 0, sizeof(timers));
+  memset(&rtcc, 0, sizeof(rtcc));
+  memset(acmpEnableNs, 0, sizeof(acmpEnableNs));
+  memset(acmpCapsense, 0, sizeof(acmpCapsense));
+  memset(nvicEnabled, 0, sizeof(nvicEnabled));
+  memset(isrCount, 0, sizeof(isrCount));
+  memset(isrHostNs, 0, sizeof(isrHostNs));
+  isrCycles = 0;
+  memset(leds, 0, sizeof(leds));
+  for (i = 0; i < SIM_PRS_CHANNELS; i++) {
+    prsSource[i] = -1;
+  }
+  simNow = 0;
+  primask = 0;
+  inIsr = false;
+  waveform = SIM_Electrode;
+  numElectrodes = 0;
+  numTouches = 0;
+  noiseSeed = 0;
+  ledHook = NULL;
+  endNs = SIM_NO_EVENT;
+  endJump = NULL;
+}
+
+void SIM_SetWaveform(SIM_Waveform_t newWaveform)
+{
+  SIM_SyncTimers();
+  waveform = (newWaveform != NULL) ? newWaveform : SIM_Electrode;
+}
+
+void SIM_SetElectrode(uint32_t input, double basePf, double driftPfPerS,
+                      double noisePf)
+{
+  uint32_t i;
+
+  SIM_SyncTimers();
+  for (i = 0; (i < numElectrodes) && (electrodes[i].input != input); i++) {
+  }
+  if (i == SIM_ELECTRODES) {
+    SIM_Fail("too many electrodes");
+  }
+  electrodes[i].input = input;
+  electrodes[i].basePf = basePf;
+  electrodes[i].driftPfPerS = driftPfPerS;
+  electrodes[i].noisePf = noisePf;
+  if (i == numElectrodes) {
+    numElectrodes++;
+  }
+}
+
+void SIM_AddTouch(uint32_t input, uint64_t startNs, uint64_t endNs,
+                  double pf)
+{
+  if (numTouches == SIM_TOUCHES) {
+    SIM_Fail("too many touches");
+  }
+  touches[numTouches].input = input;
+  touches[numTouches].startNs = startNs;
+  touches[numTouches].endNs = endNs;
+  touches[numTouches].pf = pf;
+  numTouches++;
+}
+
+void SIM_Seed(uint32_t seed)
+{
+  noiseSeed = seed;
+}
+
+uint64_t SIM_Now(void)
+{
+  return simNow;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Let time pass while the core runs. The time is charged to the DWT
+ *   cycle counter and interrupts are handled as they come.
+ ******************************************************************************/
+void SIM_Run(uint64_t ns)
+{
+  uint64_t target = simNow + ns;
+  uint64_t start = simNow;
+
+  while (simNow < target) {
+    SIM_Step(target, true);
+    SIM_Dispatch();
+  }
+  DWT->CYCCNT += (uint32_t) (((target - start) * (SIM_HFCLK_HZ / 1000000)) / 1000);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Let time pass in EM1 until a flag is set from interrupt context.
+ *
+ * @return
+ *   False on a timeout.
+ ******************************************************************************/
+bool SIM_RunUntil(volatile bool *done, uint64_t timeoutNs)
+{
+  uint64_t target = simNow + timeoutNs;
+
+  SIM_Dispatch();
+  while (!*done && (simNow < target)) {
+    SIM_Step(target, true);
+    SIM_Dispatch();
+  }
+  return *done;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stop a program which sleeps forever at a time, by jumping to end from
+ *   the first sleep at or after it.
+ ******************************************************************************/
+void SIM_SetEnd(uint64_t ns, jmp_buf *end)
+{
+  endNs = ns;
+  endJump = end;
+}
+
+void SIM_SetLedHook(SIM_LedHook_t hook)
+{
+  ledHook = hook;
+}
+
+bool SIM_GetLed(int led)
+{
+  return (led >= 0) && (led < SIM_LEDS) && leds[led];
+}
+
+void SIM_GetIsrStats(IRQn_Type irq, uint32_t *count, uint64_t *hostNs)
+{
+  *count = isrCount[irq];
+  *hostNs = isrHostNs[irq];
+}
+
+/* Core */
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  nvicEnabled[irq] = true;
+  SIM_Dispatch();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+  nvicEnabled[irq] = false;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  // Interrupts are level triggered, nothing is latched
+  (void) irq;
+}
+
+void __disable_irq(void)
+{
+  primask = 1;
+}
+
+void __enable_irq(void)
+{
+  primask = 0;
+  SIM_Dispatch();
+}
+
+uint32_t __get_PRIMASK(void)
+{
+  return primask;
+}
+
+void __set_PRIMASK(uint32_t value)
+{
+  primask = value;
+  SIM_Dispatch();
+}
+
+void EMU_EnterEM1(void)
+{
+  SIM_Sleep(true);
+}
+
+void EMU_EnterEM2(bool restore)
+{
+  (void) restore;
+  SIM_SyncTimers();
+  SIM_Sleep(false);
+}
+
+/* CMU */
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void) clock;
+  (void) enable;
+}
+
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock)
+{
+  return (clock == cmuClock_RTCC) ? 32768 : SIM_HFCLK_HZ;
+}
+
+void CMU_ClockSelectSet(CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref)
+{
+  (void) clock;
+  (void) ref;
+}
+
+/* ACMP */
+
+static int SIM_AcmpIndex(ACMP_TypeDef *acmp)
+{
+  return (int) (acmp - SIM_ACMP);
+}
+
+void ACMP_CapsenseInit(ACMP_TypeDef *acmp,
+                       const ACMP_CapsenseInit_TypeDef *init)
+{
+  int a = SIM_AcmpIndex(acmp);
+
+  SIM_SyncTimers();
+  acmp->INPUTCTRL = ACMP_INPUTCTRL_NEGSEL_CAPSENSE
+                    | ((uint32_t) init->resistor << _ACMP_INPUTCTRL_CSRESSEL_SHIFT);
+  acmpCapsense[a] = true;
+  acmp->EN = 0;
+  if (init->enable) {
+    ACMP_Enable(acmp);
+  }
+}
+
+void ACMP_CapsenseChannelSet(ACMP_TypeDef *acmp, ACMP_Channel_TypeDef input)
+{
+  SIM_SyncTimers();
+  acmp->INPUTCTRL = (acmp->INPUTCTRL & ~_ACMP_INPUTCTRL_POSSEL_MASK)
+                    | ((uint32_t) input << _ACMP_INPUTCTRL_POSSEL_SHIFT);
+}
+
+void ACMP_Enable(ACMP_TypeDef *acmp)
+{
+  SIM_SyncTimers();
+  if (!acmp->EN) {
+    acmp->EN = 1;
+    acmpEnableNs[SIM_AcmpIndex(acmp)] = simNow;
+  }
+}
+
+void ACMP_Disable(ACMP_TypeDef *acmp)
+{
+  SIM_SyncTimers();
+  acmp->EN = 0;
+}
+
+/* TIMER */
+
+static int SIM_TimerIndex(TIMER_TypeDef *timer)
+{
+  return (int) (timer - SIM_TIMER);
+}
+
+void TIMER_Init(TIMER_TypeDef *timer, const TIMER_Init_TypeDef *init)
+{
+  SIM_Timer_t *state = &timers[SIM_TimerIndex(timer)];
+
+  SIM_SyncTimers();
+  state->prescale = init->prescale;
+  state->clkSel = init->clkSel;
+  state->running = false;
+  timer->CNT = 0;
+  timer->TOP = 0xFFFF;
+  timer->IF = 0;
+  TIMER_Enable(timer, init->enable);
+}
+
+void TIMER_InitCC(TIMER_TypeDef *timer, unsigned int ch,
+                  const TIMER_InitCC_TypeDef *init)
+{
+  SIM_Timer_t *state = &timers[SIM_TimerIndex(timer)];
+
+  SIM_SyncTimers();
+  if ((ch == 1) && init->prsInput) {
+    state->prsSel = init->prsSel;
+  }
+}
+
+void TIMER_Enable(TIMER_TypeDef *timer, bool enable)
+{
+  SIM_Timer_t *state = &timers[SIM_TimerIndex(timer)];
+
+  SIM_SyncTimers();
+  state->running = enable;
+  timer->EN = enable;
+  state->refNs = simNow;
+}
+
+void TIMER_TopSet(TIMER_TypeDef *timer, uint32_t val)
+{
+  SIM_SyncTimers();
+  timer->TOP = val;
+  timers[SIM_TimerIndex(timer)].topBuffered = false;
+}
+
+void TIMER_TopBufSet(TIMER_TypeDef *timer, uint32_t val)
+{
+  SIM_SyncTimers();
+  timer->TOPB = val;
+  timers[SIM_TimerIndex(timer)].topBuffered = true;
+}
+
+uint32_t TIMER_TopGet(TIMER_TypeDef *timer)
+{
+  return timer->TOP;
+}
+
+void TIMER_CounterSet(TIMER_TypeDef *timer, uint32_t val)
+{
+  SIM_SyncTimers();
+  timer->CNT = val;
+  timers[SIM_TimerIndex(timer)].phase = 0.0;
+}
+
+uint32_t TIMER_CounterGet(TIMER_TypeDef *timer)
+{
+  SIM_SyncTimers();
+  return timer->CNT;
+}
+
+void TIMER_CompareSet(TIMER_TypeDef *timer, unsigned int ch, uint32_t val)
+{
+  SIM_SyncTimers();
+  if (ch == 0) {
+    timers[SIM_TimerIndex(timer)].cc0 = val;
+  }
+}
+
+void TIMER_IntClear(TIMER_TypeDef *timer, uint32_t flags)
+{
+  SIM_SyncTimers();
+  timer->IF &= ~flags;
+}
+
+void TIMER_IntEnable(TIMER_TypeDef *timer, uint32_t flags)
+{
+  timer->IEN |= flags;
+  SIM_Dispatch();
+}
+
+void TIMER_IntDisable(TIMER_TypeDef *timer, uint32_t flags)
+{
+  timer->IEN &= ~flags;
+}
+
+uint32_t TIMER_IntGet(TIMER_TypeDef *timer)
+{
+  SIM_SyncTimers();
+  return timer->IF;
+}
+
+/* PRS */
+
+void PRS_ConnectSignal(unsigned int ch, PRS_ChType_t type,
+                       PRS_Signal_t signal)
+{
+  (void) type;
+  SIM_SyncTimers();
+  if (ch < SIM_PRS_CHANNELS) {
+    prsSource[ch] = (signal == prsSignalACMP0_OUT) ? 0
+                    : (signal == prsSignalACMP1_OUT) ? 1 : -1;
+  }
+}
+
+/* GPIO */
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+                     GPIO_Mode_TypeDef mode, unsigned int out)
+{
+  (void) port;
+  (void) pin;
+  (void) mode;
+  (void) out;
+}
+
+/* MSC */
+
+void MSC_Init(void)
+{
+}
+
+void MSC_Deinit(void)
+{
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the index of an address in SIM_Flash, or -1 if it is outside.
+ ******************************************************************************/
+static long SIM_FlashIndex(const void *address, uint32_t bytes)
+{
+  uintptr_t offset = (uintptr_t) address - FLASH_BASE;
+
+  if (((uintptr_t) address < FLASH_BASE) || (offset + bytes > FLASH_SIZE)) {
+    return -1;
+  }
+  return (long) (offset / sizeof(uint32_t));
+}
+
+MSC_Status_TypeDef MSC_ErasePage(uint32_t *startAddress)
+{
+  long index = SIM_FlashIndex(startAddress, FLASH_PAGE_SIZE);
+
+  if (index < 0) {
+    return mscReturnInvalidAddr;
+  }
+  if (((uintptr_t) startAddress - FLASH_BASE) % FLASH_PAGE_SIZE) {
+    return mscReturnUnaligned;
+  }
+  memset(&SIM_Flash[index], 0xFF, FLASH_PAGE_SIZE);
+  return mscReturnOk;
+}
+
+MSC_Status_TypeDef MSC_WriteWord(uint32_t *address, void const *data,
+                                 uint32_t numBytes)
+{
+  long index = SIM_FlashIndex(address, numBytes);
+  const uint8_t *src = data;
+  uint8_t *dst;
+  uint32_t i;
+
+  if (index < 0) {
+    return mscReturnInvalidAddr;
+  }
+  if ((((uintptr_t) address | numBytes) & 3) != 0) {
+    return mscReturnUnaligned;
+  }
+  // Programming only clears bits
+  dst = (uint8_t *) &SIM_Flash[index];
+  for (i = 0; i < numBytes; i++) {
+    dst[i] &= src[i];
+  }
+  return mscReturnOk;
+}
+
+/* RTCC */
+
+void RTCC_Init(const RTCC_Init_TypeDef *init)
+{
+  rtcc.presc = init->presc;
+  rtcc.offsetNs = simNow;
+}
+
+void RTCC_ChannelInit(int ch, const RTCC_CCChConf_TypeDef *conf)
+{
+  (void) ch;
+  (void) conf;
+}
+
+void RTCC_ChannelCCVSet(int ch, uint32_t value)
+{
+  if (ch == 1) {
+    rtcc.ccv = value;
+  }
+}
+
+uint32_t RTCC_CounterGet(void)
+{
+  return SIM_RtccCount(simNow);
+}
+
+void RTCC_IntClear(uint32_t flags)
+{
+  rtcc.flags &= ~flags;
+}
+
+void RTCC_IntEnable(uint32_t flags)
+{
+  rtcc.ien |= flags;
+  SIM_Dispatch();
+}
+
+/* Kit LEDs */
+
+int BSP_LedsInit(void)
+{
+  memset(leds, 0, sizeof(leds));
+  return 0;
+}
+
+static int SIM_Led(int ledNo, bool on)
+{
+  if ((ledNo < 0) || (ledNo >= SIM_LEDS)) {
+    return -1;
+  }
+  if (leds[ledNo] != on) {
+    leds[ledNo] = on;
+    if (ledHook != NULL) {
+      ledHook(ledNo, on, simNow);
+    }
+  }
+  return 0;
+}
+
+int BSP_LedSet(int ledNo)
+{
+  return SIM_Led(ledNo, true);
+}
+
+int BSP_LedClear(int ledNo)
+{
+  return SIM_Led(ledNo, false);
+}
+
+int BSP_LedToggle(int ledNo)
+{
+  return SIM_Led(ledNo, !SIM_GetLed(ledNo));
+}
+
+/** @} (end addtogroup Simulator) */
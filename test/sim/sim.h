@@ -0,0 +1,114 @@
+/***************************************************************************//**
+ * @file
+ * @brief Peripheral simulator for host builds of the capsense drivers
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __SIM_H_
+#define __SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
+
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************************************************************//**
+ * @addtogroup Simulator
+ * @{
+ *
+ * @details
+ *   The simulator runs the drivers on a virtual clock in nanoseconds. Code
+ *   runs in zero virtual time, the clock only moves while the core sleeps in
+ *   EMU_EnterEM1() or EMU_EnterEM2(), or in SIM_Run(). Interrupts are
+ *   level triggered from the IF and IEN registers of the peripherals and
+ *   are dispatched as soon as PRIMASK and the NVIC allow it.
+ *
+ *   LDMA channels requested by TIMER0 overflows run word transfers with
+ *   absolute addresses. Programs starting the LDMA must be linked below
+ *   4 GB, see SIM_LdmaAddr().
+ *
+ *   Each ACMP in capsense mode oscillates at SIM_OSC_HZ_PF divided by the
+ *   capacitance of its input and by the resistor scale. The counter timer
+ *   fed by its PRS channel counts one pulse per period.
+ ******************************************************************************/
+
+/** HF clock of the core and the timers */
+#define SIM_HFCLK_HZ            19000000UL
+/** ACMP oscillation frequency times the input capacitance in pF */
+#define SIM_OSC_HZ_PF           1e7
+/** Time from ACMP_Enable() until the ACMP oscillates */
+#define SIM_ACMP_STARTUP_NS     10000
+/** Core cycles charged to the DWT cycle counter by each interrupt */
+#define SIM_ISR_CYCLES          400
+/** Longest step of the pulse integration */
+#define SIM_STEP_NS             5000
+/** Time a noise sample of an electrode is held */
+#define SIM_NOISE_HOLD_NS       100000
+
+/** Capacitance of an ACMP input in pF at a time in ns */
+typedef double (*SIM_Waveform_t)(uint32_t input, uint64_t ns);
+
+/** Called when a kit LED changes */
+typedef void (*SIM_LedHook_t)(int led, bool on, uint64_t ns);
+
+void SIM_Reset(void);
+void SIM_SetWaveform(SIM_Waveform_t waveform);
+void SIM_SetElectrode(uint32_t input, double basePf, double driftPfPerS,
+                      double noisePf);
+void SIM_AddTouch(uint32_t input, uint64_t startNs, uint64_t endNs,
+                  double pf);
+double SIM_Electrode(uint32_t input, uint64_t ns);
+void SIM_Seed(uint32_t seed);
+double SIM_Gaussian(uint32_t input, uint64_t index);
+
+uint64_t SIM_Now(void);
+void SIM_Run(uint64_t ns);
+bool SIM_RunUntil(volatile bool *done, uint64_t timeoutNs);
+void SIM_SetEnd(uint64_t ns, jmp_buf *end);
+
+void SIM_SetLedHook(SIM_LedHook_t hook);
+bool SIM_GetLed(int led);
+void SIM_GetIsrStats(IRQn_Type irq, uint32_t *count, uint64_t *hostNs);
+
+/** @} (end addtogroup Simulator) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_H_ */
@@ -0,0 +1,215 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of the reciprocal, the baseline tracking and the slider
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+
+/***************************************************************************//**
+ * @brief
+ *   Set up a fresh context and a batch whose channels all count base.
+ ******************************************************************************/
+static void setup(uint32_t frames, uint16_t base)
+{
+  uint32_t s;
+  uint8_t channel;
+
+  CAPSENSE_CtxInit(&ctx, NULL, NULL, state, CAPSENSE_MAX_CHANNELS);
+  memset(&batch, 0, sizeof(batch));
+  batch.frames = frames;
+  for (channel = 0; channel < CAPSENSE_MAX_CHANNELS; channel++) {
+    for (s = 0; s < frames; s++) {
+      batch.counts[channel][s] = base;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The levels of touched samples are exact for every 16 bit baseline.
+ ******************************************************************************/
+static void testReciprocal(void)
+{
+  static const uint32_t fractions[] = { 0, 1, 64, 128, 150 };
+  uint32_t max;
+  uint32_t n;
+  uint32_t s;
+  int errors = 0;
+
+  for (max = 4; max <= 0xFFFF; max += 7) {
+    setup(1 + sizeof(fractions) / sizeof(fractions[0]), (uint16_t) max);
+    for (s = 1; s < batch.frames; s++) {
+      // Below the touch threshold, so the baseline stays at max
+      batch.counts[0][s] = (uint16_t) ((max * fractions[s - 1]) / 256);
+    }
+    CAPSENSE_CtxProcessBatch(&ctx, &batch);
+    if (batch.levels[0][0] != 256) {
+      errors++;
+    }
+    for (s = 1; s < batch.frames; s++) {
+      n = batch.counts[0][s];
+      if (batch.levels[0][s] != (n * 256) / max) {
+        errors++;
+      }
+    }
+  }
+  CHECK_EQ(errors, 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Feed one channel a step and get its baseline at the end.
+ ******************************************************************************/
+static uint32_t baselineAfter(uint16_t first, uint16_t then)
+{
+  uint32_t s;
+
+  setup(CAPSENSE_BATCH_FRAMES, then);
+  batch.counts[0][0] = first;
+  for (s = 1; s < CAPSENSE_BATCH_FRAMES; s++) {
+    batch.counts[0][s] = then;
+  }
+  CAPSENSE_CtxProcessBatch(&ctx, &batch);
+  return ctx.state[0].maxValue;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The baseline rises and falls by a bounded step and freezes on touch.
+ ******************************************************************************/
+static void testBaseline(void)
+{
+  uint32_t s;
+
+  // 15 steps of CAPSENSE_BASELINE_MAX_RISE / 256
+  CHECK_EQ(baselineAfter(1000, 2000), 1003);
+  // 15 steps of CAPSENSE_BASELINE_MAX_FALL / 256
+  CHECK_EQ(baselineAfter(1000, 900), 999);
+  // Below three quarters of the baseline the channel is touched
+  CHECK_EQ(baselineAfter(1000, 700), 1000);
+  CHECK_EQ(batch.pressed[0] & 1, 0);
+  for (s = 1; s < CAPSENSE_BATCH_FRAMES; s++) {
+    CHECK_EQ(batch.pressed[s] & 1, 1);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A week of frames at one per second. The idle count follows a daily
+ *   temperature swing of 20 % with noise of 4 counts, an upward spike of
+ *   30 % every 17 minutes outside the touches and a 5 s touch every hour.
+ *   Every touched frame is pressed, no idle frame is, and the baseline
+ *   stays within 2 % of the idle count.
+ ******************************************************************************/
+static void testDriftTrace(void)
+{
+  const uint32_t frames = 7 * 24 * 3600;
+  bool touched[CAPSENSE_BATCH_FRAMES];
+  double idle = 1000.0;
+  double count;
+  double error;
+  double worst = 0.0;
+  uint32_t wrong = 0;
+  uint32_t f;
+  uint32_t s;
+
+  setup(CAPSENSE_BATCH_FRAMES, 1000);
+  for (f = 0; f < frames; f++) {
+    s = f % CAPSENSE_BATCH_FRAMES;
+    idle = 1000.0 + 200.0 * sin(6.283185307179586 * f / 86400.0);
+    touched[s] = (f % 3600) >= 3595;
+    count = touched[s] ? (0.6 * idle) : idle;
+    count += 4.0 * SIM_Gaussian(0, f);
+    if (!touched[s] && ((f % 1020) == 1019)) {
+      count *= 1.3;
+    }
+    batch.counts[0][s] = (uint16_t) count;
+
+    if (s == (CAPSENSE_BATCH_FRAMES - 1)) {
+      CAPSENSE_CtxProcessBatch(&ctx, &batch);
+      for (s = 0; s < CAPSENSE_BATCH_FRAMES; s++) {
+        if ((batch.pressed[s] & 1) != touched[s]) {
+          wrong++;
+        }
+      }
+      error = fabs(ctx.state[0].maxValue - idle) / idle;
+      if (error > worst) {
+        worst = error;
+      }
+    }
+  }
+  CHECK_EQ(wrong, 0);
+  CHECK(worst < 0.02);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The slider interpolates between the touched channel and its neighbours.
+ ******************************************************************************/
+static void testSlider(void)
+{
+  setup(3, 1000);
+  // A touch centered on channel 1
+  batch.counts[1][1] = 500;
+  // The same touch leaning towards channel 2
+  batch.counts[1][2] = 500;
+  batch.counts[2][2] = 750;
+  CAPSENSE_CtxProcessBatch(&ctx, &batch);
+
+  CHECK_EQ(batch.slider[0], -1);
+  CHECK_EQ(batch.levels[1][1], 128);
+  CHECK_EQ(batch.slider[1], 16);
+  CHECK_EQ(batch.slider[2], 20);
+  // The last frame is published
+  CHECK_EQ(CAPSENSE_CtxGetSliderPosition(&ctx), 20);
+}
+
+int main(void)
+{
+  SIM_Reset();
+  RUN(testReciprocal);
+  RUN(testBaseline);
+  RUN(testDriftTrace);
+  RUN(testSlider);
+  return UNIT_Report();
+}
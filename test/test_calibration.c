@@ -0,0 +1,175 @@
+/***************************************************************************//**
+ * @file
+ * @brief Tests of the calibration record
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+/***************************************************************************//**
+ * @brief
+ *   Reset the device with four idle 10 pF electrodes, keeping the flash.
+ ******************************************************************************/
+static void boot(void)
+{
+  static uint32_t flash[FLASH_SIZE / sizeof(uint32_t)];
+  CAPSENSE_Event_t event;
+  int i;
+
+  memcpy(flash, SIM_Flash, sizeof(flash));
+  SIM_Reset();
+  memcpy(SIM_Flash, flash, sizeof(flash));
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  while (CAPSENSE_GetEvent(&event)) {
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Without a record the first scan becomes the baseline, so a touch
+ *   present at boot is not detected.
+ ******************************************************************************/
+static void testNoRecord(void)
+{
+  SIM_Reset();
+  boot();
+  SIM_AddTouch(inputs[0], 0, 100 * MS, 5.0);
+  CHECK(CAPSENSE_Sense());
+  CHECK(!CAPSENSE_getPressed(0));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The windows and baselines saved before a reset are restored by
+ *   CAPSENSE_Init(), so a touch present at boot is detected by the first
+ *   scan.
+ ******************************************************************************/
+static void testRestore(void)
+{
+  int i;
+
+  SIM_Reset();
+  boot();
+  CHECK(CAPSENSE_TuneWindows());
+  for (i = 0; i < 8; i++) {
+    CHECK(CAPSENSE_Sense());
+  }
+  CHECK(CAPSENSE_SaveCalibration());
+
+  boot();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_EQ(CAPSENSE_getWindow(i), 4);
+  }
+  SIM_AddTouch(inputs[0], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  CHECK(CAPSENSE_Sense());
+  CHECK(CAPSENSE_getPressed(0));
+  CHECK(!CAPSENSE_getPressed(1));
+  CHECK_NEAR(CAPSENSE_getVal(1), 135, 8);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Measure the virtual time from reset to the first valid touch decision.
+ *   Without a record the windows are tuned and a frame measures the
+ *   baselines first. With a record the first frame decides.
+ ******************************************************************************/
+static void testTimeToDecision(void)
+{
+  uint64_t withoutRecord;
+  uint64_t withRecord;
+  int i;
+
+  SIM_Reset();
+  boot();
+  CHECK(CAPSENSE_TuneWindows());
+  CHECK(CAPSENSE_Sense());
+  // The decision of the next frame is valid
+  SIM_AddTouch(inputs[0], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  CHECK(CAPSENSE_Sense());
+  CHECK(CAPSENSE_getPressed(0));
+  withoutRecord = SIM_Now();
+
+  for (i = 0; i < 8; i++) {
+    CHECK(CAPSENSE_Sense());
+  }
+  CHECK(CAPSENSE_SaveCalibration());
+
+  boot();
+  SIM_AddTouch(inputs[0], 0, 100 * MS, 5.0);
+  CHECK(CAPSENSE_Sense());
+  CHECK(CAPSENSE_getPressed(0));
+  withRecord = SIM_Now();
+
+  printf("reset to first valid decision: %.2f ms without a record, "
+         "%.2f ms with a record\n", withoutRecord / 1e6, withRecord / 1e6);
+  CHECK(withRecord * 2 < withoutRecord);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A record saved for other channels is ignored.
+ ******************************************************************************/
+static void testOtherChannels(void)
+{
+  CAPSENSE_Context_t *ctx = CAPSENSE_GetDefaultContext();
+
+  SIM_Reset();
+  boot();
+  CAPSENSE_Sense();
+  CHECK(CAPSENSE_SaveCalibration());
+  ctx->numChannels--;
+  CHECK(!CAPSENSE_CtxRestoreCalibration(ctx));
+  ctx->numChannels++;
+  CHECK(CAPSENSE_CtxRestoreCalibration(ctx));
+}
+
+int main(void)
+{
+  RUN(testNoRecord);
+  RUN(testRestore);
+  RUN(testTimeToDecision);
+  RUN(testOtherChannels);
+  return UNIT_Report();
+}
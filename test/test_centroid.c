@@ -0,0 +1,154 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of the centroid engine
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "capsense_centroid.h"
+#include "sim.h"
+#include "unit.h"
+
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+static const uint8_t sliderMap[] = CAPSENSE_SLIDER_MAP;
+
+/***************************************************************************//**
+ * @brief
+ *   Publish a frame with the given counts, after a frame at the baseline of
+ *   1000 counts.
+ ******************************************************************************/
+static void publish(const uint16_t *counts)
+{
+  uint8_t channel;
+
+  CAPSENSE_CtxInit(&ctx, NULL, NULL, state, CAPSENSE_MAX_CHANNELS);
+  memset(&batch, 0, sizeof(batch));
+  batch.frames = 2;
+  for (channel = 0; channel < CAPSENSE_MAX_CHANNELS; channel++) {
+    batch.counts[channel][0] = 1000;
+    batch.counts[channel][1] = counts[channel];
+  }
+  CHECK(CAPSENSE_CtxProcessBatch(&ctx, &batch));
+}
+
+static void testNoTouch(void)
+{
+  static const uint16_t counts[] = { 1000, 990, 1000, 1000 };
+  int32_t positions[CAPSENSE_CENTROID_MAX_TOUCHES];
+
+  publish(counts);
+  CHECK_EQ(CAPSENSE_CtxGetSliderTouches(&ctx, sliderMap, 4, positions), 0);
+}
+
+static void testOneTouch(void)
+{
+  // Signals 128 and 64, weighted 96 and 32 above the threshold
+  static const uint16_t counts[] = { 1000, 500, 750, 1000 };
+  int32_t positions[CAPSENSE_CENTROID_MAX_TOUCHES];
+
+  publish(counts);
+  CHECK_EQ(CAPSENSE_CtxGetSliderTouches(&ctx, sliderMap, 4, positions), 1);
+  CHECK_EQ(positions[0], 20);
+}
+
+static void testTwoTouches(void)
+{
+  static const uint16_t counts[] = { 500, 1000, 1000, 600 };
+  int32_t positions[CAPSENSE_CENTROID_MAX_TOUCHES];
+
+  publish(counts);
+  CHECK_EQ(CAPSENSE_CtxGetSliderTouches(&ctx, sliderMap, 4, positions), 2);
+  CHECK_EQ(positions[0], 0);
+  CHECK_EQ(positions[1], 3 * CAPSENSE_CENTROID_RESOLUTION);
+}
+
+static void testOneWideTouch(void)
+{
+  // No valley between the two peaks, so it is a single finger
+  static const uint16_t counts[] = { 1000, 500, 520, 1000 };
+  int32_t positions[CAPSENSE_CENTROID_MAX_TOUCHES];
+
+  publish(counts);
+  CHECK_EQ(CAPSENSE_CtxGetSliderTouches(&ctx, sliderMap, 4, positions), 1);
+  CHECK_NEAR(positions[0], 24, 1);
+}
+
+static void testPad(void)
+{
+  static const uint8_t rows[] = { 0, 1 };
+  static const uint8_t columns[] = { 2, 3 };
+  static const uint16_t counts[] = { 500, 1000, 1000, 500 };
+  int32_t x = -1;
+  int32_t y = -1;
+
+  publish(counts);
+  CHECK(CAPSENSE_CtxGetPadPosition(&ctx, rows, 2, columns, 2, &x, &y));
+  CHECK_EQ(x, CAPSENSE_CENTROID_RESOLUTION);
+  CHECK_EQ(y, 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Map entries beyond the channels of the context read as untouched.
+ ******************************************************************************/
+static void testMapOutOfRange(void)
+{
+  static const uint8_t map[] = { 0, 1, CAPSENSE_MAX_CHANNELS, 255 };
+  static const uint16_t counts[] = { 1000, 500, 1000, 1000 };
+  uint16_t signals[4];
+  int32_t positions[CAPSENSE_CENTROID_MAX_TOUCHES];
+
+  publish(counts);
+  CAPSENSE_CtxGetSignals(&ctx, map, 4, signals);
+  CHECK_EQ(signals[0], 0);
+  CHECK_EQ(signals[1], 128);
+  CHECK_EQ(signals[2], 0);
+  CHECK_EQ(signals[3], 0);
+  CHECK_EQ(CAPSENSE_CtxGetSliderTouches(&ctx, map, 4, positions), 1);
+  CHECK_EQ(positions[0], CAPSENSE_CENTROID_RESOLUTION);
+}
+
+int main(void)
+{
+  SIM_Reset();
+  RUN(testNoTouch);
+  RUN(testOneTouch);
+  RUN(testTwoTouches);
+  RUN(testOneWideTouch);
+  RUN(testPad);
+  RUN(testMapOutOfRange);
+  return UNIT_Report();
+}
@@ -0,0 +1,205 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of the common mode rejection
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[3];
+
+/***************************************************************************//**
+ * @brief
+ *   Event timestamps in virtual milliseconds.
+ ******************************************************************************/
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return (uint32_t) (SIM_Now() / MS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start from reset with four idle 10 pF electrodes.
+ ******************************************************************************/
+static void setup(void)
+{
+  CAPSENSE_Event_t event;
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  while (CAPSENSE_GetEvent(&event)) {
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan every 20 ms until the given time and count the events.
+ ******************************************************************************/
+static uint32_t scanUntil(uint64_t end, uint8_t channel)
+{
+  CAPSENSE_Event_t event;
+  uint32_t presses = 0;
+
+  while (SIM_Now() < end) {
+    uint64_t next = SIM_Now() + 20 * MS;
+
+    CHECK(CAPSENSE_Sense());
+    while (CAPSENSE_GetEvent(&event)) {
+      if ((event.type == CAPSENSE_EVENT_PRESS) && (event.channel == channel)) {
+        presses++;
+      }
+    }
+    SIM_Run(next - SIM_Now());
+  }
+  return presses;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A 2 pF shift of all electrodes for 5 s is taken out of the values. The
+ *   baselines follow the corrected values, so they stay at the 296 counts of
+ *   the idle electrodes instead of counting the shift twice.
+ ******************************************************************************/
+static void testCommonShift(void)
+{
+  CAPSENSE_Frame_t frame;
+  int i;
+
+  setup();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_AddTouch(inputs[i], 100 * MS, 5100 * MS, 2.0);
+  }
+  CHECK_EQ(scanUntil(5000 * MS, 1), 0);
+  CAPSENSE_GetFrame(&frame);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_NEAR(frame.values[i], 296, 8);
+    CHECK_NEAR(frame.maxValues[i], 296, 6);
+    CHECK(!CAPSENSE_getPressed(i));
+  }
+
+  // No presses once the shift is gone either
+  CHECK_EQ(scanUntil(6000 * MS, 1), 0);
+  CAPSENSE_GetFrame(&frame);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_NEAR(frame.values[i], 296, 8);
+    CHECK_NEAR(frame.maxValues[i], 296, 6);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A touch of one electrode is not common mode and still presses during a
+ *   shift of all electrodes.
+ ******************************************************************************/
+static void testTouchDuringShift(void)
+{
+  int i;
+
+  setup();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_AddTouch(inputs[i], 100 * MS, 3100 * MS, 2.0);
+  }
+  SIM_AddTouch(inputs[2], 1000 * MS, 2000 * MS, 10.0);
+  CHECK_EQ(scanUntil(1500 * MS, 2), 1);
+  CHECK(CAPSENSE_getPressed(2));
+  CHECK(!CAPSENSE_getPressed(0));
+  CHECK_EQ(scanUntil(3000 * MS, 2), 0);
+  CHECK(!CAPSENSE_getPressed(2));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   With only three channels a touch of one of them is left out of the
+ *   common mode, so it neither lifts the other two nor hides itself, with
+ *   and without a shift of all electrodes.
+ ******************************************************************************/
+static void testOneTouchOfThree(void)
+{
+  uint64_t shiftEnd = 0;
+  uint64_t next;
+  uint32_t pressedFrames = 0;
+  uint32_t falseFrames = 0;
+  uint32_t touchFrames = 0;
+  int shift;
+  int i;
+
+  for (shift = 0; shift < 2; shift++) {
+    setup();
+    CAPSENSE_CtxInit(&ctx, inputs, NULL, state, 3);
+    if (shift) {
+      shiftEnd = 4100 * MS;
+      for (i = 0; i < 3; i++) {
+        SIM_AddTouch(inputs[i], 100 * MS, shiftEnd, 2.0);
+      }
+    }
+    SIM_AddTouch(inputs[1], 1000 * MS, 3000 * MS, 10.0);
+
+    while (SIM_Now() < 4000 * MS) {
+      next = SIM_Now() + 20 * MS;
+      CHECK(CAPSENSE_CtxSense(&ctx));
+      if ((SIM_Now() > 1100 * MS) && (SIM_Now() < 3000 * MS)) {
+        touchFrames++;
+        pressedFrames += CAPSENSE_CtxGetPressed(&ctx, 1);
+      }
+      falseFrames += CAPSENSE_CtxGetPressed(&ctx, 0)
+                     + CAPSENSE_CtxGetPressed(&ctx, 2);
+      if (SIM_Now() > 500 * MS) {
+        CHECK_NEAR(CAPSENSE_CtxGetVal(&ctx, 0), 296, 8);
+        CHECK_NEAR(CAPSENSE_CtxGetVal(&ctx, 2), 296, 8);
+      }
+      SIM_Run(next - SIM_Now());
+    }
+    CHECK(!CAPSENSE_CtxGetPressed(&ctx, 1));
+  }
+  CHECK_EQ(pressedFrames, touchFrames);
+  CHECK_EQ(falseFrames, 0);
+}
+
+int main(void)
+{
+  RUN(testCommonShift);
+  RUN(testTouchDuringShift);
+  RUN(testOneTouchOfThree);
+  return UNIT_Report();
+}
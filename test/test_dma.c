@@ -0,0 +1,147 @@
+/***************************************************************************//**
+ * @file
+ * @brief Tests of the scans with LDMA sample capture
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+static const double electrodePf[] = { 8.0, 10.0, 12.0, 14.0 };
+
+static volatile bool batchDone;
+static uint32_t batches;
+
+static void batchComplete(void)
+{
+  batches++;
+  batchDone = true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start from reset with four idle electrodes of different capacitance, so
+ *   a sample stored for the wrong channel shows up in its value.
+ ******************************************************************************/
+static void setup(void)
+{
+  CAPSENSE_Event_t event;
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], electrodePf[i], 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  while (CAPSENSE_GetEvent(&event)) {
+  }
+  batches = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The values of the LDMA batches are those of their own electrodes, 296
+ *   counts for 10 pF in the default window, with one LDMA interrupt and no
+ *   TIMER0 interrupt per batch.
+ ******************************************************************************/
+static void testDmaValues(void)
+{
+  uint32_t timerIrqs;
+  uint32_t ldmaIrqs;
+  uint32_t before;
+  uint64_t hostNs;
+  int i;
+
+  setup();
+  CHECK(CAPSENSE_Sense());
+  SIM_GetIsrStats(TIMER0_IRQn, &before, &hostNs);
+
+  CHECK(CAPSENSE_StartDmaScan(batchComplete));
+  CHECK(!CAPSENSE_StartDmaScan(batchComplete));
+  CHECK(!CAPSENSE_StartScan(NULL));
+  for (i = 0; i < 4; i++) {
+    batchDone = false;
+    CHECK(SIM_RunUntil(&batchDone, 10 * MS));
+  }
+  CAPSENSE_StopDmaScan();
+  // The ACMPs only run while scanning
+  CHECK_EQ(ACMP0->EN, 0);
+
+  CHECK_EQ(batches, 4);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_NEAR(CAPSENSE_getVal(i), 296 * 10.0 / electrodePf[i], 8);
+  }
+  SIM_GetIsrStats(TIMER0_IRQn, &timerIrqs, &hostNs);
+  SIM_GetIsrStats(LDMA_IRQn, &ldmaIrqs, &hostNs);
+  CHECK_EQ(timerIrqs, before);
+  CHECK_EQ(ldmaIrqs, 4);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Each window of the chain is the tuned window of its channel.
+ ******************************************************************************/
+static void testDmaWindows(void)
+{
+  uint32_t window;
+
+  setup();
+  window = CAPSENSE_getWindow(1);
+  CAPSENSE_setWindow(1, 2 * window);
+  CHECK(CAPSENSE_Sense());
+
+  CHECK(CAPSENSE_StartDmaScan(batchComplete));
+  batchDone = false;
+  CHECK(SIM_RunUntil(&batchDone, 10 * MS));
+  batchDone = false;
+  CHECK(SIM_RunUntil(&batchDone, 10 * MS));
+  CAPSENSE_StopDmaScan();
+
+  // A window of w ticks counts for w + 1 ticks
+  CHECK_NEAR(CAPSENSE_getVal(1), 296 * (2 * window + 1) / (window + 1), 16);
+  CHECK_NEAR(CAPSENSE_getVal(2), 296 * 10.0 / 12.0, 12);
+
+  // Interrupt chained scans run again after the LDMA is stopped
+  CHECK(CAPSENSE_StartScan(NULL));
+}
+
+int main(void)
+{
+  RUN(testDmaValues);
+  RUN(testDmaWindows);
+  return UNIT_Report();
+}
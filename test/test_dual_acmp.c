@@ -0,0 +1,171 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of channels measured in parallel on ACMP0 and ACMP1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+/* Built with CAPSENSE_CHANNEL_ACMP { 0, 1, 0, 1 } on PC1, PC2, PD1 and PD2,
+ * so the even pins are measured by ACMP1 on the CD bus. The default
+ * context scans the channels in pairs. A second context of the same
+ * channels without an ACMP map scans them one by one on ACMP0, with both
+ * halves of the CD bus allocated to it. */
+
+#define MS                      1000000ULL
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+static const CAPSENSE_BusAlloc_t serialBus = {
+  .cdbus = GPIO_CDBUSALLOC_CDODD0_ACMP0 | GPIO_CDBUSALLOC_CDEVEN0_ACMP0,
+};
+
+static CAPSENSE_Context_t serial;
+static CAPSENSE_ChannelState_t serialState[ACMP_CHANNELS];
+
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return (uint32_t) (SIM_Now() / MS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start from reset with four idle electrodes of different sizes.
+ ******************************************************************************/
+static void setup(void)
+{
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 8.0 + 2.0 * i, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  CAPSENSE_CtxInit(&serial, inputs, NULL, serialState, ACMP_CHANNELS);
+  CAPSENSE_CtxSetBusAlloc(&serial, &serialBus);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan both contexts every 20 ms through touches of a channel of each
+ *   ACMP. The counts agree to a pulse and the pressed states exactly. A
+ *   parallel frame takes half the time of a serial one.
+ ******************************************************************************/
+static void testMatchesSerial(void)
+{
+  uint64_t parallelNs = 0;
+  uint64_t serialNs = 0;
+  uint64_t start;
+  uint32_t pressed = 0;
+  uint32_t wrongCounts = 0;
+  uint32_t wrongPressed = 0;
+  uint64_t t;
+  int i;
+
+  setup();
+  // The touch edges fall between the scans
+  SIM_AddTouch(inputs[1], 210 * MS, 610 * MS, 5.0);
+  SIM_AddTouch(inputs[2], 410 * MS, 810 * MS, 5.0);
+
+  for (t = 0; t < 1000 * MS; t += 20 * MS) {
+    start = SIM_Now();
+    CHECK(CAPSENSE_Sense());
+    parallelNs += SIM_Now() - start;
+    start = SIM_Now();
+    CHECK(CAPSENSE_CtxSense(&serial));
+    serialNs += SIM_Now() - start;
+
+    for (i = 0; i < ACMP_CHANNELS; i++) {
+      if ((CAPSENSE_getVal(i) > CAPSENSE_CtxGetVal(&serial, i) + 1)
+          || (CAPSENSE_CtxGetVal(&serial, i) > CAPSENSE_getVal(i) + 1)) {
+        wrongCounts++;
+      }
+      if (CAPSENSE_getPressed(i) != CAPSENSE_CtxGetPressed(&serial, i)) {
+        wrongPressed++;
+      }
+      if (CAPSENSE_getPressed(i)) {
+        pressed |= 1UL << i;
+      }
+    }
+    SIM_Run(t + 20 * MS - SIM_Now());
+  }
+
+  CHECK_EQ(wrongCounts, 0);
+  CHECK_EQ(wrongPressed, 0);
+  CHECK_EQ(pressed, 0x6);
+  CHECK_NEAR(parallelNs * 2, serialNs, serialNs / 10);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The scan table of the default context pairs the channels of
+ *   CAPSENSE_CHANNEL_ACMP, and the one of the serial context has one step
+ *   per channel on ACMP0.
+ ******************************************************************************/
+static void testScanTable(void)
+{
+  static const uint8_t acmpOf[] = CAPSENSE_CHANNEL_ACMP;
+  const CAPSENSE_Context_t *ctx;
+  const CAPSENSE_ScanStep_t *step;
+  uint8_t channel;
+  int s;
+  int a;
+
+  setup();
+  ctx = CAPSENSE_GetDefaultContext();
+  CHECK_EQ(ctx->numSteps, 2);
+  for (s = 0; s < ctx->numSteps; s++) {
+    step = &ctx->steps[s];
+    for (a = 0; a < CAPSENSE_ACMPS; a++) {
+      channel = step->channel[a];
+      CHECK_EQ(channel, 2 * s + a);
+      CHECK_EQ(acmpOf[channel], a);
+      CHECK_EQ(step->input[a],
+               (uint32_t) inputs[channel] << _ACMP_INPUTCTRL_POSSEL_SHIFT);
+    }
+  }
+
+  CHECK_EQ(serial.numSteps, ACMP_CHANNELS);
+  for (s = 0; s < serial.numSteps; s++) {
+    CHECK_EQ(serial.steps[s].channel[0], s);
+    CHECK_EQ(serial.steps[s].channel[1], 0xFF);
+  }
+}
+
+int main(void)
+{
+  RUN(testMatchesSerial);
+  RUN(testScanTable);
+  return UNIT_Report();
+}
@@ -0,0 +1,150 @@
+/***************************************************************************//**
+ * @file
+ * @brief Tests of the slider gestures of the example application
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+/* The example application of src/main.c, renamed by the build, runs with
+ * the test configuration, where the four electrodes form the slider of
+ * CAPSENSE_SLIDER_MAP. Its gestures are scripted as 5 pF touches. */
+
+#define MS                      1000000ULL
+
+int app_main(void);
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static uint64_t ledOn[2];
+static uint64_t ledOff[2];
+static jmp_buf testEnd;
+
+static void ledChanged(int led, bool on, uint64_t ns)
+{
+  if (on) {
+    ledOn[led] = ns;
+  } else {
+    ledOff[led] = ns;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Script a swipe over the electrodes, each touched for 80 ms and 40 ms
+ *   after the previous one.
+ ******************************************************************************/
+static void addSwipe(uint64_t start, bool up)
+{
+  uint64_t t;
+  int i;
+
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    t = start + (uint64_t) i * 40 * MS;
+    SIM_AddTouch(inputs[up ? i : ACMP_CHANNELS - 1 - i], t, t + 80 * MS, 5.0);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the application for a time with the scripted touches.
+ ******************************************************************************/
+static void run(uint64_t end)
+{
+  SIM_SetEnd(end, &testEnd);
+  if (setjmp(testEnd) == 0) {
+    app_main();
+  }
+}
+
+static void setup(void)
+{
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.0, 0.0);
+  }
+  SIM_SetLedHook(ledChanged);
+  for (i = 0; i < 2; i++) {
+    ledOn[i] = 0;
+    ledOff[i] = 0;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A swipe up turns on LED1 and a swipe down turns it off again.
+ ******************************************************************************/
+static void testSwipes(void)
+{
+  setup();
+  addSwipe(500 * MS, true);
+  addSwipe(1200 * MS, false);
+  run(1800 * MS);
+
+  CHECK(ledOn[1] > 500 * MS);
+  CHECK(ledOn[1] < 900 * MS);
+  CHECK(ledOff[1] > 1200 * MS);
+  CHECK(ledOff[1] < 1600 * MS);
+  CHECK(!SIM_GetLed(0));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A double tap toggles LED0, a single tap does nothing.
+ ******************************************************************************/
+static void testDoubleTap(void)
+{
+  setup();
+  SIM_AddTouch(inputs[1], 500 * MS, 580 * MS, 5.0);
+  SIM_AddTouch(inputs[1], 1200 * MS, 1280 * MS, 5.0);
+  SIM_AddTouch(inputs[1], 1400 * MS, 1480 * MS, 5.0);
+  run(1800 * MS);
+
+  CHECK(ledOn[0] > 1400 * MS);
+  CHECK(ledOn[0] < 1600 * MS);
+  CHECK(SIM_GetLed(0));
+  CHECK(!SIM_GetLed(1));
+}
+
+int main(void)
+{
+  RUN(testSwipes);
+  RUN(testDoubleTap);
+  return UNIT_Report();
+}
@@ -0,0 +1,149 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of the filter pipeline
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+/* Built with CAPSENSE_FILTER_OVERSAMPLE_SHIFT 1, CAPSENSE_FILTER_MEDIAN and
+ * CAPSENSE_FILTER_IIR_SHIFT 2, so every second sample gives an output. */
+
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+
+/***************************************************************************//**
+ * @brief
+ *   Run pairs of samples of channel 0 through a fresh filter and collect
+ *   the value after each pair.
+ ******************************************************************************/
+static void filter(const uint16_t *samples, uint32_t count, uint32_t *values)
+{
+  uint32_t s;
+
+  CAPSENSE_CtxInit(&ctx, NULL, NULL, state, CAPSENSE_MAX_CHANNELS);
+  memset(&batch, 0, sizeof(batch));
+  batch.frames = count;
+  for (s = 0; s < count; s++) {
+    batch.counts[0][s] = samples[s];
+  }
+  CAPSENSE_CtxProcessBatch(&ctx, &batch);
+  for (s = 1; s < count; s += 2) {
+    values[s / 2] = batch.values[0][s];
+  }
+}
+
+static void testConstant(void)
+{
+  static const uint16_t samples[] = { 1000, 1000, 1000, 1000, 1000, 1000 };
+  uint32_t values[3];
+
+  filter(samples, 6, values);
+  CHECK_EQ(values[0], 1000);
+  CHECK_EQ(values[2], 1000);
+}
+
+static void testOversample(void)
+{
+  static const uint16_t samples[] = { 1000, 1002 };
+  uint32_t values[1];
+
+  filter(samples, 2, values);
+  // The first sample only accumulates
+  CHECK_EQ(batch.values[0][0], 0);
+  CHECK_EQ(values[0], 1001);
+}
+
+static void testMedian(void)
+{
+  static const uint16_t samples[] = {
+    1000, 1000, 1000, 1000, 5000, 5000, 1000, 1000, 1000, 1000
+  };
+  uint32_t values[5];
+  int i;
+
+  filter(samples, 10, values);
+  for (i = 0; i < 5; i++) {
+    CHECK_EQ(values[i], 1000);
+  }
+}
+
+static void testIir(void)
+{
+  static const uint16_t samples[] = {
+    1000, 1000, 1000, 1000, 2000, 2000, 2000, 2000, 2000, 2000
+  };
+  static const uint32_t expected[] = { 1000, 1000, 1000, 1250, 1437 };
+  uint32_t values[5];
+  int i;
+
+  filter(samples, 10, values);
+  // The median delays the step by one value, the IIR smooths it
+  for (i = 0; i < 5; i++) {
+    CHECK_EQ(values[i], expected[i]);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Only the second sample of each oversampled pair gives a new value, the
+ *   first one is left out of the valid mask of its frame.
+ ******************************************************************************/
+static void testValid(void)
+{
+  static const uint16_t samples[] = { 1000, 1000, 1000, 1000 };
+  uint32_t values[2];
+  uint32_t all = (1UL << CAPSENSE_MAX_CHANNELS) - 1;
+
+  filter(samples, 4, values);
+  CHECK_EQ(batch.valid[0], 0);
+  CHECK_EQ(batch.valid[1], all);
+  CHECK_EQ(batch.valid[2], 0);
+  CHECK_EQ(batch.valid[3], all);
+}
+
+int main(void)
+{
+  SIM_Reset();
+  RUN(testConstant);
+  RUN(testOversample);
+  RUN(testMedian);
+  RUN(testIir);
+  RUN(testValid);
+  return UNIT_Report();
+}
@@ -0,0 +1,267 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of scans at several ACMP resistor settings
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+
+/* Built with three resistor settings as test_frequencies, and without
+ * CAPSENSE_NUM_FREQUENCIES as test_frequencies_single, which only runs and
+ * reports testToneLatency() for comparison. */
+
+/** Touches of the tone interference script, 400 ms each */
+#define TONE_TOUCHES            20
+/** Beat of the tone with the 1 MHz oscillation of the default setting */
+#define TONE_BEAT_HZ            7.0
+/** Capacitance swing of the beat */
+#define TONE_PF                 4.0
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+/***************************************************************************//**
+ * @brief
+ *   Event timestamps in virtual milliseconds.
+ ******************************************************************************/
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return (uint32_t) (SIM_Now() / MS);
+}
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+/***************************************************************************//**
+ * @brief
+ *   Idle 10 pF electrodes with 1 pF of interference that only couples in
+ *   while ACMP0 runs at the second resistor setting.
+ ******************************************************************************/
+static double disturbed(uint32_t input, uint64_t ns)
+{
+  uint32_t resistor = (ACMP0->INPUTCTRL & _ACMP_INPUTCTRL_CSRESSEL_MASK)
+                      >> _ACMP_INPUTCTRL_CSRESSEL_SHIFT;
+
+  if (resistor == (uint32_t) acmpResistor3) {
+    return 10.0 + SIM_Gaussian(input, ns / 100000);
+  }
+  return 10.0;
+}
+
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   A 1 MHz tone, such as a switching supply, couples into the oscillation
+ *   of the default resistor setting, 1 MHz at 10 pF, and beats with it at
+ *   TONE_BEAT_HZ. The other settings are far from the tone.
+ ******************************************************************************/
+static double tone(uint32_t input, uint64_t ns)
+{
+  uint32_t resistor = (ACMP0->INPUTCTRL & _ACMP_INPUTCTRL_CSRESSEL_MASK)
+                      >> _ACMP_INPUTCTRL_CSRESSEL_SHIFT;
+  double pf = SIM_Electrode(input, ns);
+
+  if (resistor == (uint32_t) acmpResistor5) {
+    pf += TONE_PF * sin(2.0 * M_PI * TONE_BEAT_HZ * (double) ns / 1e9);
+  }
+  return pf;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start from reset with four idle 10 pF electrodes.
+ ******************************************************************************/
+static void setup(void)
+{
+  CAPSENSE_Event_t event;
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  while (CAPSENSE_GetEvent(&event)) {
+  }
+}
+
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+/***************************************************************************//**
+ * @brief
+ *   Scan every 20 ms for a number of frames and get the smallest and
+ *   largest value of a channel.
+ ******************************************************************************/
+static void scanFrames(uint32_t frames, uint8_t channel,
+                       uint32_t *min, uint32_t *max)
+{
+  uint32_t value;
+
+  *min = UINT32_MAX;
+  *max = 0;
+  while (frames-- > 0) {
+    uint64_t next = SIM_Now() + 20 * MS;
+
+    CHECK(CAPSENSE_Sense());
+    value = CAPSENSE_getVal(channel);
+    *min = (value < *min) ? value : *min;
+    *max = (value > *max) ? value : *max;
+    SIM_Run(next - SIM_Now());
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The counts of the other settings are scaled to the 296 counts of the
+ *   first one.
+ ******************************************************************************/
+static void testCombined(void)
+{
+  uint32_t min;
+  uint32_t max;
+  int i;
+
+  setup();
+  scanFrames(50, 0, &min, &max);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_NEAR(CAPSENSE_getVal(i), 296, 6);
+    CHECK(!CAPSENSE_getPressed(i));
+  }
+  CHECK(max - min <= 4);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The noisy setting loses its weight, so the combined count stays about
+ *   as quiet as the clean settings.
+ ******************************************************************************/
+static void testInterference(void)
+{
+  uint32_t min;
+  uint32_t max;
+
+  setup();
+  SIM_SetWaveform(disturbed);
+  // Let the noise estimates settle
+  scanFrames(100, 1, &min, &max);
+  scanFrames(100, 1, &min, &max);
+  CHECK_NEAR(min, 296, 8);
+  CHECK_NEAR(max, 296, 8);
+  CHECK(!CAPSENSE_getPressed(1));
+}
+
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Touch channel 2 TONE_TOUCHES times under tone interference, scanning
+ *   every 20 ms, and report the touches detected, the detection latency
+ *   and the false presses. With three settings every touch is detected
+ *   within 100 ms and nothing else presses.
+ ******************************************************************************/
+static void testToneLatency(void)
+{
+  CAPSENSE_Event_t event;
+  uint64_t starts[TONE_TOUCHES];
+  uint64_t next;
+  uint64_t latency;
+  uint64_t latencyTotal = 0;
+  uint64_t latencyMax = 0;
+  uint32_t detected = 0;
+  uint32_t falsePresses = 0;
+  uint32_t t = 0;
+  bool counted = false;
+  int i;
+
+  setup();
+  SIM_SetWaveform(tone);
+  for (i = 0; i < TONE_TOUCHES; i++) {
+    starts[i] = 5000 * MS + (uint64_t) i * 1500 * MS;
+    SIM_AddTouch(inputs[2], starts[i], starts[i] + 400 * MS, 5.0);
+  }
+
+  while (SIM_Now() < starts[TONE_TOUCHES - 1] + 1500 * MS) {
+    next = SIM_Now() + 20 * MS;
+    CHECK(CAPSENSE_Sense());
+    while ((t + 1 < TONE_TOUCHES) && (SIM_Now() >= starts[t + 1])) {
+      t++;
+      counted = false;
+    }
+    while (CAPSENSE_GetEvent(&event)) {
+      if (event.type != CAPSENSE_EVENT_PRESS) {
+        continue;
+      }
+      latency = (uint64_t) event.timestamp * MS - starts[t];
+      if ((event.channel == 2) && !counted && (SIM_Now() >= starts[t])
+          && (latency < 400 * MS)) {
+        counted = true;
+        detected++;
+        latencyTotal += latency;
+        latencyMax = (latency > latencyMax) ? latency : latencyMax;
+      } else {
+        falsePresses++;
+      }
+    }
+    SIM_Run(next - SIM_Now());
+  }
+
+  printf("%s: %lu of %u touches detected, latency avg %.1f ms, "
+         "max %.1f ms, %lu false presses\n",
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+         "3 settings",
+#else
+         "1 setting",
+#endif
+         (unsigned long) detected, TONE_TOUCHES,
+         detected ? (double) latencyTotal / detected / MS : 0.0,
+         (double) latencyMax / MS, (unsigned long) falsePresses);
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  CHECK_EQ(detected, TONE_TOUCHES);
+  CHECK(latencyMax <= 100 * MS);
+  CHECK_EQ(falsePresses, 0);
+#endif
+}
+
+int main(void)
+{
+#if (CAPSENSE_NUM_FREQUENCIES > 1)
+  RUN(testCombined);
+  RUN(testInterference);
+#endif
+  RUN(testToneLatency);
+  return UNIT_Report();
+}
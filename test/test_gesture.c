@@ -0,0 +1,342 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of the slider gesture recognizer
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+
+#include "capsense_gesture.h"
+#include "sim.h"
+#include "bench.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+/** Scripted gestures of each type in the replay */
+#define REPLAY_EACH             10
+/** Time from the start of one scripted gesture to the next */
+#define REPLAY_SPACING_NS       (1500 * MS)
+/** Frame period of the replay */
+#define REPLAY_FRAME_NS         (20 * MS)
+
+/** A scripted finger movement on the slider, in channel units */
+typedef struct {
+  CAPSENSE_GestureType_t type;    /**< The gesture it should give */
+  double from;                    /**< Position at touch down */
+  double to;                      /**< Position at the end */
+} Replay_t;
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static CAPSENSE_Gesture_t gesture;
+static Replay_t replay[4 * REPLAY_EACH];
+
+/***************************************************************************//**
+ * @brief
+ *   Feed a touch at a fixed position, one update every 20 ms from start up
+ *   to end, and release it at end.
+ ******************************************************************************/
+static void touch(int32_t position, uint32_t start, uint32_t end)
+{
+  uint32_t t;
+
+  for (t = start; t < end; t += 20) {
+    CAPSENSE_GestureUpdate(&gesture, position, t);
+  }
+  CAPSENSE_GestureUpdate(&gesture, -1, end);
+}
+
+static void testTap(void)
+{
+  CAPSENSE_GestureEvent_t event;
+
+  CAPSENSE_GestureInit(&gesture);
+  touch(30, 0, 120);
+  // A tap waits for a possible second tap
+  CHECK(!CAPSENSE_GestureGetEvent(&gesture, &event));
+  CAPSENSE_GestureUpdate(&gesture, -1, 120 + CAPSENSE_GESTURE_DOUBLE_TAP_MS + 20);
+  CHECK(CAPSENSE_GestureGetEvent(&gesture, &event));
+  CHECK_EQ(event.type, CAPSENSE_GESTURE_TAP);
+  CHECK_EQ(event.position, 30);
+  CHECK_EQ(event.timestamp, 120);
+  CHECK(!CAPSENSE_GestureGetEvent(&gesture, &event));
+}
+
+static void testDoubleTap(void)
+{
+  CAPSENSE_GestureEvent_t event;
+
+  CAPSENSE_GestureInit(&gesture);
+  touch(30, 0, 80);
+  touch(34, 200, 280);
+  CHECK(CAPSENSE_GestureGetEvent(&gesture, &event));
+  CHECK_EQ(event.type, CAPSENSE_GESTURE_DOUBLE_TAP);
+  CHECK_EQ(event.timestamp, 280);
+  CHECK(!CAPSENSE_GestureGetEvent(&gesture, &event));
+}
+
+static void testSwipe(void)
+{
+  CAPSENSE_GestureEvent_t event;
+  uint32_t t;
+
+  CAPSENSE_GestureInit(&gesture);
+  for (t = 0; t <= 80; t += 20) {
+    CAPSENSE_GestureUpdate(&gesture, (int32_t) t / 2, t);
+  }
+  CAPSENSE_GestureUpdate(&gesture, -1, 100);
+  CHECK(CAPSENSE_GestureGetEvent(&gesture, &event));
+  CHECK_EQ(event.type, CAPSENSE_GESTURE_SWIPE);
+  CHECK_EQ(event.position, 40);
+  // 40 units in 80 ms
+  CHECK_EQ(event.speed, 500);
+  CHECK(!CAPSENSE_GestureGetEvent(&gesture, &event));
+}
+
+static void testHoldAndDrag(void)
+{
+  CAPSENSE_GestureEvent_t event;
+  uint32_t t;
+
+  CAPSENSE_GestureInit(&gesture);
+  for (t = 0; t <= 600; t += 20) {
+    CAPSENSE_GestureUpdate(&gesture, 30, t);
+  }
+  CAPSENSE_GestureUpdate(&gesture, 38, 620);
+  CAPSENSE_GestureUpdate(&gesture, -1, 640);
+
+  CHECK(CAPSENSE_GestureGetEvent(&gesture, &event));
+  CHECK_EQ(event.type, CAPSENSE_GESTURE_HOLD);
+  CHECK_EQ(event.timestamp, CAPSENSE_GESTURE_HOLD_MS);
+  CHECK(CAPSENSE_GestureGetEvent(&gesture, &event));
+  CHECK_EQ(event.type, CAPSENSE_GESTURE_DRAG);
+  CHECK_EQ(event.position, 38);
+  CHECK(CAPSENSE_GestureGetEvent(&gesture, &event));
+  CHECK_EQ(event.type, CAPSENSE_GESTURE_HOLD_END);
+  CHECK_EQ(event.timestamp, 640);
+  CHECK(!CAPSENSE_GestureGetEvent(&gesture, &event));
+}
+
+static void testSlowMove(void)
+{
+  CAPSENSE_GestureEvent_t event;
+  uint32_t t;
+
+  // Moves too slowly for a swipe and never holds still for a hold
+  CAPSENSE_GestureInit(&gesture);
+  for (t = 0; t <= 800; t += 20) {
+    CAPSENSE_GestureUpdate(&gesture, (int32_t) t / 20, t);
+  }
+  CAPSENSE_GestureUpdate(&gesture, -1, 820);
+  CHECK(!CAPSENSE_GestureGetEvent(&gesture, &event));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the finger position of the replay at a time.
+ *
+ * @return
+ *   false if the slider is not touched.
+ ******************************************************************************/
+static bool finger(uint64_t ns, double *position)
+{
+  const Replay_t *g;
+  uint64_t t = ns % REPLAY_SPACING_NS;
+  uint32_t i = (uint32_t) (ns / REPLAY_SPACING_NS);
+
+  // The baselines are measured before the first gesture
+  if ((i == 0) || (i > sizeof(replay) / sizeof(replay[0]))) {
+    return false;
+  }
+  g = &replay[i - 1];
+  *position = g->from;
+  switch (g->type) {
+    case CAPSENSE_GESTURE_TAP:
+      return t < 100 * MS;
+    case CAPSENSE_GESTURE_DOUBLE_TAP:
+      return (t < 80 * MS) || ((t >= 200 * MS) && (t < 280 * MS));
+    case CAPSENSE_GESTURE_SWIPE:
+      *position = g->from + (g->to - g->from) * (double) t / (300.0 * MS);
+      return t < 300 * MS;
+    default:
+      // Hold still, then drag to the end position
+      if (t > 700 * MS) {
+        *position = g->from + (g->to - g->from) * (double) (t - 700 * MS)
+                    / (200.0 * MS);
+      }
+      return t < 900 * MS;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The capacitance of a slider electrode, 10 pF plus up to 5 pF under the
+ *   finger, spread over the neighbouring electrodes.
+ ******************************************************************************/
+static double fingerWaveform(uint32_t input, uint64_t ns)
+{
+  double position;
+  double distance;
+  double pf = SIM_Electrode(input, ns);
+  int i;
+
+  if (!finger(ns, &position)) {
+    return pf;
+  }
+  for (i = 0; i < NUM_SLIDER_CHANNELS; i++) {
+    if (inputs[i] == input) {
+      distance = (position > i) ? (position - i) : (i - position);
+      if (distance < 1.0) {
+        pf += 5.0 * (1.0 - distance);
+      }
+    }
+  }
+  return pf;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check the events of one scripted gesture.
+ ******************************************************************************/
+static bool recognized(const Replay_t *g, const CAPSENSE_GestureEvent_t *events,
+                       uint32_t count)
+{
+  uint32_t i;
+
+  switch (g->type) {
+    case CAPSENSE_GESTURE_SWIPE:
+      return (count == 1) && (events[0].type == CAPSENSE_GESTURE_SWIPE)
+             && ((events[0].speed > 0) == (g->to > g->from));
+    case CAPSENSE_GESTURE_HOLD:
+      if ((count < 3) || (events[0].type != CAPSENSE_GESTURE_HOLD)
+          || (events[count - 1].type != CAPSENSE_GESTURE_HOLD_END)) {
+        return false;
+      }
+      for (i = 1; i < count - 1; i++) {
+        if (events[i].type != CAPSENSE_GESTURE_DRAG) {
+          return false;
+        }
+      }
+      return true;
+    default:
+      return (count == 1) && (events[0].type == g->type);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Replay scripted finger movements on the simulated slider of the test
+ *   configuration, scanned every 20 ms with some noise, and report the
+ *   share of gestures recognized and the cost of a recognizer update.
+ ******************************************************************************/
+static void testReplay(void)
+{
+  static const CAPSENSE_GestureType_t types[] = {
+    CAPSENSE_GESTURE_TAP, CAPSENSE_GESTURE_DOUBLE_TAP,
+    CAPSENSE_GESTURE_SWIPE, CAPSENSE_GESTURE_HOLD
+  };
+  const uint32_t gestures = sizeof(replay) / sizeof(replay[0]);
+  CAPSENSE_GestureEvent_t events[8];
+  CAPSENSE_GestureEvent_t event;
+  uint32_t count = 0;
+  uint32_t current = 0;
+  uint32_t correct = 0;
+  uint32_t frames = 0;
+  uint32_t seed = 7;
+  uint64_t updateNs = 0;
+  uint64_t start;
+  uint64_t t;
+  uint32_t i;
+  int32_t position;
+
+  for (i = 0; i < gestures; i++) {
+    seed = seed * 1103515245 + 12345;
+    replay[i].type = types[i % 4];
+    replay[i].from = 0.3 + 2.4 * ((seed >> 16) & 0xFF) / 255.0;
+    replay[i].to = replay[i].from;
+    if (replay[i].type == CAPSENSE_GESTURE_SWIPE) {
+      replay[i].from = (i & 4) ? 0.2 : 2.8;
+      replay[i].to = 3.0 - replay[i].from;
+    } else if (replay[i].type == CAPSENSE_GESTURE_HOLD) {
+      replay[i].to = (replay[i].from > 1.5) ? replay[i].from - 0.8
+                     : replay[i].from + 0.8;
+    }
+  }
+
+  SIM_Reset();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.0, 0.05);
+  }
+  SIM_SetWaveform(fingerWaveform);
+  CAPSENSE_Init();
+  CAPSENSE_GestureInit(&gesture);
+
+  for (t = REPLAY_FRAME_NS; t < (gestures + 1) * REPLAY_SPACING_NS;
+       t += REPLAY_FRAME_NS) {
+    SIM_Run(t - SIM_Now());
+    CHECK(CAPSENSE_Sense());
+    position = CAPSENSE_getSliderPosition();
+    start = BENCH_HostNs();
+    CAPSENSE_GestureUpdate(&gesture, position, (uint32_t) (t / MS));
+    updateNs += BENCH_HostNs() - start;
+    frames++;
+
+    while (CAPSENSE_GestureGetEvent(&gesture, &event)) {
+      if ((event.timestamp / (REPLAY_SPACING_NS / MS)) - 1 != current) {
+        correct += recognized(&replay[current], events, count);
+        current = event.timestamp / (REPLAY_SPACING_NS / MS) - 1;
+        count = 0;
+      }
+      if (count < 8) {
+        events[count++] = event;
+      }
+    }
+  }
+  correct += recognized(&replay[current], events, count);
+
+  printf("gestures recognized %lu of %lu, %.0f host ns per update\n",
+         (unsigned long) correct, (unsigned long) gestures,
+         (double) updateNs / frames);
+  CHECK(correct * 100 >= gestures * 95);
+}
+
+int main(void)
+{
+  RUN(testTap);
+  RUN(testDoubleTap);
+  RUN(testSwipe);
+  RUN(testHoldAndDrag);
+  RUN(testSlowMove);
+  RUN(testReplay);
+  return UNIT_Report();
+}
@@ -0,0 +1,232 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of the row and column keypad on the simulated peripherals
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capsense_keypad.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+
+static const ACMP_Channel_TypeDef rows[] = { acmpInputPC1, acmpInputPC5 };
+static const ACMP_Channel_TypeDef columns[] = { acmpInputPD1, acmpInputPD3 };
+
+/* The full keypad of testAllKeys() has its rows on the port C/D bus and
+ * its columns on the port A and B buses, allocated per phase */
+static const ACMP_Channel_TypeDef allRows[] = {
+  acmpInputPC0, acmpInputPC1, acmpInputPC2, acmpInputPC3,
+  acmpInputPC4, acmpInputPC5, acmpInputPC6, acmpInputPC7
+};
+static const ACMP_Channel_TypeDef allColumns[] = {
+  acmpInputPA0, acmpInputPA1, acmpInputPA2, acmpInputPA3,
+  acmpInputPA4, acmpInputPA5, acmpInputPB0, acmpInputPB1
+};
+static const CAPSENSE_BusAlloc_t rowBus = {
+  .cdbus = GPIO_CDBUSALLOC_CDEVEN0_ACMP0 | GPIO_CDBUSALLOC_CDODD0_ACMP0,
+};
+static const CAPSENSE_BusAlloc_t columnBus = {
+  .abus = GPIO_ABUSALLOC_AEVEN0_ACMP0 | GPIO_ABUSALLOC_AODD0_ACMP0,
+  .bbus = GPIO_BBUSALLOC_BEVEN0_ACMP0 | GPIO_BBUSALLOC_BODD0_ACMP0,
+};
+
+static CAPSENSE_Keypad_t keypad;
+static volatile bool scanDone;
+
+static void scanComplete(void)
+{
+  scanDone = true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan the keypad and wait for the decode.
+ ******************************************************************************/
+static bool scan(void)
+{
+  scanDone = false;
+  if (!CAPSENSE_KeypadStartScan(&keypad, scanComplete)) {
+    return false;
+  }
+  return SIM_RunUntil(&scanDone, 10 * MS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start from reset with the baselines of an idle 2 x 2 keypad.
+ ******************************************************************************/
+static void setup(void)
+{
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < 2; i++) {
+    SIM_SetElectrode(rows[i], 10.0, 0.0, 0.0);
+    SIM_SetElectrode(columns[i], 10.0, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  CAPSENSE_KeypadInit(&keypad, rows, 2, NULL, columns, 2, NULL);
+  CHECK(scan());
+  SIM_Run(20 * MS);
+}
+
+static void testKey(void)
+{
+  setup();
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 0, 1));
+
+  // A finger on a key covers its row and its column electrode
+  SIM_AddTouch(rows[0], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  SIM_AddTouch(columns[1], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  CHECK(scan());
+  CHECK(CAPSENSE_KeypadGetKey(&keypad, 0, 1));
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 0, 0));
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 1, 1));
+  CHECK_EQ(CAPSENSE_KeypadGetMeasurements(&keypad), 4);
+
+  SIM_Run(200 * MS);
+  CHECK(scan());
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 0, 1));
+}
+
+static void testGhost(void)
+{
+  setup();
+  // Two keys on a diagonal, which can not be told from the other diagonal
+  SIM_AddTouch(rows[0], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  SIM_AddTouch(rows[1], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  SIM_AddTouch(columns[0], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  SIM_AddTouch(columns[1], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  CHECK(scan());
+  CHECK_EQ(CAPSENSE_KeypadGetGhosts(&keypad), 1);
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 0, 0));
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 1, 1));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A row or column beyond the keypad is not pressed, even where its index
+ *   would alias a pressed key.
+ ******************************************************************************/
+static void testKeyBounds(void)
+{
+  setup();
+  SIM_AddTouch(rows[1], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  SIM_AddTouch(columns[0], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  CHECK(scan());
+  CHECK(CAPSENSE_KeypadGetKey(&keypad, 1, 0));
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 0, 2));
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 2, 0));
+  CHECK(!CAPSENSE_KeypadGetKey(&keypad, 255, 255));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Touch every key of a keypad of CAPSENSE_KEYPAD_MAX_ROWS rows and
+ *   CAPSENSE_KEYPAD_MAX_COLUMNS columns in turn, scanned every 20 ms. Each
+ *   key decodes alone, and the keypad is released after it. The report
+ *   gives the measurements per frame against the number of keys.
+ ******************************************************************************/
+static void testAllKeys(void)
+{
+  const uint8_t numRows = CAPSENSE_KEYPAD_MAX_ROWS;
+  const uint8_t numColumns = CAPSENSE_KEYPAD_MAX_COLUMNS;
+  uint8_t keys[CAPSENSE_KEYPAD_KEY_BYTES];
+  uint8_t expected[CAPSENSE_KEYPAD_KEY_BYTES];
+  uint32_t measurements = 0;
+  uint32_t frames = 0;
+  uint32_t decoded = 0;
+  uint32_t released = 0;
+  uint64_t end;
+  uint8_t row;
+  uint8_t column;
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < numRows; i++) {
+    SIM_SetElectrode(allRows[i], 10.0, 0.0, 0.0);
+  }
+  for (i = 0; i < numColumns; i++) {
+    SIM_SetElectrode(allColumns[i], 10.0, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  CAPSENSE_KeypadInit(&keypad, allRows, numRows, &rowBus,
+                      allColumns, numColumns, &columnBus);
+  CHECK(scan());
+  SIM_Run(20 * MS);
+
+  for (row = 0; row < numRows; row++) {
+    for (column = 0; column < numColumns; column++) {
+      end = SIM_Now() + 100 * MS;
+      SIM_AddTouch(allRows[row], SIM_Now(), end, 5.0);
+      SIM_AddTouch(allColumns[column], SIM_Now(), end, 5.0);
+      // Scan through the touch and two frames after it
+      while (SIM_Now() < end + 40 * MS) {
+        CHECK(scan());
+        measurements += CAPSENSE_KeypadGetMeasurements(&keypad);
+        frames++;
+        CAPSENSE_KeypadGetKeys(&keypad, keys);
+        if ((SIM_Now() < end) && (SIM_Now() + 20 * MS >= end)) {
+          memset(expected, 0, sizeof(expected));
+          i = row * numColumns + column;
+          expected[i / 8] = (uint8_t) (1U << (i % 8));
+          decoded += memcmp(keys, expected, sizeof(keys)) == 0;
+        }
+        SIM_Run(20 * MS);
+      }
+      memset(expected, 0, sizeof(expected));
+      released += memcmp(keys, expected, sizeof(keys)) == 0;
+    }
+  }
+
+  printf("%u x %u keypad: %lu of %u keys decoded, "
+         "%.1f measurements per frame for %u keys\n",
+         numRows, numColumns, (unsigned long) decoded, numRows * numColumns,
+         (double) measurements / frames, numRows * numColumns);
+  CHECK_EQ(decoded, numRows * numColumns);
+  CHECK_EQ(released, numRows * numColumns);
+  CHECK(measurements <= frames * (numRows + numColumns));
+}
+
+int main(void)
+{
+  RUN(testKey);
+  RUN(testGhost);
+  RUN(testKeyBounds);
+  RUN(testAllKeys);
+  return UNIT_Report();
+}
@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file
+ * @brief Tests of the proximity sensor
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdio.h>
+
+#include "capsense.h"
+#include "capsense_proximity.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+#define ELECTRODE_PF            10.0
+#define NOISE_PF                0.1
+#define HAND_PF                 0.1
+
+/* The four electrodes of the test configuration form the proximity sensor.
+ * A hand adds HAND_PF to each of them, which lowers the summed counts by
+ * HAND_PF / (ELECTRODE_PF + HAND_PF), a signal of about 40/4096. */
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static CAPSENSE_Proximity_t prox;
+static volatile bool scanDone;
+
+static void scanComplete(void)
+{
+  scanDone = true;
+}
+
+static void setup(void)
+{
+  int i;
+
+  SIM_Reset();
+  SIM_Seed(11);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], ELECTRODE_PF, 0.0, NOISE_PF);
+  }
+  CAPSENSE_Init();
+  CHECK(CAPSENSE_ProximityInit(&prox, inputs, ACMP_CHANNELS, NULL));
+}
+
+static void hand(uint64_t durationNs)
+{
+  int i;
+
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_AddTouch(inputs[i], SIM_Now(), SIM_Now() + durationNs, HAND_PF);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run level updates and return the largest signal seen.
+ ******************************************************************************/
+static uint16_t updates(int count, int *nearUpdates)
+{
+  uint16_t signal = 0;
+  int i;
+
+  *nearUpdates = 0;
+  for (i = 0; i < count * CAPSENSE_PROXIMITY_FRAMES; i++) {
+    scanDone = false;
+    CHECK(CAPSENSE_ProximityStartScan(&prox, scanComplete));
+    CHECK(SIM_RunUntil(&scanDone, 100 * MS));
+    if (CAPSENSE_ProximityGetSignal(&prox) > signal) {
+      signal = CAPSENSE_ProximityGetSignal(&prox);
+    }
+    if (((i + 1) % CAPSENSE_PROXIMITY_FRAMES) == 0
+        && CAPSENSE_ProximityIsNear(&prox)) {
+      (*nearUpdates)++;
+    }
+  }
+  return signal;
+}
+
+static void testInitLimit(void)
+{
+  static const ACMP_Channel_TypeDef many[CAPSENSE_MAX_CHANNELS + 1] = { 0 };
+
+  setup();
+  CHECK(!CAPSENSE_ProximityInit(&prox, many, CAPSENSE_MAX_CHANNELS + 1, NULL));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A hand is reported near after one update and released once it leaves.
+ *   The signal is the drop of the summed counts in 1/4096, and the margin
+ *   between the noise and the hand is reported to tune the near level.
+ ******************************************************************************/
+static void testNearAndRelease(void)
+{
+  const uint32_t threshold = CAPSENSE_PROXIMITY_NEAR_LEVEL
+                             * CAPSENSE_PROXIMITY_RANGE / 255;
+  const double expected = 4096.0 * HAND_PF / (ELECTRODE_PF + HAND_PF);
+  uint16_t idle;
+  uint16_t near;
+  int nearUpdates;
+
+  setup();
+  idle = updates(50, &nearUpdates);
+  CHECK_EQ(nearUpdates, 0);
+  CHECK(idle < threshold);
+
+  hand(1000 * MS);
+  near = updates(10, &nearUpdates);
+  CHECK_EQ(nearUpdates, 10);
+  CHECK_NEAR(near, expected, 3);
+  CHECK_NEAR(CAPSENSE_ProximityGetLevel(&prox),
+             CAPSENSE_ProximityGetSignal(&prox) * 255
+             / CAPSENSE_PROXIMITY_RANGE, 1);
+
+  SIM_Run(1000 * MS);
+  updates(1, &nearUpdates);
+  CHECK_EQ(nearUpdates, 0);
+  CHECK(CAPSENSE_ProximityGetLevel(&prox) < CAPSENSE_PROXIMITY_NEAR_LEVEL / 2);
+
+  printf("signal margin: idle %u, near level %u, hand %u (%.1f expected), "
+         "%.1fx the near level, %.1fx the idle noise\n", (unsigned int) idle,
+         (unsigned int) threshold, (unsigned int) near, expected,
+         (double) near / threshold, (double) near / ((idle > 0) ? idle : 1));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The level grows linearly with the signal up to CAPSENSE_PROXIMITY_RANGE.
+ ******************************************************************************/
+static void testLevel(void)
+{
+  int nearUpdates;
+  uint32_t signal;
+  int i;
+
+  setup();
+  updates(10, &nearUpdates);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_AddTouch(inputs[i], SIM_Now(), SIM_Now() + 1000 * MS, HAND_PF / 4);
+  }
+  updates(2, &nearUpdates);
+  signal = CAPSENSE_ProximityGetSignal(&prox);
+  CHECK(signal < CAPSENSE_PROXIMITY_RANGE);
+  CHECK_NEAR(CAPSENSE_ProximityGetLevel(&prox),
+             signal * 255 / CAPSENSE_PROXIMITY_RANGE, 1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   An object left on the electrodes is taken into the baseline after
+ *   CAPSENSE_PROXIMITY_MAX_NEAR near updates.
+ ******************************************************************************/
+static void testRecalibrate(void)
+{
+  int nearUpdates;
+
+  setup();
+  updates(10, &nearUpdates);
+  hand(100000 * MS);
+  updates(CAPSENSE_PROXIMITY_MAX_NEAR + 10, &nearUpdates);
+  CHECK_EQ(nearUpdates, CAPSENSE_PROXIMITY_MAX_NEAR);
+  CHECK(!CAPSENSE_ProximityIsNear(&prox));
+}
+
+int main(void)
+{
+  RUN(testInitLimit);
+  RUN(testNearAndRelease);
+  RUN(testLevel);
+  RUN(testRecalibrate);
+  return UNIT_Report();
+}
@@ -0,0 +1,480 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host tests of interrupt driven scans on the simulated peripherals
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static volatile bool scanDone;
+static volatile bool wakeDone;
+static volatile bool wakeTouched;
+
+/***************************************************************************//**
+ * @brief
+ *   Event timestamps in virtual milliseconds.
+ ******************************************************************************/
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return (uint32_t) (SIM_Now() / MS);
+}
+
+static void scanComplete(void)
+{
+  scanDone = true;
+}
+
+static void wakeComplete(bool touched)
+{
+  wakeTouched = touched;
+  wakeDone = true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start from reset with four idle 10 pF electrodes.
+ ******************************************************************************/
+static void setup(void)
+{
+  CAPSENSE_Event_t event;
+  int i;
+
+  SIM_Reset();
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.0, 0.0);
+  }
+  CAPSENSE_Init();
+  while (CAPSENSE_GetEvent(&event)) {
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A 10 pF electrode oscillates at 1 MHz, so the default window of 11
+ *   TIMER0 ticks counts about 296 pulses.
+ ******************************************************************************/
+static void testSense(void)
+{
+  int i;
+
+  setup();
+  CHECK(CAPSENSE_Sense());
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_NEAR(CAPSENSE_getVal(i), 296, 12);
+    CHECK(!CAPSENSE_getPressed(i));
+  }
+  // The ACMPs only run while scanning
+  CHECK_EQ(ACMP0->EN, 0);
+}
+
+static void testAsyncScan(void)
+{
+  CAPSENSE_Frame_t frame;
+
+  setup();
+  scanDone = false;
+  CHECK(CAPSENSE_StartScan(scanComplete));
+  CHECK(!CAPSENSE_StartScan(scanComplete));
+  CHECK(!CAPSENSE_Sense());
+  CHECK(!CAPSENSE_TuneWindows());
+  CHECK(!CAPSENSE_ScanComplete());
+  CHECK(SIM_RunUntil(&scanDone, 10 * MS));
+  CHECK(CAPSENSE_ScanComplete());
+  CAPSENSE_GetFrame(&frame);
+  CHECK_EQ(frame.frame, 1);
+  CHECK_NEAR(frame.values[3], 296, 12);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   CAPSENSE_StartScan() returns without spending virtual time, and the
+ *   frame completes while the main loop does its own work. The only core
+ *   cycles beyond that work are those of the scan interrupts.
+ ******************************************************************************/
+static void testAsyncScanNoWait(void)
+{
+  uint64_t start;
+  uint32_t cycles;
+  uint32_t isrs;
+  uint32_t isrsBefore;
+  uint32_t loops = 0;
+  uint64_t hostNs;
+
+  setup();
+  SIM_GetIsrStats(TIMER0_IRQn, &isrsBefore, &hostNs);
+  start = SIM_Now();
+  cycles = DWT->CYCCNT;
+  scanDone = false;
+  CHECK(CAPSENSE_StartScan(scanComplete));
+  CHECK_EQ(SIM_Now(), start);
+  CHECK_EQ(DWT->CYCCNT, cycles);
+
+  // Application work in steps of 100 us until the frame is published
+  while (!scanDone && (loops < 1000)) {
+    SIM_Run(100000);
+    loops++;
+  }
+  CHECK(scanDone);
+  CHECK(loops > 1);
+  SIM_GetIsrStats(TIMER0_IRQn, &isrs, &hostNs);
+  CHECK_EQ(DWT->CYCCNT - cycles,
+           loops * (SIM_HFCLK_HZ / 10000)
+           + (isrs - isrsBefore) * SIM_ISR_CYCLES);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan every 20 ms through a 5 pF touch of channel 0 and check the
+ *   debounced events.
+ ******************************************************************************/
+static void testEvents(void)
+{
+  CAPSENSE_Event_t events[8];
+  uint32_t count = 0;
+  uint64_t t;
+
+  setup();
+  SIM_AddTouch(inputs[0], 200 * MS, 1500 * MS, 5.0);
+  for (t = 0; t < 2000 * MS; t += 20 * MS) {
+    CHECK(CAPSENSE_Sense());
+    while ((count < 8) && CAPSENSE_GetEvent(&events[count])) {
+      count++;
+    }
+    SIM_Run(t + 20 * MS - SIM_Now());
+  }
+
+  CHECK_EQ(count, 3);
+  CHECK_EQ(events[0].type, CAPSENSE_EVENT_PRESS);
+  CHECK_EQ(events[0].channel, 0);
+  // Two touched frames, the first one at 200 ms
+  CHECK_NEAR(events[0].timestamp, 220, 1);
+  CHECK_EQ(events[1].type, CAPSENSE_EVENT_LONG_PRESS);
+  CHECK_NEAR(events[1].timestamp, 220 + CAPSENSE_LONG_PRESS_MS, 20);
+  CHECK_EQ(events[2].type, CAPSENSE_EVENT_RELEASE);
+  CHECK_NEAR(events[2].timestamp, 1520, 1);
+  CHECK_EQ(CAPSENSE_GetDroppedEvents(), 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Script bursts of taps of 40 to 160 ms, with gaps of 40 to 160 ms, on
+ *   channels 0 to 2.
+ *
+ * @return
+ *   The number of taps.
+ ******************************************************************************/
+static uint32_t scriptBursts(uint32_t *taps)
+{
+  uint32_t seed = 12345;
+  uint32_t total = 0;
+  uint64_t on;
+  uint64_t off;
+  uint64_t t;
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    taps[i] = 0;
+    for (t = (5 + 13 * i) * MS; taps[i] < 20; taps[i]++) {
+      seed = seed * 1103515245 + 12345;
+      on = (40 + ((seed >> 16) % 121)) * MS;
+      seed = seed * 1103515245 + 12345;
+      off = (40 + ((seed >> 16) % 121)) * MS;
+      SIM_AddTouch(inputs[i], t, t + on, 5.0);
+      t += on + off;
+    }
+    total += taps[i];
+  }
+  return total;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan every 10 ms through bursts of taps on three channels and drain the
+ *   queue every 100 ms. Each tap gives one press and one release, in
+ *   order, and nothing is dropped.
+ ******************************************************************************/
+static void testBurstyEvents(void)
+{
+  CAPSENSE_Event_t event;
+  uint32_t taps[3];
+  uint32_t presses[3] = { 0 };
+  uint32_t releases[3] = { 0 };
+  uint32_t lastTime[3] = { 0 };
+  uint32_t wrong = 0;
+  uint64_t t;
+  int i;
+
+  setup();
+  scriptBursts(taps);
+  for (t = 0; t < 8000 * MS; t += 10 * MS) {
+    CHECK(CAPSENSE_Sense());
+    if ((t % (100 * MS)) == 0) {
+      while (CAPSENSE_GetEvent(&event)) {
+        i = event.channel;
+        if ((i > 2) || (event.timestamp < lastTime[i])) {
+          wrong++;
+          continue;
+        }
+        lastTime[i] = event.timestamp;
+        if ((event.type == CAPSENSE_EVENT_PRESS)
+            && (presses[i] == releases[i])) {
+          presses[i]++;
+        } else if ((event.type == CAPSENSE_EVENT_RELEASE)
+                   && (presses[i] == releases[i] + 1)) {
+          releases[i]++;
+        } else {
+          wrong++;
+        }
+      }
+    }
+    SIM_Run(t + 10 * MS - SIM_Now());
+  }
+
+  CHECK_EQ(wrong, 0);
+  for (i = 0; i < 3; i++) {
+    CHECK_EQ(presses[i], taps[i]);
+    CHECK_EQ(releases[i], taps[i]);
+  }
+  CHECK_EQ(CAPSENSE_GetDroppedEvents(), 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A consumer which drains the queue only once loses events, but each of
+ *   them is counted as dropped and none is delivered twice.
+ ******************************************************************************/
+static void testEventOverflow(void)
+{
+  CAPSENSE_Event_t event;
+  uint32_t taps[3];
+  uint32_t received = 0;
+  uint32_t total;
+  uint64_t t;
+
+  setup();
+  total = scriptBursts(taps);
+  for (t = 0; t < 8000 * MS; t += 10 * MS) {
+    CHECK(CAPSENSE_Sense());
+    SIM_Run(t + 10 * MS - SIM_Now());
+  }
+  while (CAPSENSE_GetEvent(&event)) {
+    received++;
+  }
+
+  CHECK_EQ(received, CAPSENSE_EVENT_QUEUE_SIZE);
+  CHECK_EQ(received + CAPSENSE_GetDroppedEvents(), 2 * total);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A wake scan only reports a channel below its touch threshold. Only the
+ *   warm-up window takes a TIMER0 interrupt, every channel ends its window
+ *   with one counter interrupt as soon as it reaches the threshold, so an
+ *   idle wake scan measures for less time than a full scan.
+ ******************************************************************************/
+static void testWakeScan(void)
+{
+  CAPSENSE_MeasureTicks_t before;
+  CAPSENSE_MeasureTicks_t after;
+  uint32_t senseTicks;
+  uint32_t timer0Before;
+  uint32_t timer0After;
+  uint32_t counterBefore;
+  uint32_t counterAfter;
+  uint32_t interrupts;
+  uint64_t hostNs;
+
+  setup();
+  CAPSENSE_GetMeasureTicks(&before);
+  CHECK(CAPSENSE_Sense());
+  CAPSENSE_GetMeasureTicks(&after);
+  senseTicks = after.timer0 - before.timer0;
+
+  SIM_GetIsrStats(TIMER0_IRQn, &timer0Before, &hostNs);
+  SIM_GetIsrStats(TIMER1_IRQn, &counterBefore, &hostNs);
+  interrupts = CAPSENSE_GetInterruptCount();
+  before = after;
+  wakeDone = false;
+  CHECK(CAPSENSE_StartWakeScan(wakeComplete));
+  CHECK(SIM_RunUntil(&wakeDone, 10 * MS));
+  CHECK(!wakeTouched);
+  CAPSENSE_GetMeasureTicks(&after);
+  SIM_GetIsrStats(TIMER0_IRQn, &timer0After, &hostNs);
+  SIM_GetIsrStats(TIMER1_IRQn, &counterAfter, &hostNs);
+  CHECK_EQ(timer0After - timer0Before, 1);
+  CHECK_EQ(counterAfter - counterBefore, ACMP_CHANNELS);
+  CHECK_EQ(CAPSENSE_GetInterruptCount() - interrupts, 1 + ACMP_CHANNELS);
+  CHECK(after.timer0 - before.timer0 < senseTicks);
+
+  SIM_AddTouch(inputs[2], SIM_Now(), SIM_Now() + 100 * MS, 5.0);
+  wakeDone = false;
+  CHECK(CAPSENSE_StartWakeScan(wakeComplete));
+  CHECK(SIM_RunUntil(&wakeDone, 10 * MS));
+  CHECK(wakeTouched);
+  // No frame is published by wake scans
+  CHECK(!CAPSENSE_getPressed(2));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A touch lowering the count by 1/8 must change it by 16 counts, which
+ *   needs 128 counts, or a window of 5 ticks at 1 MHz.
+ ******************************************************************************/
+static void testTuneWindows(void)
+{
+  int i;
+
+  setup();
+  CHECK(CAPSENSE_TuneWindows());
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_EQ(CAPSENSE_getWindow(i), 4);
+  }
+  CHECK(CAPSENSE_Sense());
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CHECK_NEAR(CAPSENSE_getVal(i), 135, 8);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The first channel of a scan is measured after the ACMP has started up,
+ *   so it reads the same as the others and the wake scan threshold holds.
+ ******************************************************************************/
+static void testAcmpStartup(void)
+{
+  setup();
+  CHECK(CAPSENSE_Sense());
+  CHECK_NEAR(CAPSENSE_getVal(0), CAPSENSE_getVal(3), 2);
+
+  CHECK(CAPSENSE_Sense());
+  CHECK_NEAR(CAPSENSE_getVal(0), CAPSENSE_getVal(3), 2);
+
+  wakeDone = false;
+  CHECK(CAPSENSE_StartWakeScan(wakeComplete));
+  CHECK(SIM_RunUntil(&wakeDone, 10 * MS));
+  CHECK(!wakeTouched);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check the scan table of a context against the channel configuration:
+ *   each channel in use is measured in step order on its ACMP, with the
+ *   INPUTCTRL input of CAPSENSE_CHANNELS, in a step with the longest window
+ *   of its channels.
+ ******************************************************************************/
+static void checkScanTable(const CAPSENSE_Context_t *ctx, const bool *inUse)
+{
+  const CAPSENSE_ScanStep_t *step;
+  uint32_t window;
+  uint8_t expected = 0;
+  uint8_t channel;
+  int s;
+
+  for (s = 0; s < ctx->numSteps; s++) {
+    step = &ctx->steps[s];
+    while ((expected < ACMP_CHANNELS) && inUse && !inUse[expected]) {
+      expected++;
+    }
+    channel = step->channel[0];
+    CHECK_EQ(channel, expected);
+    if (channel >= ACMP_CHANNELS) {
+      return;
+    }
+    CHECK_EQ(step->input[0],
+             (uint32_t) inputs[channel] << _ACMP_INPUTCTRL_POSSEL_SHIFT);
+    window = CAPSENSE_CtxGetWindow((CAPSENSE_Context_t *) ctx, channel);
+    CHECK_EQ(step->window, window);
+    expected++;
+  }
+  while ((expected < ACMP_CHANNELS) && inUse && !inUse[expected]) {
+    expected++;
+  }
+  // Every channel in use has a step
+  CHECK_EQ(expected, ACMP_CHANNELS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The scan table matches the configuration after CAPSENSE_Init(), after
+ *   window tuning and with a channel mask, and a masked scan only measures
+ *   the channels in use.
+ ******************************************************************************/
+static void testScanTable(void)
+{
+  static const bool inUse[ACMP_CHANNELS] = { true, false, true, false };
+  CAPSENSE_Context_t *ctx;
+  uint32_t before;
+  uint32_t after;
+  uint64_t hostNs;
+
+  setup();
+  ctx = CAPSENSE_GetDefaultContext();
+  CHECK_EQ(ctx->numSteps, ACMP_CHANNELS);
+  checkScanTable(ctx, NULL);
+
+  CHECK(CAPSENSE_TuneWindows());
+  checkScanTable(ctx, NULL);
+
+  CAPSENSE_CtxSetChannelMask(ctx, inUse);
+  CHECK_EQ(ctx->numSteps, 2);
+  checkScanTable(ctx, inUse);
+  SIM_GetIsrStats(TIMER0_IRQn, &before, &hostNs);
+  CHECK(CAPSENSE_Sense());
+  SIM_GetIsrStats(TIMER0_IRQn, &after, &hostNs);
+  // The warm-up window and the two channels in use
+  CHECK_EQ(after - before, 3);
+
+  CAPSENSE_CtxSetChannelMask(ctx, NULL);
+  checkScanTable(ctx, NULL);
+}
+
+int main(void)
+{
+  RUN(testSense);
+  RUN(testAsyncScan);
+  RUN(testAsyncScanNoWait);
+  RUN(testEvents);
+  RUN(testBurstyEvents);
+  RUN(testEventOverflow);
+  RUN(testWakeScan);
+  RUN(testTuneWindows);
+  RUN(testScanTable);
+  RUN(testAcmpStartup);
+  return UNIT_Report();
+}
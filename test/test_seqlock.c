@@ -0,0 +1,188 @@
+/***************************************************************************//**
+ * @file
+ * @brief Stress test of the frame snapshots against interrupting frame scans
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+/* A timer signal interrupts the test at arbitrary instructions, like
+ * an interrupt on the target. Its signal handler lets up to 3 ms of
+ * virtual time pass, which runs the TIMER0 interrupts of a chain of scans
+ * and publishes zero or more frames. Meanwhile the test copies frames with
+ * CAPSENSE_GetFrame(). All channels of frame n measure the same electrode
+ * capacitance, chosen by n, and the timestamp of each frame is recorded
+ * when it is published, so a snapshot mixing two frames is detected. */
+
+#define MS                      1000000ULL
+/** Frame snapshots copied by the test */
+#define STRESS_READS            2000000UL
+/** Largest virtual time run per signal */
+#define STRESS_MAX_RUN_NS       3000000ULL
+/** Frames whose timestamps are kept */
+#define STRESS_FRAMES           65536
+
+static volatile uint32_t published;
+static uint32_t timestamps[STRESS_FRAMES];
+static uint32_t runSeed = 1;
+
+/***************************************************************************//**
+ * @brief
+ *   Timestamps in units of 100 us, so frames about 1 ms apart differ.
+ ******************************************************************************/
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return (uint32_t) (SIM_Now() / 100000);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The capacitance of every electrode while frame n is scanned.
+ ******************************************************************************/
+static double framePf(uint32_t frame)
+{
+  return 5.0 + 5.0 * (frame % 4);
+}
+
+static double waveform(uint32_t input, uint64_t ns)
+{
+  (void) input;
+  (void) ns;
+  return framePf(published + 1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Record the published frame and chain the next scan.
+ ******************************************************************************/
+static void scanComplete(void)
+{
+  published++;
+  timestamps[published % STRESS_FRAMES] = CAPSENSE_GetTimestamp();
+  CAPSENSE_StartScan(scanComplete);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The interrupt, run a pseudo random part of a scan or a few scans.
+ ******************************************************************************/
+static void interrupt(int signal)
+{
+  (void) signal;
+  runSeed = runSeed * 1103515245 + 12345;
+  SIM_Run((runSeed >> 8) % STRESS_MAX_RUN_NS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The count of a 11 tick window at a capacitance, see test_scan.c.
+ ******************************************************************************/
+static uint32_t expectedCount(double pf)
+{
+  return (uint32_t) (296.0 * 10.0 / pf);
+}
+
+static void testStress(void)
+{
+  struct sigaction action;
+  struct sigevent event;
+  struct itimerspec period;
+  timer_t timer;
+  CAPSENSE_Frame_t frame;
+  uint32_t torn = 0;
+  uint32_t lastFrame = 0;
+  uint32_t newFrames = 0;
+  uint32_t expected;
+  uint32_t i;
+  int ch;
+
+  SIM_Reset();
+  SIM_SetWaveform(waveform);
+  CAPSENSE_Init();
+  published = 0;
+  CHECK(CAPSENSE_StartScan(scanComplete));
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = interrupt;
+  sigaction(SIGALRM, &action, NULL);
+  memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_SIGNAL;
+  event.sigev_signo = SIGALRM;
+  CHECK(timer_create(CLOCK_MONOTONIC, &event, &timer) == 0);
+  period.it_interval.tv_sec = 0;
+  period.it_interval.tv_nsec = 20000;
+  period.it_value = period.it_interval;
+  timer_settime(timer, 0, &period, NULL);
+
+  for (i = 0; i < STRESS_READS; i++) {
+    CAPSENSE_GetFrame(&frame);
+    if (frame.frame == 0) {
+      continue;
+    }
+    if (frame.frame != lastFrame) {
+      newFrames++;
+      lastFrame = frame.frame;
+    }
+    expected = expectedCount(framePf(frame.frame));
+    for (ch = 0; ch < ACMP_CHANNELS; ch++) {
+      if ((frame.values[ch] + 12 < expected)
+          || (frame.values[ch] > expected + 12)) {
+        torn++;
+        break;
+      }
+    }
+    if ((ch == ACMP_CHANNELS)
+        && (frame.timestamp != timestamps[frame.frame % STRESS_FRAMES])) {
+      torn++;
+    }
+  }
+
+  timer_delete(timer);
+  signal(SIGALRM, SIG_DFL);
+
+  CHECK_EQ(torn, 0);
+  // The reads overlapped many frames
+  CHECK(newFrames > 1000);
+}
+
+int main(void)
+{
+  RUN(testStress);
+  return UNIT_Report();
+}
@@ -0,0 +1,231 @@
+/***************************************************************************//**
+ * @file
+ * @brief Tests of the timing and noise statistics
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "capsense.h"
+#include "sim.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+#define US                      1000ULL
+#define SCANS                   50
+
+/* Built with CAPSENSE_STATS. The driver reads the cycles from the
+ * CAPSENSE_GetCycles() of the simulator, the virtual time at SIM_HFCLK_HZ
+ * plus SIM_ISR_CYCLES per interrupt, so the timing statistics can be
+ * checked against the simulated scans. */
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static volatile bool scanDone;
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[ACMP_CHANNELS];
+static CAPSENSE_Batch_t batch;
+
+static void scanComplete(void)
+{
+  scanDone = true;
+}
+
+static void setup(double noisePf)
+{
+  int i;
+
+  SIM_Reset();
+  SIM_Seed(5);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.0, noisePf);
+  }
+  CAPSENSE_Init();
+  // The statistics survive CAPSENSE_Init()
+  CAPSENSE_CtxResetStats(CAPSENSE_GetDefaultContext());
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Interrupt driven scans count every TIMER0 interrupt, the warm-up windows
+ *   included, and take as long as the simulator says. Without masked
+ *   interrupts the handlers run when their window ends.
+ ******************************************************************************/
+static void testScanTiming(void)
+{
+  CAPSENSE_Stats_t stats;
+  uint32_t isrsBefore;
+  uint32_t isrsAfter;
+  uint64_t hostNs;
+  uint64_t start;
+  uint64_t longest = 0;
+  int i;
+
+  setup(0.0);
+  SIM_GetIsrStats(TIMER0_IRQn, &isrsBefore, &hostNs);
+  for (i = 0; i < SCANS; i++) {
+    scanDone = false;
+    start = SIM_Now();
+    CHECK(CAPSENSE_StartScan(scanComplete));
+    CHECK(SIM_RunUntil(&scanDone, 10 * MS));
+    if (SIM_Now() - start > longest) {
+      longest = SIM_Now() - start;
+    }
+    SIM_Run(1 * MS);
+  }
+  SIM_GetIsrStats(TIMER0_IRQn, &isrsAfter, &hostNs);
+
+  CAPSENSE_GetStats(&stats);
+  CHECK_EQ(stats.scans, SCANS);
+  CHECK_EQ(stats.interrupts, isrsAfter - isrsBefore);
+  CHECK_EQ(stats.interrupts, SCANS * (ACMP_CHANNELS + 1));
+  // The scan ends in the last handler, before its interrupt cycles
+  CHECK_NEAR(stats.scanCyclesMax,
+             longest * (SIM_HFCLK_HZ / 1000000) / 1000
+             + ACMP_CHANNELS * SIM_ISR_CYCLES, SIM_ISR_CYCLES);
+  CHECK(stats.scanCycles <= stats.scanCyclesMax);
+  // Only delayed by the cycles charged to the handler of the last window
+  CHECK(stats.latencyMax <= SIM_ISR_CYCLES + 1);
+  CHECK(stats.handlerMax < SIM_ISR_CYCLES);
+  CHECK_EQ(stats.waitCycles, 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A scan with the interrupts masked for 500 us shows that latency, and a
+ *   blocking scan counts its wait.
+ ******************************************************************************/
+static void testLatencyAndWait(void)
+{
+  CAPSENSE_Stats_t stats;
+  uint64_t start;
+  uint64_t waited;
+
+  setup(0.0);
+  scanDone = false;
+  CHECK(CAPSENSE_StartScan(scanComplete));
+  __disable_irq();
+  SIM_Run(500 * US);
+  __enable_irq();
+  CHECK(SIM_RunUntil(&scanDone, 10 * MS));
+
+  CAPSENSE_GetStats(&stats);
+  CHECK(stats.latencyMax > 400 * SIM_HFCLK_HZ / 1000000);
+  CHECK(stats.latencyMax <= 500 * SIM_HFCLK_HZ / 1000000);
+  CHECK_EQ(stats.waitCycles, 0);
+
+  start = SIM_Now();
+  CHECK(CAPSENSE_Sense());
+  waited = (SIM_Now() - start) * (SIM_HFCLK_HZ / 1000000) / 1000;
+  CAPSENSE_GetStats(&stats);
+  CHECK_EQ(stats.scans, 2);
+  CHECK_NEAR(stats.waitCycles, waited + (ACMP_CHANNELS + 1) * SIM_ISR_CYCLES,
+             SIM_ISR_CYCLES);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The noise statistics of each channel hold all its samples around the
+ *   simulated count of 296, and a reset clears them with the timing
+ *   statistics.
+ ******************************************************************************/
+static void testChannelStats(void)
+{
+  CAPSENSE_ChannelStats_t channel;
+  CAPSENSE_Stats_t stats;
+  uint32_t total;
+  int i;
+  int bin;
+
+  setup(0.2);
+  for (i = 0; i < SCANS; i++) {
+    CHECK(CAPSENSE_Sense());
+  }
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    CAPSENSE_GetChannelStats(i, &channel);
+    CHECK_EQ(channel.samples, SCANS);
+    CHECK(channel.min < channel.max);
+    CHECK(channel.min <= channel.mean);
+    CHECK(channel.mean <= channel.max);
+    CHECK_NEAR(channel.mean, 296, 12);
+    CHECK(channel.variance > 0);
+    // At most the square of half the range
+    CHECK(4 * channel.variance
+          <= (channel.max - channel.min) * (channel.max - channel.min));
+    total = 0;
+    for (bin = 0; bin < CAPSENSE_STATS_BINS; bin++) {
+      total += channel.histogram[bin];
+    }
+    CHECK_EQ(total, SCANS);
+  }
+
+  CAPSENSE_CtxResetStats(CAPSENSE_GetDefaultContext());
+  CAPSENSE_GetChannelStats(0, &channel);
+  CAPSENSE_GetStats(&stats);
+  CHECK_EQ(channel.samples, 0);
+  CHECK_EQ(stats.scans, 0);
+  CHECK_EQ(stats.interrupts, 0);
+  CHECK_EQ(stats.waitCycles, 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Samples alternating between 291 and 300 counts have a mean of 295.5 and
+ *   a variance of 20.25, which must not be taken from the truncated mean.
+ ******************************************************************************/
+static void testVariance(void)
+{
+  CAPSENSE_ChannelStats_t channel;
+  uint32_t s;
+
+  setup(0.0);
+  CAPSENSE_CtxInit(&ctx, NULL, NULL, state, 1);
+  batch.frames = CAPSENSE_BATCH_FRAMES;
+  for (s = 0; s < CAPSENSE_BATCH_FRAMES; s++) {
+    batch.counts[0][s] = (s & 1) ? 300 : 291;
+  }
+  CHECK(CAPSENSE_CtxProcessBatch(&ctx, &batch));
+  CAPSENSE_CtxGetChannelStats(&ctx, 0, &channel);
+  CHECK_EQ(channel.samples, CAPSENSE_BATCH_FRAMES);
+  CHECK_EQ(channel.min, 291);
+  CHECK_EQ(channel.max, 300);
+  CHECK_EQ(channel.mean, 295);
+  CHECK_EQ(channel.variance, 20);
+}
+
+int main(void)
+{
+  RUN(testScanTiming);
+  RUN(testLatencyAndWait);
+  RUN(testChannelStats);
+  RUN(testVariance);
+  return UNIT_Report();
+}
@@ -0,0 +1,200 @@
+/***************************************************************************//**
+ * @file
+ * @brief Round trip of the trace encoder, decoder and replay
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "capsense.h"
+#include "sim.h"
+#include "trace.h"
+#include "unit.h"
+
+#define MS                      1000000ULL
+#define FRAMES                  200
+
+static const ACMP_Channel_TypeDef inputs[] = CAPSENSE_CHANNELS;
+
+static CAPSENSE_Frame_t frames[FRAMES];
+static uint8_t trace[FRAMES * 64];
+static size_t traceSize;
+static TRACE_Record_t records[FRAMES];
+static CAPSENSE_Context_t ctx;
+static CAPSENSE_ChannelState_t state[CAPSENSE_MAX_CHANNELS];
+static CAPSENSE_Batch_t batch;
+
+/***************************************************************************//**
+ * @brief
+ *   Frame timestamps in virtual milliseconds.
+ ******************************************************************************/
+uint32_t CAPSENSE_GetTimestamp(void)
+{
+  return (uint32_t) (SIM_Now() / MS);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Trace FRAMES frames of noisy channels with touches, 20 ms apart, and
+ *   keep the frame published with each record.
+ ******************************************************************************/
+static void record(void)
+{
+  int i;
+
+  SIM_Reset();
+  SIM_Seed(3);
+  for (i = 0; i < ACMP_CHANNELS; i++) {
+    SIM_SetElectrode(inputs[i], 10.0, 0.01, 0.05);
+  }
+  SIM_AddTouch(inputs[1], 500 * MS, 1500 * MS, 5.0);
+  SIM_AddTouch(inputs[3], 2500 * MS, 2600 * MS, 3.0);
+  CAPSENSE_Init();
+  CAPSENSE_TraceStart();
+
+  traceSize = 0;
+  for (i = 0; i < FRAMES; i++) {
+    CHECK(CAPSENSE_Sense());
+    CAPSENSE_GetFrame(&frames[i]);
+    traceSize += CAPSENSE_TraceRead(trace + traceSize,
+                                    sizeof(trace) - traceSize);
+    SIM_Run(20 * MS);
+  }
+  CAPSENSE_TraceStop();
+  CHECK_EQ(CAPSENSE_GetDroppedTraceFrames(), 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode records until the bytes run out.
+ *
+ * @return
+ *   The number of records.
+ ******************************************************************************/
+static uint32_t decode(TRACE_Decoder_t *decoder, const uint8_t *data,
+                       size_t size)
+{
+  size_t pos = 0;
+  uint32_t count = 0;
+  int length;
+
+  while ((count < FRAMES)
+         && ((length = TRACE_Decode(decoder, data + pos, size - pos,
+                                    &records[count])) > 0)) {
+    pos += (size_t) length;
+    count++;
+  }
+  CHECK_EQ(pos, size);
+  return count;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Every record decodes to the frame published with it, with a key frame
+ *   every CAPSENSE_TRACE_KEY_FRAMES records, and replaying the raw samples
+ *   from the start gives the same values and baselines.
+ ******************************************************************************/
+static void testRoundTrip(void)
+{
+  TRACE_Decoder_t decoder;
+  TRACE_Mismatches_t mismatches;
+  uint32_t touched;
+  uint32_t touches = 0;
+  uint32_t count;
+  int i;
+  int c;
+
+  record();
+  TRACE_DecoderInit(&decoder);
+  count = decode(&decoder, trace, traceSize);
+  CHECK_EQ(count, FRAMES);
+  CHECK_EQ(decoder.skipped, 0);
+
+  for (i = 0; i < (int) count; i++) {
+    CHECK_EQ(records[i].key, (i % 64) == 0);
+    CHECK_EQ(records[i].channels, ACMP_CHANNELS);
+    CHECK_EQ(records[i].timestamp, frames[i].timestamp);
+    touched = 0;
+    for (c = 0; c < ACMP_CHANNELS; c++) {
+      CHECK_EQ(records[i].values[c], frames[i].values[c]);
+      CHECK_EQ(records[i].maxValues[c], frames[i].maxValues[c]);
+      if (frames[i].values[c]
+          < frames[i].maxValues[c] - (frames[i].maxValues[c] >> 2)) {
+        touched |= 1UL << c;
+      }
+    }
+    CHECK_EQ(records[i].touched, touched);
+    touches += touched != 0;
+  }
+  CHECK(touches > 0);
+
+  CAPSENSE_CtxInit(&ctx, NULL, NULL, state, ACMP_CHANNELS);
+  TRACE_Replay(&ctx, &batch, records, count, &mismatches);
+  CHECK_EQ(mismatches.records, FRAMES);
+  CHECK_EQ(mismatches.values, 0);
+  CHECK_EQ(mismatches.maxValues, 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A decoder starting after the first record skips the delta records up
+ *   to the next key frame, and an incomplete record needs more bytes.
+ ******************************************************************************/
+static void testResync(void)
+{
+  TRACE_Decoder_t decoder;
+  TRACE_Record_t first;
+  uint32_t count;
+  int length;
+
+  record();
+  TRACE_DecoderInit(&decoder);
+  length = TRACE_Decode(&decoder, trace, traceSize, &first);
+  CHECK(length > 0);
+  CHECK_EQ(TRACE_Decode(&decoder, trace + length, 1, &first), 0);
+
+  TRACE_DecoderInit(&decoder);
+  count = decode(&decoder, trace + length, traceSize - (size_t) length);
+  CHECK_EQ(decoder.skipped, 63);
+  CHECK_EQ(count, FRAMES - 64);
+  CHECK(records[0].key);
+  CHECK_EQ(records[0].timestamp, frames[64].timestamp);
+  CHECK_EQ(records[count - 1].values[1], frames[FRAMES - 1].values[1]);
+}
+
+int main(void)
+{
+  RUN(testRoundTrip);
+  RUN(testResync);
+  return UNIT_Report();
+}
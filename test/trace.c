@@ -0,0 +1,229 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host decoder and replay of the capsense trace
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "trace.h"
+
+/** Set in the tag byte of a key frame, see CAPSENSE_TraceFrame() */
+#define TRACE_TAG_KEY           0x80
+
+/***************************************************************************//**
+ * @brief
+ *   Read an unsigned LEB128 varint.
+ *
+ * @return
+ *   The position after the varint, 0 if it is incomplete or longer than
+ *   32 bits.
+ ******************************************************************************/
+static size_t TRACE_Varint(const uint8_t *data, size_t size, size_t pos,
+                           uint32_t *x)
+{
+  uint32_t shift = 0;
+  uint8_t byte;
+
+  *x = 0;
+  do {
+    if ((pos >= size) || (shift > 28)) {
+      return 0;
+    }
+    byte = data[pos++];
+    *x |= (uint32_t) (byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return pos;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read a zigzag encoded delta and apply it to the previous count.
+ ******************************************************************************/
+static size_t TRACE_Delta(const uint8_t *data, size_t size, size_t pos,
+                          uint32_t last, uint32_t *x)
+{
+  uint32_t zigzag;
+
+  pos = TRACE_Varint(data, size, pos, &zigzag);
+  *x = last + ((zigzag >> 1) ^ (uint32_t) -(int32_t) (zigzag & 1));
+  return pos;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start decoding a trace, or restart after lost bytes.
+ ******************************************************************************/
+void TRACE_DecoderInit(TRACE_Decoder_t *decoder)
+{
+  memset(decoder, 0, sizeof(*decoder));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode the next record of a trace.
+ *
+ * @details
+ *   Delta records before the first key frame can not be decoded, they are
+ *   skipped and counted. Decoding must continue with the byte after the
+ *   record.
+ *
+ * @param data
+ *   The trace bytes from the start of a record.
+ *
+ * @param size
+ *   The number of bytes available.
+ *
+ * @param record
+ *   Set to the decoded record.
+ *
+ * @return
+ *   The length of the record, 0 if more bytes are needed, or -1 if the
+ *   bytes are not a valid record.
+ ******************************************************************************/
+int TRACE_Decode(TRACE_Decoder_t *decoder, const uint8_t *data, size_t size,
+                 TRACE_Record_t *record)
+{
+  TRACE_Record_t *last = &decoder->last;
+  size_t pos = 0;
+  size_t next;
+  uint32_t time;
+  uint8_t channel;
+
+  while (pos < size) {
+    *record = *last;
+    record->key = (data[pos] & TRACE_TAG_KEY) != 0;
+    record->channels = data[pos] & ~TRACE_TAG_KEY;
+    if (record->channels > CAPSENSE_MAX_CHANNELS) {
+      return -1;
+    }
+    if (!record->key && decoder->synced
+        && (record->channels != last->channels)) {
+      return -1;
+    }
+    next = pos + 1;
+    if (((next = TRACE_Varint(data, size, next, &time)) == 0)
+        || ((next = TRACE_Varint(data, size, next, &record->touched)) == 0)
+        || ((next = TRACE_Varint(data, size, next, &record->pressed)) == 0)) {
+      return 0;
+    }
+    record->timestamp = record->key ? time : last->timestamp + time;
+
+    for (channel = 0; (channel < record->channels) && (next != 0); channel++) {
+      if (record->key) {
+        next = TRACE_Varint(data, size, next, &record->raw[channel]);
+        next = next ? TRACE_Varint(data, size, next,
+                                   &record->values[channel]) : 0;
+        next = next ? TRACE_Varint(data, size, next,
+                                   &record->maxValues[channel]) : 0;
+        next = next ? TRACE_Varint(data, size, next,
+                                   &record->windows[channel]) : 0;
+      } else {
+        next = TRACE_Delta(data, size, next, last->raw[channel],
+                           &record->raw[channel]);
+        next = next ? TRACE_Delta(data, size, next, last->values[channel],
+                                  &record->values[channel]) : 0;
+        next = next ? TRACE_Delta(data, size, next, last->maxValues[channel],
+                                  &record->maxValues[channel]) : 0;
+      }
+    }
+    if (next == 0) {
+      return 0;
+    }
+
+    if (record->key) {
+      decoder->synced = true;
+    } else if (!decoder->synced) {
+      // Nothing to apply the deltas to yet
+      decoder->skipped++;
+      pos = next;
+      continue;
+    }
+    *last = *record;
+    return (int) next;
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the raw samples of decoded records through the filter and baseline
+ *   pipeline of a context and compare the results with the trace.
+ *
+ * @details
+ *   Each record is processed as a batch of one frame with
+ *   CAPSENSE_CtxProcessBatch(), which applies neither common mode rejection
+ *   nor frequency combining. The replay matches the trace exactly when the
+ *   context starts from the same state, that is when the trace starts at
+ *   the first frame after CAPSENSE_CtxInit() and the drivers have the same
+ *   configuration. Otherwise the replayed baselines converge to the traced
+ *   ones. Each record is updated with the replayed values and baselines.
+ *
+ * @param ctx
+ *   The context, set up with as many channels as the records.
+ *
+ * @param batch
+ *   A batch to work in.
+ ******************************************************************************/
+void TRACE_Replay(CAPSENSE_Context_t *ctx, CAPSENSE_Batch_t *batch,
+                  TRACE_Record_t *records, uint32_t count,
+                  TRACE_Mismatches_t *mismatches)
+{
+  CAPSENSE_Frame_t frame;
+  TRACE_Record_t *record;
+  uint32_t i;
+  uint8_t channel;
+
+  memset(mismatches, 0, sizeof(*mismatches));
+  for (i = 0; i < count; i++) {
+    record = &records[i];
+    batch->frames = 1;
+    for (channel = 0; channel < record->channels; channel++) {
+      batch->counts[channel][0] = (uint16_t) record->raw[channel];
+    }
+    if (!CAPSENSE_CtxProcessBatch(ctx, batch)) {
+      return;
+    }
+
+    CAPSENSE_CtxGetFrame(ctx, &frame);
+    for (channel = 0; channel < record->channels; channel++) {
+      mismatches->values += frame.values[channel] != record->values[channel];
+      mismatches->maxValues += frame.maxValues[channel]
+                               != record->maxValues[channel];
+      record->values[channel] = frame.values[channel];
+      record->maxValues[channel] = frame.maxValues[channel];
+    }
+    mismatches->records++;
+  }
+}
@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host decoder and replay of the capsense trace
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __TRACE_H_
+#define __TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "capsense.h"
+
+/* Decodes the records written by CAPSENSE_TraceFrame() in capsense_xg21.c
+ * and replays their raw samples through the filter and baseline pipeline
+ * of a context. Used by capsense_replay and test_trace. */
+
+/** A decoded trace record, one frame of a context */
+typedef struct {
+  bool key;                                   /**< Written as a key frame */
+  uint8_t channels;                           /**< Channels of the context */
+  uint32_t timestamp;                         /**< Frame timestamp in ms */
+  uint32_t touched;                           /**< Channels below threshold */
+  uint32_t pressed;                           /**< Debounced pressed channels */
+  uint32_t raw[CAPSENSE_MAX_CHANNELS];        /**< Raw samples */
+  uint32_t values[CAPSENSE_MAX_CHANNELS];     /**< Filtered values */
+  uint32_t maxValues[CAPSENSE_MAX_CHANNELS];  /**< Baselines */
+  uint32_t windows[CAPSENSE_MAX_CHANNELS];    /**< Windows of the last key frame */
+} TRACE_Record_t;
+
+/** The state carried from one record to the next */
+typedef struct {
+  bool synced;                    /**< A key frame has been decoded */
+  uint32_t skipped;               /**< Delta records before the first key frame */
+  TRACE_Record_t last;            /**< The last decoded record */
+} TRACE_Decoder_t;
+
+/** Replayed filter and baseline outputs that differ from a trace */
+typedef struct {
+  uint32_t records;               /**< Records replayed */
+  uint32_t values;                /**< Values differing from the trace */
+  uint32_t maxValues;             /**< Baselines differing from the trace */
+} TRACE_Mismatches_t;
+
+void TRACE_DecoderInit(TRACE_Decoder_t *decoder);
+int TRACE_Decode(TRACE_Decoder_t *decoder, const uint8_t *data, size_t size,
+                 TRACE_Record_t *record);
+void TRACE_Replay(CAPSENSE_Context_t *ctx, CAPSENSE_Batch_t *batch,
+                  TRACE_Record_t *records, uint32_t count,
+                  TRACE_Mismatches_t *mismatches);
+
+#endif /* __TRACE_H_ */
@@ -0,0 +1,99 @@
+/***************************************************************************//**
+ * @file
+ * @brief Minimal test harness of the host tests
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef __UNIT_H_
+#define __UNIT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Each test executable runs its test functions with RUN() and returns
+ * UNIT_Report() from main(), so ctest sees a failure as a nonzero exit
+ * code. A failed check reports its line and the test continues. */
+
+static int unitChecks;
+static int unitFailures;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    unitChecks++;                                                     \
+    if (!(cond)) {                                                    \
+      unitFailures++;                                                 \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+    }                                                                 \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                    \
+  do {                                                                \
+    long long unitActual = (long long) (actual);                      \
+    long long unitExpected = (long long) (expected);                  \
+    unitChecks++;                                                     \
+    if (unitActual != unitExpected) {                                 \
+      unitFailures++;                                                 \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+             #actual, unitActual, unitExpected);                      \
+    }                                                                 \
+  } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                       \
+  do {                                                                \
+    long long unitActual = (long long) (actual);                      \
+    long long unitExpected = (long long) (expected);                  \
+    unitChecks++;                                                     \
+    if ((unitActual < unitExpected - (long long) (tolerance))         \
+        || (unitActual > unitExpected + (long long) (tolerance))) {   \
+      unitFailures++;                                                 \
+      printf("%s:%d: %s is %lld, expected %lld +- %lld\n", __FILE__,  \
+             __LINE__, #actual, unitActual, unitExpected,             \
+             (long long) (tolerance));                                \
+    }                                                                 \
+  } while (0)
+
+#define RUN(test)                     \
+  do {                                \
+    int unitBefore = unitFailures;    \
+    test();                           \
+    printf("%-40s %s\n", #test,       \
+           (unitFailures == unitBefore) ? "ok" : "FAILED"); \
+  } while (0)
+
+static inline int UNIT_Report(void)
+{
+  printf("%d checks, %d failed\n", unitChecks, unitFailures);
+  return (unitFailures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif /* __UNIT_H_ */